@@ -0,0 +1,448 @@
+// Benchmarks parsing, cascade, layout, paint and hit-testing on a generated corpus.
+// Results are written to stdout as JSON, so runs can be stored and diffed.
+// The create.* phases come from the document statistics and are zero when
+// litehtml is built with LITEHTML_NO_STATS. The memory held by the documents
+// after the last render is reported by category and per byte of html.
+//
+// --trace writes the trace of one more run, rendered at 800px and drawn, in
+// the Chrome trace event format. With several documents the last one is kept.
+//
+// --raster adds the raster phase: the 800x600 viewport painted into pixels by
+// raster_container, with its own document as the fonts come from the container.
+//
+// The warm_start phase applies the layout snapshot taken at 800px to a new
+// document of the same html, in place of render_800.
+// --layout-dir writes the layout of every document rendered at 800px to
+// <dir>/<document name>.json, the files of two builds can be diffed to find
+// layout regressions.
+//
+// Usage: litehtml_bench [--iterations <n>] [--filter <document name>] [--trace <file.json>] [--raster] [--layout-dir <dir>]
+
+#include "litehtml.h"
+#include "test/container_test.h"
+#include "raster/raster_container.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+static const litehtml::tchar_t master_css[] =
+{
+#include "master.css.inc"
+,0
+};
+
+namespace
+{
+	// Headless container with a fixed width font, so the text takes space in the layout
+	class bench_container : public container_test
+	{
+	public:
+		int client_width = 800;
+		int client_height = 600;
+
+		virtual int text_width(const litehtml::tchar_t* text, litehtml::uint_ptr hFont) override
+		{
+			return 8 * (int) t_strlen(text);
+		}
+		virtual void get_client_rect(litehtml::position& client) const override
+		{
+			client = litehtml::position(0, 0, 0, client_width, client_height, 0);
+		}
+	};
+
+	const char* const words[] = { "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing", "elit", "sed", "do", "eiusmod", "tempor" };
+
+	std::string text(int count, int seed)
+	{
+		std::string str;
+		for (int i = 0; i < count; i++)
+		{
+			if (i)
+			{
+				str += ' ';
+			}
+			str += words[(i * 7 + seed) % (sizeof(words) / sizeof(words[0]))];
+		}
+		return str;
+	}
+
+	std::string big_table()
+	{
+		std::string html = "<html><head><style>td { padding: 2px 4px; border: 1px solid #ccc } tr:nth-child(2n) { background: #eee }</style></head><body><table>";
+		for (int row = 0; row < 500; row++)
+		{
+			html += "<tr>";
+			for (int col = 0; col < 8; col++)
+			{
+				html += "<td>" + text(1 + (row + col) % 4, row * 8 + col) + "</td>";
+			}
+			html += "</tr>";
+		}
+		return html + "</table></body></html>";
+	}
+
+	std::string deep_nesting()
+	{
+		std::string html = "<html><head><style>div { padding-left: 1px } div > span { color: red }</style></head><body>";
+		for (int block = 0; block < 20; block++)
+		{
+			for (int depth = 0; depth < 100; depth++)
+			{
+				html += "<div>";
+			}
+			html += "<span>" + text(10, block) + "</span>";
+			for (int depth = 0; depth < 100; depth++)
+			{
+				html += "</div>";
+			}
+		}
+		return html + "</body></html>";
+	}
+
+	std::string float_gallery()
+	{
+		std::string html = "<html><head><style>.item { float: left; width: 150px; height: 120px; margin: 4px; border: 1px solid black } .item p { margin: 0 }</style></head><body>";
+		for (int i = 0; i < 300; i++)
+		{
+			html += "<div class=\"item\"><p>" + text(4, i) + "</p></div>";
+			if (i % 50 == 49)
+			{
+				html += "<div style=\"clear: both\"></div>";
+			}
+		}
+		return html + "</body></html>";
+	}
+
+	std::string framework_css()
+	{
+		std::string css;
+		for (int i = 0; i < 1500; i++)
+		{
+			std::string n = std::to_string(i);
+			css += ".col-" + n + " { width: " + std::to_string(i % 100) + "%; float: left }\n";
+			css += ".nav .item-" + n + " > a:hover { color: #" + std::to_string(100 + i % 900) + "; text-decoration: underline }\n";
+			css += "div.card-" + n + " p.text { margin: " + std::to_string(i % 16) + "px 0; line-height: 1.5 }\n";
+			if (i % 10 == 0)
+			{
+				css += "@media (max-width: " + std::to_string(320 + i) + "px) { .col-" + n + " { width: 100% } }\n";
+			}
+		}
+
+		std::string html = "<html><head><style>" + css + "</style></head><body><div class=\"nav\">";
+		for (int i = 0; i < 100; i++)
+		{
+			html += "<div class=\"item-" + std::to_string(i) + "\"><a href=\"#\">" + text(2, i) + "</a></div>";
+		}
+		html += "</div>";
+		for (int i = 0; i < 300; i++)
+		{
+			html += "<div class=\"col-" + std::to_string(i) + " card-" + std::to_string(i) + "\"><p class=\"text\">" + text(12, i) + "</p></div>";
+		}
+		return html + "</body></html>";
+	}
+
+	std::string long_text()
+	{
+		std::string html = "<html><body>";
+		for (int i = 0; i < 400; i++)
+		{
+			html += "<p>" + text(120, i) + " <b>" + text(3, i) + "</b> <i>" + text(5, i + 1) + "</i></p>";
+		}
+		return html + "</body></html>";
+	}
+
+	struct corpus_document
+	{
+		const char*		name;
+		std::string		(*generate)();
+	};
+
+	const corpus_document corpus[] =
+	{
+		{ "big_table",		big_table },
+		{ "deep_nesting",	deep_nesting },
+		{ "float_gallery",	float_gallery },
+		{ "framework_css",	framework_css },
+		{ "long_text",		long_text },
+	};
+
+	const int render_widths[] = { 320, 800, 1280 };
+
+	typedef std::chrono::steady_clock bench_clock;
+
+	double elapsed_ms(const bench_clock::time_point& start)
+	{
+		return std::chrono::duration<double, std::milli>(bench_clock::now() - start).count();
+	}
+
+	// Timings of one phase over all the iterations
+	struct phase
+	{
+		std::string			name;
+		std::vector<double>	samples;
+	};
+
+	phase& get_phase(std::vector<phase>& phases, const std::string& name)
+	{
+		for (auto& ph : phases)
+		{
+			if (ph.name == name)
+			{
+				return ph;
+			}
+		}
+		phases.push_back(phase());
+		phases.back().name = name;
+		return phases.back();
+	}
+
+	int count_elements(const litehtml::element::ptr& el)
+	{
+		int count = 1;
+		for (int i = 0; i < (int) el->get_children_count(); i++)
+		{
+			count += count_elements(el->get_child(i));
+		}
+		return count;
+	}
+
+	struct document_info
+	{
+		int								elements;
+		size_t							input_size;
+		litehtml::document_memory_usage	memory;
+	};
+
+	void run_document(const corpus_document& cd, litehtml::context& ctx, int iterations, std::vector<phase>& phases, document_info& info)
+	{
+		std::string html = cd.generate();
+		info.input_size = html.length();
+		bench_container container;
+
+		for (int i = 0; i < iterations; i++)
+		{
+			container.client_width = 800;
+			bench_clock::time_point start = bench_clock::now();
+			litehtml::document::ptr doc = litehtml::document::createFromUTF8(html.c_str(), &container, &ctx);
+			get_phase(phases, "create").samples.push_back(elapsed_ms(start));
+
+			const litehtml::document_stats& stats = doc->stats();
+			for (int ph = litehtml::stats_phase_parse; ph <= litehtml::stats_phase_init; ph++)
+			{
+				get_phase(phases, std::string("create.") + litehtml::get_stats_phase_name((litehtml::stats_phase) ph)).samples.push_back(stats.phase_time[ph]);
+			}
+			doc->enable_stats(false);
+
+			for (int width : render_widths)
+			{
+				container.client_width = width;
+				start = bench_clock::now();
+				doc->render(width);
+				get_phase(phases, "render_" + std::to_string(width)).samples.push_back(elapsed_ms(start));
+			}
+
+			litehtml::position clip(0, 0, 0, doc->width(), doc->height(), 0);
+			start = bench_clock::now();
+			doc->draw((litehtml::uint_ptr) 0, 0, 0, 0, &clip);
+			get_phase(phases, "draw").samples.push_back(elapsed_ms(start));
+
+			// 16x16 grid of points over the whole document
+			start = bench_clock::now();
+			for (int y = 0; y < 16; y++)
+			{
+				for (int x = 0; x < 16; x++)
+				{
+					int px = doc->width() * x / 16;
+					int py = doc->height() * y / 16;
+					doc->root()->get_element_by_point(px, py, 0, px, py, 0);
+				}
+			}
+			get_phase(phases, "hit_test").samples.push_back(elapsed_ms(start));
+
+			info.elements = count_elements(doc->root());
+			info.memory = doc->memory_usage();
+		}
+	}
+
+	void run_raster(const corpus_document& cd, litehtml::context& ctx, int iterations, std::vector<phase>& phases)
+	{
+		std::string html = cd.generate();
+		raster_container container(800, 600);
+		litehtml::document::ptr doc = litehtml::document::createFromUTF8(html.c_str(), &container, &ctx);
+		doc->enable_stats(false);
+		doc->render(800);
+
+		for (int i = 0; i < iterations; i++)
+		{
+			bench_clock::time_point start = bench_clock::now();
+			container.draw(doc);
+			get_phase(phases, "raster").samples.push_back(elapsed_ms(start));
+		}
+	}
+
+	void run_warm_start(const corpus_document& cd, litehtml::context& ctx, int iterations, std::vector<phase>& phases)
+	{
+		std::string html = cd.generate();
+		bench_container container;
+		litehtml::document::ptr doc = litehtml::document::createFromUTF8(html.c_str(), &container, &ctx);
+		doc->enable_stats(false);
+		doc->render(800);
+		litehtml::layout_snapshot snapshot;
+		snapshot.capture(*doc);
+
+		for (int i = 0; i < iterations; i++)
+		{
+			doc = litehtml::document::createFromUTF8(html.c_str(), &container, &ctx);
+			doc->enable_stats(false);
+			bench_clock::time_point start = bench_clock::now();
+			snapshot.apply(*doc);
+			get_phase(phases, "warm_start").samples.push_back(elapsed_ms(start));
+		}
+	}
+
+	bool write_layout(const corpus_document& cd, litehtml::context& ctx, const char* dir)
+	{
+		std::string html = cd.generate();
+		bench_container container;
+		litehtml::document::ptr doc = litehtml::document::createFromUTF8(html.c_str(), &container, &ctx);
+		doc->enable_stats(false);
+		doc->render(800);
+		litehtml::layout_snapshot snapshot;
+		snapshot.capture(*doc);
+
+		std::string path = std::string(dir) + "/" + cd.name + ".json";
+		FILE* f = fopen(path.c_str(), "w");
+		if (!f)
+		{
+			return false;
+		}
+		std::string json = snapshot.to_json();
+		fwrite(json.c_str(), 1, json.length(), f);
+		fclose(f);
+		return true;
+	}
+
+	bool write_trace(const corpus_document& cd, litehtml::context& ctx, const char* path)
+	{
+		std::string html = cd.generate();
+		bench_container container;
+
+		ctx.enable_trace(true);
+		litehtml::document::ptr doc = litehtml::document::createFromUTF8(html.c_str(), &container, &ctx);
+		ctx.enable_trace(false);
+		doc->render(container.client_width);
+		litehtml::position clip(0, 0, 0, doc->width(), doc->height(), 0);
+		doc->draw((litehtml::uint_ptr) 0, 0, 0, 0, &clip);
+
+		FILE* f = fopen(path, "w");
+		if (!f)
+		{
+			return false;
+		}
+		std::string json = doc->trace().to_json();
+		fwrite(json.c_str(), 1, json.length(), f);
+		fclose(f);
+		return true;
+	}
+
+	void print_phase(const phase& ph, bool last)
+	{
+		std::vector<double> sorted = ph.samples;
+		std::sort(sorted.begin(), sorted.end());
+		double sum = 0;
+		for (double val : sorted)
+		{
+			sum += val;
+		}
+		printf("        \"%s\": { \"min_ms\": %.3f, \"median_ms\": %.3f, \"mean_ms\": %.3f, \"max_ms\": %.3f }%s\n",
+			ph.name.c_str(), sorted.front(), sorted[sorted.size() / 2], sum / sorted.size(), sorted.back(), last ? "" : ",");
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int iterations = 5;
+	const char* filter = nullptr;
+	const char* trace_file = nullptr;
+	bool raster = false;
+	const char* layout_dir = nullptr;
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--iterations") && i + 1 < argc)
+		{
+			iterations = std::max(1, atoi(argv[++i]));
+		}
+		else if (!strcmp(argv[i], "--filter") && i + 1 < argc)
+		{
+			filter = argv[++i];
+		}
+		else if (!strcmp(argv[i], "--trace") && i + 1 < argc)
+		{
+			trace_file = argv[++i];
+		}
+		else if (!strcmp(argv[i], "--raster"))
+		{
+			raster = true;
+		}
+		else if (!strcmp(argv[i], "--layout-dir") && i + 1 < argc)
+		{
+			layout_dir = argv[++i];
+		}
+		else
+		{
+			fprintf(stderr, "Usage: %s [--iterations <n>] [--filter <document name>] [--trace <file.json>] [--raster] [--layout-dir <dir>]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	litehtml::context ctx;
+	ctx.load_master_stylesheet(master_css);
+	// only the phases of createFromUTF8 are taken from the statistics, the rest is timed here
+	ctx.enable_stats(true);
+
+	printf("{\n  \"iterations\": %d,\n  \"documents\": [", iterations);
+	bool first = true;
+	for (const auto& cd : corpus)
+	{
+		if (filter && strcmp(filter, cd.name))
+		{
+			continue;
+		}
+		std::vector<phase> phases;
+		document_info info;
+		run_document(cd, ctx, iterations, phases, info);
+		run_warm_start(cd, ctx, iterations, phases);
+		if (raster)
+		{
+			run_raster(cd, ctx, iterations, phases);
+		}
+		if (trace_file && !write_trace(cd, ctx, trace_file))
+		{
+			fprintf(stderr, "Can't create %s\n", trace_file);
+			return 1;
+		}
+		if (layout_dir && !write_layout(cd, ctx, layout_dir))
+		{
+			fprintf(stderr, "Can't write the layout to %s\n", layout_dir);
+			return 1;
+		}
+
+		const litehtml::document_memory_usage& mu = info.memory;
+		printf("%s\n    {\n      \"name\": \"%s\",\n      \"elements\": %d,\n      \"input_bytes\": %d,\n", first ? "" : ",", cd.name, info.elements, (int) info.input_size);
+		printf("      \"memory\": { \"total\": %d, \"elements\": %d, \"attributes\": %d, \"styles\": %d, \"selectors\": %d, \"boxes\": %d, \"text\": %d, \"fonts\": %d },\n",
+			(int) mu.total(), (int) mu.elements, (int) mu.attributes, (int) mu.styles, (int) mu.selectors, (int) mu.boxes, (int) mu.text, (int) mu.fonts);
+		printf("      \"memory_per_input_byte\": %.2f,\n      \"phases\": {\n", (double) mu.total() / info.input_size);
+		for (size_t i = 0; i < phases.size(); i++)
+		{
+			print_phase(phases[i], i + 1 == phases.size());
+		}
+		printf("      }\n    }");
+		first = false;
+	}
+	printf("\n  ]\n}\n");
+	return 0;
+}
@@ -143,13 +143,10 @@ void cairo_container::draw_list_marker(litehtml::uint_ptr hdc, const litehtml::l
 		t_make_url(marker.image.c_str(), marker.baseurl, url);
 
 		lock_images_cache();
-		images_map::iterator img_i = m_images.find(url.c_str());
-		if (img_i != m_images.end())
+		image_ptr img = find_image(url, marker.pos.width, marker.pos.height);
+		if (img)
 		{
-			if (img_i->second)
-			{
-				draw_txdib((cairo_t*)hdc, img_i->second.get(), marker.pos.x, marker.pos.y, marker.pos.width, marker.pos.height);
-			}
+			draw_txdib((cairo_t*)hdc, img.get(), marker.pos.x, marker.pos.y, marker.pos.width, marker.pos.height);
 		}
 		unlock_images_cache();
 	}
@@ -235,13 +232,10 @@ void cairo_container::draw_image(litehtml::uint_ptr hdc, const litehtml::tchar_t
 	std::wstring url;
 	t_make_url(src, baseurl, url);
 	lock_images_cache();
-	images_map::iterator img = m_images.find(url.c_str());
-	if (img != m_images.end())
+	image_ptr img = find_image(url, pos.width, pos.height);
+	if (img)
 	{
-		if (img->second)
-		{
-			draw_txdib(cr, img->second.get(), pos.x, pos.y, pos.width, pos.height);
-		}
+		draw_txdib(cr, img.get(), pos.x, pos.y, pos.width, pos.height);
 	}
 	unlock_images_cache();
 	cairo_restore(cr);
@@ -269,20 +263,10 @@ void cairo_container::draw_background(litehtml::uint_ptr hdc, const litehtml::ba
 	t_make_url(bg.image.c_str(), bg.baseurl.c_str(), url);
 
 	lock_images_cache();
-	images_map::iterator img_i = m_images.find(url.c_str());
-	if (img_i != m_images.end() && img_i->second)
+	// the image resampled to the drawn size is cached, the surface only wraps its bits
+	image_ptr bgbmp = find_image(url, bg.image_size.width, bg.image_size.height);
+	if (bgbmp)
 	{
-		image_ptr bgbmp = img_i->second;
-
-		image_ptr new_img;
-		if (bg.image_size.width != bgbmp->getWidth() || bg.image_size.height != bgbmp->getHeight())
-		{
-			new_img = image_ptr(new CTxDIB);
-			bgbmp->resample(bg.image_size.width, bg.image_size.height, new_img.get());
-			bgbmp = new_img;
-		}
-
-
 		cairo_surface_t* img = cairo_image_surface_create_for_data((unsigned char*)bgbmp->getBits(), CAIRO_FORMAT_ARGB32, bgbmp->getWidth(), bgbmp->getHeight(), bgbmp->getWidth() * 4);
 		cairo_pattern_t *pattern = cairo_pattern_create_for_surface(img);
 		cairo_matrix_t flib_m;
@@ -774,9 +758,50 @@ void cairo_container::clear_images()
 {
 	lock_images_cache();
 	m_images.clear();
+	m_scaled.clear();
+	m_scaled_sources.clear();
 	unlock_images_cache();
 }
 
+void cairo_container::set_scaled_images_budget(size_t bytes)
+{
+	lock_images_cache();
+	m_scaled.set_budget(bytes);
+	unlock_images_cache();
+}
+
+// The image resampled to width x height. The variants are kept in m_scaled until they are
+// evicted or the image is replaced. Called with the images cache locked.
+cairo_container::image_ptr cairo_container::find_image(const std::wstring& url, int width, int height)
+{
+	image_ptr img;
+	images_map::iterator i = m_images.find(url);
+	if (i == m_images.end() || !i->second || width <= 0 || height <= 0)
+	{
+		return img;
+	}
+	image_ptr src = i->second;
+	if (width == src->getWidth() && height == src->getHeight())
+	{
+		return src;
+	}
+
+	// the source is held, so a new image can't take the address of the old one
+	image_ptr& source = m_scaled_sources[url];
+	if (source != src)
+	{
+		m_scaled.add_size(url, src->getWidth(), src->getHeight());
+		source = src;
+	}
+	if (!m_scaled.find_scaled(url, width, height, img))
+	{
+		img = image_ptr(new CTxDIB);
+		src->resample(width, height, img.get());
+		m_scaled.add_scaled(url, img, width, height);
+	}
+	return img;
+}
+
 const litehtml::tchar_t* cairo_container::get_default_font_name() const
 {
 	return _t("Times New Roman");
@@ -857,6 +882,8 @@ void cairo_container::remove_image(std::wstring& url)
 	{
 		m_images.erase(i);
 	}
+	m_scaled.remove(url);
+	m_scaled_sources.erase(url);
 	unlock_images_cache();
 }
 
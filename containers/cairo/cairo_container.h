@@ -12,6 +12,7 @@
 #include <litehtml.h>
 #include <dib.h>
 #include <txdib.h>
+#include "../image_cache/image_cache.h"
 
 #ifdef LITEHTML_UTF8
 #define t_make_url	make_url_utf8
@@ -49,6 +50,7 @@ class cairo_container : public litehtml::document_container
 public:
 	typedef std::shared_ptr<CTxDIB>				image_ptr;
 	typedef std::map<std::wstring, image_ptr>	images_map;
+	typedef image_cache<image_ptr, std::wstring>	scaled_images;
 
 protected:
 	cairo_surface_t*			m_temp_surface;
@@ -57,6 +59,9 @@ protected:
 	cairo_clip_box::vector		m_clips;
 	IMLangFontLink2*			m_font_link;
 	CRITICAL_SECTION			m_img_sync;
+private:
+	scaled_images				m_scaled;			// the images resampled to the drawn sizes
+	images_map					m_scaled_sources;	// the images the variants were made from
 public:
 	cairo_container(void);
 	virtual ~cairo_container(void);
@@ -89,6 +94,7 @@ public:
 	virtual void						make_url(LPCWSTR url, LPCWSTR basepath, std::wstring& out) = 0;
 	virtual image_ptr					get_image(LPCWSTR url, bool redraw_on_ready) = 0;
 	void								clear_images();
+	void								set_scaled_images_budget(size_t bytes);
 	void								add_image(std::wstring& url, image_ptr& img);
 	void								remove_image(std::wstring& url);
 	void								make_url_utf8(const char* url, const char* basepath, std::wstring& out);
@@ -105,6 +111,7 @@ private:
 	bool								add_path_arc(cairo_t* cr, double x, double y, double rx, double ry, double a1, double a2, bool neg);
 
 	void								draw_txdib(cairo_t* cr, CTxDIB* bmp, int x, int y, int cx, int cy);
+	image_ptr							find_image(const std::wstring& url, int width, int height);
 	void								lock_images_cache();
 	void								unlock_images_cache();
 };
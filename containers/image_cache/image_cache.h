@@ -0,0 +1,206 @@
+#pragma once
+
+#include "../../include/litehtml.h"
+#include <list>
+#include <map>
+#include <algorithm>
+#include <iterator>
+
+// Decoded images of a container by url, with the variants scaled to the sizes
+// the document draws them at, so the scaling is done once and not on every paint.
+//
+// The images are kept up to a byte budget (4 bytes per pixel), the least recently
+// used ones are evicted first. Pinned images are only removed with remove() or
+// clear(). The size of an evicted image stays known, so the layout does not change
+// while the container loads it again.
+//
+// Image is a reference counted handle (std::shared_ptr, Glib::RefPtr...), an image
+// being drawn stays valid when it is evicted. The cache is not thread safe.
+template<class Image, class String = litehtml::tstring>
+class image_cache
+{
+	struct key
+	{
+		String	url;
+		int		width;		// -1 for the image itself
+		int		height;
+
+		bool operator<(const key& val) const
+		{
+			if (width != val.width)		return width < val.width;
+			if (height != val.height)	return height < val.height;
+			return url < val.url;
+		}
+	};
+
+	struct entry
+	{
+		key		k;
+		Image	image;
+		size_t	bytes;
+		bool	pinned;
+	};
+
+	typedef std::list<entry>	entries_list;
+
+	entries_list										m_entries;		// the most recently used first
+	std::map<key, typename entries_list::iterator>		m_index;
+	std::map<String, litehtml::size>					m_sizes;
+	size_t												m_budget;
+	size_t												m_used;
+public:
+	explicit image_cache(size_t budget = 64 * 1024 * 1024) : m_budget(budget), m_used(0)
+	{
+	}
+
+	size_t		budget() const	{ return m_budget; }
+	size_t		used() const	{ return m_used; }
+	size_t		count() const	{ return m_entries.size(); }
+
+	void set_budget(size_t budget)
+	{
+		m_budget = budget;
+		evict();
+	}
+
+	// Adds the image loaded from url, the variants of the previous one are removed
+	void add(const String& url, const Image& img, int width, int height, bool pinned = false)
+	{
+		remove(url);
+		litehtml::size& sz = m_sizes[url];
+		sz.width = width;
+		sz.height = height;
+		insert(url, -1, -1, img, width, height, pinned);
+	}
+
+	// Records the size of an image the caller keeps itself, only its scaled variants are cached.
+	// The variants of the previous image are removed.
+	void add_size(const String& url, int width, int height)
+	{
+		remove(url);
+		litehtml::size& sz = m_sizes[url];
+		sz.width = width;
+		sz.height = height;
+	}
+
+	// Adds the image of url scaled to width x height
+	void add_scaled(const String& url, const Image& img, int width, int height)
+	{
+		if (m_sizes.find(url) != m_sizes.end())
+		{
+			erase(key{ url, width, height });
+			insert(url, width, height, img, width, height, false);
+		}
+	}
+
+	bool find(const String& url, Image& img)
+	{
+		return find(key{ url, -1, -1 }, img);
+	}
+
+	// The image itself is returned when it has this size
+	bool find_scaled(const String& url, int width, int height, Image& img)
+	{
+		litehtml::size sz;
+		if (get_size(url, sz) && sz.width == width && sz.height == height)
+		{
+			return find(url, img);
+		}
+		return find(key{ url, width, height }, img);
+	}
+
+	bool get_size(const String& url, litehtml::size& sz) const
+	{
+		auto iter = m_sizes.find(url);
+		if (iter == m_sizes.end())
+		{
+			return false;
+		}
+		sz = iter->second;
+		return true;
+	}
+
+	// Removes the image, its variants and its size
+	void remove(const String& url)
+	{
+		if (m_sizes.erase(url))
+		{
+			for (auto iter = m_entries.begin(); iter != m_entries.end();)
+			{
+				auto next = std::next(iter);
+				if (iter->k.url == url)
+				{
+					erase(iter->k);
+				}
+				iter = next;
+			}
+		}
+	}
+
+	void clear()
+	{
+		m_entries.clear();
+		m_index.clear();
+		m_sizes.clear();
+		m_used = 0;
+	}
+
+private:
+	bool find(const key& k, Image& img)
+	{
+		auto iter = m_index.find(k);
+		if (iter == m_index.end())
+		{
+			return false;
+		}
+		m_entries.splice(m_entries.begin(), m_entries, iter->second);
+		img = iter->second->image;
+		return true;
+	}
+
+	void insert(const String& url, int key_width, int key_height, const Image& img, int width, int height, bool pinned)
+	{
+		entry e;
+		e.k.url		= url;
+		e.k.width	= key_width;
+		e.k.height	= key_height;
+		e.image		= img;
+		e.bytes		= (size_t) std::max(width, 0) * std::max(height, 0) * 4;
+		e.pinned	= pinned;
+		m_entries.push_front(e);
+		m_index[e.k] = m_entries.begin();
+		m_used += e.bytes;
+		evict();
+	}
+
+	void erase(const key& k)
+	{
+		auto iter = m_index.find(k);
+		if (iter != m_index.end())
+		{
+			m_used -= iter->second->bytes;
+			m_entries.erase(iter->second);
+			m_index.erase(iter);
+		}
+	}
+
+	// the image added last is kept even when it does not fit
+	void evict()
+	{
+		auto iter = m_entries.end();
+		while (m_used > m_budget && iter != m_entries.begin())
+		{
+			--iter;
+			if (iter == m_entries.begin())
+			{
+				break;
+			}
+			if (!iter->pinned)
+			{
+				auto prev = std::prev(iter);
+				erase(iter->k);
+				iter = std::next(prev);
+			}
+		}
+	}
+};
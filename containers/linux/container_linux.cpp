@@ -298,21 +298,14 @@ void container_linux::draw_background( litehtml::uint_ptr hdc, const litehtml::b
 	litehtml::tstring url;
 	make_url(bg.image.c_str(), bg.baseurl.c_str(), url);
 
-	//lock_images_cache();
-	images_map::iterator img_i = m_images.find(url.c_str());
-	if(img_i != m_images.end() && img_i->second)
+	// the surface scaled to the drawn size is cached, the paint does not convert or scale the image
+	std::shared_ptr<cairo_surface_t> img = get_image_surface(url, bg.image_size.width, bg.image_size.height);
+	if(img)
 	{
-		Glib::RefPtr<Gdk::Pixbuf> bgbmp = img_i->second;
+		int img_width = bg.image_size.width;
+		int img_height = bg.image_size.height;
 
-		Glib::RefPtr<Gdk::Pixbuf> new_img;
-		if(bg.image_size.width != bgbmp->get_width() || bg.image_size.height != bgbmp->get_height())
-		{
-			new_img = bgbmp->scale_simple(bg.image_size.width, bg.image_size.height, Gdk::INTERP_BILINEAR);
-			bgbmp = new_img;
-		}
-
-		cairo_surface_t* img = surface_from_pixbuf(bgbmp);
-		cairo_pattern_t *pattern = cairo_pattern_create_for_surface(img);
+		cairo_pattern_t *pattern = cairo_pattern_create_for_surface(img.get());
 		cairo_matrix_t flib_m;
 		cairo_matrix_init_identity(&flib_m);
 		cairo_matrix_translate(&flib_m, -bg.position_x, -bg.position_y);
@@ -322,18 +315,20 @@ void container_linux::draw_background( litehtml::uint_ptr hdc, const litehtml::b
 		switch(bg.repeat)
 		{
 		case litehtml::background_repeat_no_repeat:
-			draw_pixbuf(cr, bgbmp, bg.position_x, bg.position_y, bgbmp->get_width(), bgbmp->get_height());
+			cairo_set_source_surface(cr, img.get(), bg.position_x, bg.position_y);
+			cairo_rectangle(cr, bg.position_x, bg.position_y, img_width, img_height);
+			cairo_fill(cr);
 			break;
 
 		case litehtml::background_repeat_repeat_x:
 			cairo_set_source(cr, pattern);
-			cairo_rectangle(cr, bg.clip_box.left(), bg.position_y, bg.clip_box.width, bgbmp->get_height());
+			cairo_rectangle(cr, bg.clip_box.left(), bg.position_y, bg.clip_box.width, img_height);
 			cairo_fill(cr);
 			break;
 
 		case litehtml::background_repeat_repeat_y:
 			cairo_set_source(cr, pattern);
-			cairo_rectangle(cr, bg.position_x, bg.clip_box.top(), bgbmp->get_width(), bg.clip_box.height);
+			cairo_rectangle(cr, bg.position_x, bg.clip_box.top(), img_width, bg.clip_box.height);
 			cairo_fill(cr);
 			break;
 
@@ -345,10 +340,7 @@ void container_linux::draw_background( litehtml::uint_ptr hdc, const litehtml::b
 		}
 
 		cairo_pattern_destroy(pattern);
-		cairo_surface_destroy(img);
-
 	}
-//	unlock_images_cache();
 	cairo_restore(cr);
 }
 
@@ -756,6 +748,8 @@ void container_linux::fill_ellipse( cairo_t* cr, int x, int y, int width, int he
 
 void container_linux::clear_images()
 {
+	m_surfaces.clear();
+	m_surface_sources.clear();
 /*	for(images_map::iterator i = m_images.begin(); i != m_images.end(); i++)
 	{
 		if(i->second)
@@ -812,31 +806,6 @@ void container_linux::rounded_rectangle( cairo_t* cr, const litehtml::position &
 	}
 }
 
-void container_linux::draw_pixbuf(cairo_t* cr, const Glib::RefPtr<Gdk::Pixbuf>& bmp, int x,	int y, int cx, int cy)
-{
-	cairo_save(cr);
-
-	{
-		Cairo::RefPtr<Cairo::Context> crobj(new Cairo::Context(cr, false));
-
-		cairo_matrix_t flib_m;
-		cairo_matrix_init(&flib_m, 1, 0, 0, -1, 0, 0);
-
-		if(cx != bmp->get_width() || cy != bmp->get_height())
-		{
-			Glib::RefPtr<Gdk::Pixbuf> new_img = bmp->scale_simple(cx, cy, Gdk::INTERP_BILINEAR);;
-			Gdk::Cairo::set_source_pixbuf(crobj, new_img, x, y);
-			crobj->paint();
-		} else
-		{
-			Gdk::Cairo::set_source_pixbuf(crobj, bmp, x, y);
-			crobj->paint();
-		}
-	}
-
-	cairo_restore(cr);
-}
-
 cairo_surface_t* container_linux::surface_from_pixbuf(const Glib::RefPtr<Gdk::Pixbuf>& bmp)
 {
 	cairo_surface_t* ret = NULL;
@@ -857,6 +826,53 @@ cairo_surface_t* container_linux::surface_from_pixbuf(const Glib::RefPtr<Gdk::Pi
 	return ret;
 }
 
+// The surface of the loaded image scaled to width x height. It is made once and kept in
+// m_surfaces until it is evicted or the image is replaced in m_images.
+std::shared_ptr<cairo_surface_t> container_linux::get_image_surface(const litehtml::tstring& url, int width, int height)
+{
+	std::shared_ptr<cairo_surface_t> img;
+	images_map::iterator img_i = m_images.find(url);
+	if(img_i == m_images.end() || !img_i->second || width <= 0 || height <= 0)
+	{
+		return img;
+	}
+	Glib::RefPtr<Gdk::Pixbuf> bmp = img_i->second;
+
+	// the source is held, so a new image can't take the address of the old one
+	Glib::RefPtr<Gdk::Pixbuf>& source = m_surface_sources[url];
+	if(source != bmp)
+	{
+		m_surfaces.remove(url);
+		source = bmp;
+	}
+	if(m_surfaces.find_scaled(url, width, height, img))
+	{
+		return img;
+	}
+
+	std::shared_ptr<cairo_surface_t> src;
+	if(!m_surfaces.find(url, src))
+	{
+		src = std::shared_ptr<cairo_surface_t>(surface_from_pixbuf(bmp), cairo_surface_destroy);
+		m_surfaces.add(url, src, bmp->get_width(), bmp->get_height());
+		if(width == bmp->get_width() && height == bmp->get_height())
+		{
+			return src;
+		}
+	}
+
+	img = std::shared_ptr<cairo_surface_t>(cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height), cairo_surface_destroy);
+	cairo_t* cr = cairo_create(img.get());
+	cairo_scale(cr, (double) width / bmp->get_width(), (double) height / bmp->get_height());
+	cairo_set_source_surface(cr, src.get(), 0, 0);
+	cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_GOOD);
+	cairo_paint(cr);
+	cairo_destroy(cr);
+
+	m_surfaces.add_scaled(url, img, width, height);
+	return img;
+}
+
 void container_linux::get_media_features(litehtml::media_features& media) const
 {
 	litehtml::position client;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../../include/litehtml.h"
+#include "../image_cache/image_cache.h"
 #include <cairo.h>
 #include <gtkmm.h>
 
@@ -40,12 +41,17 @@ struct cairo_font
 class container_linux :	public litehtml::document_container
 {
 	typedef std::map<litehtml::tstring, Glib::RefPtr<Gdk::Pixbuf> >	images_map;
+	// the images converted to cairo surfaces, with the variants scaled to the drawn sizes
+	typedef image_cache<std::shared_ptr<cairo_surface_t> >			surfaces_cache;
 
 protected:
 	cairo_surface_t*			m_temp_surface;
 	cairo_t*					m_temp_cr;
 	images_map					m_images;
     cairo_clip_box::vector		m_clips;
+private:
+	surfaces_cache				m_surfaces;
+	images_map					m_surface_sources;	// the images the surfaces were made from
 public:
 	container_linux(void);
 	virtual ~container_linux(void);
@@ -78,6 +84,7 @@ public:
 	virtual Glib::RefPtr<Gdk::Pixbuf>	get_image(const litehtml::tchar_t* url, bool redraw_on_ready) = 0;
 
 	void								clear_images();
+	void								set_surfaces_budget(size_t bytes) { m_surfaces.set_budget(bytes); }
 
 protected:
 	virtual void						draw_ellipse(cairo_t* cr, int x, int y, int width, int height, const litehtml::web_color& color, int line_width);
@@ -88,6 +95,6 @@ private:
 	void								apply_clip(cairo_t* cr);
 	void								add_path_arc(cairo_t* cr, double x, double y, double rx, double ry, double a1, double a2, bool neg);
 	void								set_color(cairo_t* cr, litehtml::web_color color)	{ cairo_set_source_rgba(cr, color.red / 255.0, color.green / 255.0, color.blue / 255.0, color.alpha / 255.0); }
-	void								draw_pixbuf(cairo_t* cr, const Glib::RefPtr<Gdk::Pixbuf>& bmp, int x, int y, int cx, int cy);
 	cairo_surface_t*					surface_from_pixbuf(const Glib::RefPtr<Gdk::Pixbuf>& bmp);
+	std::shared_ptr<cairo_surface_t>	get_image_surface(const litehtml::tstring& url, int width, int height);
 };
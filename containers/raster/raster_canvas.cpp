@@ -0,0 +1,307 @@
+#include "raster_canvas.h"
+#include <stdio.h>
+#include <algorithm>
+
+raster_canvas::raster_canvas(int width, int height)
+{
+	m_width = 0;
+	m_height = 0;
+	resize(width, height);
+}
+
+void raster_canvas::resize(int width, int height)
+{
+	m_width = std::max(width, 0);
+	m_height = std::max(height, 0);
+	m_pixels.assign((size_t) m_width * m_height * 4, 0);
+	reset_clip();
+}
+
+void raster_canvas::clear(const litehtml::web_color& color)
+{
+	for (size_t i = 0; i < m_pixels.size(); i += 4)
+	{
+		m_pixels[i]		= color.red;
+		m_pixels[i + 1]	= color.green;
+		m_pixels[i + 2]	= color.blue;
+		m_pixels[i + 3]	= color.alpha;
+	}
+}
+
+litehtml::web_color raster_canvas::get_pixel(int x, int y) const
+{
+	if (x < 0 || y < 0 || x >= m_width || y >= m_height)
+	{
+		return litehtml::web_color(0, 0, 0, 0);
+	}
+	const unsigned char* px = &m_pixels[((size_t) y * m_width + x) * 4];
+	return litehtml::web_color(px[0], px[1], px[2], px[3]);
+}
+
+void raster_canvas::set_clip(const litehtml::position& clip)
+{
+	int left	= std::max(clip.left(), 0);
+	int top		= std::max(clip.top(), 0);
+	int right	= std::min(clip.right(), m_width);
+	int bottom	= std::min(clip.bottom(), m_height);
+	m_clip = litehtml::position(left, top, std::max(right - left, 0), std::max(bottom - top, 0));
+}
+
+void raster_canvas::reset_clip()
+{
+	m_clip = litehtml::position(0, 0, m_width, m_height);
+}
+
+void raster_canvas::blend_pixel(int x, int y, const litehtml::web_color& color, int coverage)
+{
+	if (x < m_clip.left() || y < m_clip.top() || x >= m_clip.right() || y >= m_clip.bottom())
+	{
+		return;
+	}
+	int alpha = color.alpha * coverage / 255;
+	if (alpha <= 0)
+	{
+		return;
+	}
+	unsigned char* px = &m_pixels[((size_t) y * m_width + x) * 4];
+	if (alpha >= 255)
+	{
+		px[0] = color.red;
+		px[1] = color.green;
+		px[2] = color.blue;
+		px[3] = 255;
+		return;
+	}
+	// source over
+	int dst_alpha = px[3] * (255 - alpha) / 255;
+	int out_alpha = alpha + dst_alpha;
+	px[0] = (unsigned char) ((color.red * alpha + px[0] * dst_alpha) / out_alpha);
+	px[1] = (unsigned char) ((color.green * alpha + px[1] * dst_alpha) / out_alpha);
+	px[2] = (unsigned char) ((color.blue * alpha + px[2] * dst_alpha) / out_alpha);
+	px[3] = (unsigned char) out_alpha;
+}
+
+void raster_canvas::fill_rect(int x, int y, int width, int height, const litehtml::web_color& color)
+{
+	int left	= std::max(x, m_clip.left());
+	int top		= std::max(y, m_clip.top());
+	int right	= std::min(x + width, m_clip.right());
+	int bottom	= std::min(y + height, m_clip.bottom());
+	for (int py = top; py < bottom; py++)
+	{
+		for (int px = left; px < right; px++)
+		{
+			blend_pixel(px, py, color);
+		}
+	}
+}
+
+namespace
+{
+	// Part of the pixel inside the ellipse, from 4x4 samples
+	int ellipse_coverage(int px, int py, double cx, double cy, double rx, double ry)
+	{
+		if (rx <= 0 || ry <= 0)
+		{
+			return 0;
+		}
+		int inside = 0;
+		for (int sy = 0; sy < 4; sy++)
+		{
+			for (int sx = 0; sx < 4; sx++)
+			{
+				double dx = (px + (sx + 0.5) / 4 - cx) / rx;
+				double dy = (py + (sy + 0.5) / 4 - cy) / ry;
+				if (dx * dx + dy * dy <= 1)
+				{
+					inside++;
+				}
+			}
+		}
+		return inside * 255 / 16;
+	}
+}
+
+void raster_canvas::fill_ellipse(int x, int y, int width, int height, const litehtml::web_color& color)
+{
+	draw_ellipse(x, y, width, height, color, std::max(width, height));
+}
+
+void raster_canvas::draw_ellipse(int x, int y, int width, int height, const litehtml::web_color& color, int line_width)
+{
+	double cx = x + width / 2.0;
+	double cy = y + height / 2.0;
+	double rx = width / 2.0;
+	double ry = height / 2.0;
+
+	int left	= std::max(x, m_clip.left());
+	int top		= std::max(y, m_clip.top());
+	int right	= std::min(x + width, m_clip.right());
+	int bottom	= std::min(y + height, m_clip.bottom());
+	for (int py = top; py < bottom; py++)
+	{
+		for (int px = left; px < right; px++)
+		{
+			int coverage = ellipse_coverage(px, py, cx, cy, rx, ry) - ellipse_coverage(px, py, cx, cy, rx - line_width, ry - line_width);
+			if (coverage > 0)
+			{
+				blend_pixel(px, py, color, coverage);
+			}
+		}
+	}
+}
+
+void raster_canvas::draw_image(const raster_canvas& img, int x, int y, int width, int height)
+{
+	if (img.width() <= 0 || img.height() <= 0 || width <= 0 || height <= 0)
+	{
+		return;
+	}
+	int left	= std::max(x, m_clip.left());
+	int top		= std::max(y, m_clip.top());
+	int right	= std::min(x + width, m_clip.right());
+	int bottom	= std::min(y + height, m_clip.bottom());
+	for (int py = top; py < bottom; py++)
+	{
+		int src_y = (int) ((long long) (py - y) * img.height() / height);
+		for (int px = left; px < right; px++)
+		{
+			int src_x = (int) ((long long) (px - x) * img.width() / width);
+			blend_pixel(px, py, img.get_pixel(src_x, src_y));
+		}
+	}
+}
+
+namespace
+{
+	unsigned int crc32(const unsigned char* data, size_t size, unsigned int crc = 0)
+	{
+		static unsigned int table[256];
+		if (!table[1])
+		{
+			for (unsigned int n = 0; n < 256; n++)
+			{
+				unsigned int c = n;
+				for (int k = 0; k < 8; k++)
+				{
+					c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+				}
+				table[n] = c;
+			}
+		}
+		crc = ~crc;
+		for (size_t i = 0; i < size; i++)
+		{
+			crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		}
+		return ~crc;
+	}
+
+	void put_uint32(std::vector<unsigned char>& data, unsigned int val)
+	{
+		data.push_back((unsigned char) (val >> 24));
+		data.push_back((unsigned char) (val >> 16));
+		data.push_back((unsigned char) (val >> 8));
+		data.push_back((unsigned char) val);
+	}
+
+	void put_chunk(std::vector<unsigned char>& data, const char* type, const std::vector<unsigned char>& chunk)
+	{
+		put_uint32(data, (unsigned int) chunk.size());
+		size_t start = data.size();
+		data.insert(data.end(), type, type + 4);
+		data.insert(data.end(), chunk.begin(), chunk.end());
+		put_uint32(data, crc32(&data[start], data.size() - start));
+	}
+
+	bool write_file(const char* path, const void* data, size_t size)
+	{
+		FILE* f = fopen(path, "wb");
+		if (!f)
+		{
+			return false;
+		}
+		bool ret = fwrite(data, 1, size, f) == size;
+		return fclose(f) == 0 && ret;
+	}
+}
+
+// PNG with the image data in stored (not compressed) deflate blocks, so no zlib is needed
+bool raster_canvas::save_png(std::vector<unsigned char>& data) const
+{
+	if (m_width <= 0 || m_height <= 0)
+	{
+		return false;
+	}
+	static const unsigned char signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	data.assign(signature, signature + sizeof(signature));
+
+	std::vector<unsigned char> header;
+	put_uint32(header, m_width);
+	put_uint32(header, m_height);
+	header.push_back(8);	// bit depth
+	header.push_back(6);	// RGBA
+	header.push_back(0);	// compression
+	header.push_back(0);	// filter
+	header.push_back(0);	// no interlace
+	put_chunk(data, "IHDR", header);
+
+	// rows prefixed with the filter type 0
+	size_t row_size = (size_t) m_width * 4;
+	std::vector<unsigned char> raw;
+	raw.reserve((row_size + 1) * m_height);
+	for (int y = 0; y < m_height; y++)
+	{
+		raw.push_back(0);
+		raw.insert(raw.end(), m_pixels.begin() + y * row_size, m_pixels.begin() + (y + 1) * row_size);
+	}
+
+	std::vector<unsigned char> zlib;
+	zlib.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+	zlib.push_back(0x78);
+	zlib.push_back(0x01);
+	size_t pos = 0;
+	do
+	{
+		size_t len = std::min(raw.size() - pos, (size_t) 65535);
+		zlib.push_back(pos + len == raw.size() ? 1 : 0);
+		zlib.push_back((unsigned char) len);
+		zlib.push_back((unsigned char) (len >> 8));
+		zlib.push_back((unsigned char) ~len);
+		zlib.push_back((unsigned char) (~len >> 8));
+		zlib.insert(zlib.end(), raw.begin() + pos, raw.begin() + pos + len);
+		pos += len;
+	} while (pos < raw.size());
+
+	unsigned int a = 1;
+	unsigned int b = 0;
+	for (unsigned char c : raw)
+	{
+		a = (a + c) % 65521;
+		b = (b + a) % 65521;
+	}
+	put_uint32(zlib, (b << 16) | a);
+	put_chunk(data, "IDAT", zlib);
+	put_chunk(data, "IEND", std::vector<unsigned char>());
+	return true;
+}
+
+bool raster_canvas::write_png(const char* path) const
+{
+	std::vector<unsigned char> data;
+	return save_png(data) && write_file(path, data.data(), data.size());
+}
+
+// Binary PPM, the alpha channel is dropped
+bool raster_canvas::write_ppm(const char* path) const
+{
+	char header[64];
+	int header_size = snprintf(header, sizeof(header), "P6\n%d %d\n255\n", m_width, m_height);
+	std::vector<unsigned char> data(header, header + header_size);
+	data.reserve(header_size + (size_t) m_width * m_height * 3);
+	for (size_t i = 0; i < m_pixels.size(); i += 4)
+	{
+		data.insert(data.end(), &m_pixels[i], &m_pixels[i] + 3);
+	}
+	return write_file(path, data.data(), data.size());
+}
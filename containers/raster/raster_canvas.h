@@ -0,0 +1,42 @@
+#pragma once
+
+#include "../../include/litehtml.h"
+#include <vector>
+#include <string>
+
+// RGBA image in memory, 8 bits per channel, not premultiplied.
+// All the drawing is clipped by the clip rectangle and blended over the pixels.
+class raster_canvas
+{
+	int							m_width;
+	int							m_height;
+	std::vector<unsigned char>	m_pixels;
+	litehtml::position			m_clip;
+public:
+	raster_canvas(int width = 0, int height = 0);
+
+	int						width() const		{ return m_width; }
+	int						height() const		{ return m_height; }
+	const unsigned char*	data() const		{ return m_pixels.data(); }
+	unsigned char*			data()				{ return m_pixels.data(); }
+
+	void					resize(int width, int height);
+	void					clear(const litehtml::web_color& color);
+	litehtml::web_color		get_pixel(int x, int y) const;
+
+	void					set_clip(const litehtml::position& clip);
+	void					reset_clip();
+	const litehtml::position&	clip() const	{ return m_clip; }
+
+	// coverage is the part of the pixel covered by the shape, 0 - 255
+	void					blend_pixel(int x, int y, const litehtml::web_color& color, int coverage = 255);
+	void					fill_rect(int x, int y, int width, int height, const litehtml::web_color& color);
+	void					fill_ellipse(int x, int y, int width, int height, const litehtml::web_color& color);
+	void					draw_ellipse(int x, int y, int width, int height, const litehtml::web_color& color, int line_width);
+	// draws img scaled to width x height, the nearest pixels are taken
+	void					draw_image(const raster_canvas& img, int x, int y, int width, int height);
+
+	bool					save_png(std::vector<unsigned char>& data) const;
+	bool					write_png(const char* path) const;
+	bool					write_ppm(const char* path) const;
+};
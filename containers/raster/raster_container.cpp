@@ -0,0 +1,423 @@
+#include "raster_container.h"
+#include <algorithm>
+
+namespace
+{
+	litehtml::position intersect(const litehtml::position& a, const litehtml::position& b)
+	{
+		int left	= std::max(a.left(), b.left());
+		int top		= std::max(a.top(), b.top());
+		int right	= std::min(a.right(), b.right());
+		int bottom	= std::min(a.bottom(), b.bottom());
+		return litehtml::position(left, top, std::max(right - left, 0), std::max(bottom - top, 0));
+	}
+}
+
+raster_container::raster_container(int width, int height, raster_font_engine* fonts) : m_canvas(width, height)
+{
+	if (!fonts)
+	{
+		m_own_fonts.reset(new bitmap_font_engine);
+		fonts = m_own_fonts.get();
+	}
+	m_fonts = fonts;
+	m_default_font_size = 16;
+	m_default_font_name = _t("monospace");
+}
+
+raster_container::~raster_container()
+{
+}
+
+void raster_container::resize(int width, int height)
+{
+	m_canvas.resize(width, height);
+	m_clips.clear();
+}
+
+void raster_container::draw(const litehtml::document::ptr& doc, int scroll_x, int scroll_y, const litehtml::web_color& background)
+{
+	m_canvas.clear(background);
+	m_clips.clear();
+	litehtml::position clip(0, 0, m_canvas.width(), m_canvas.height());
+	doc->draw((litehtml::uint_ptr) &m_canvas, -scroll_x, -scroll_y, 0, &clip);
+	m_canvas.reset_clip();
+}
+
+void raster_container::set_image(const litehtml::tstring& url, const std::shared_ptr<raster_canvas>& img)
+{
+	m_images.add(url, img, img->width(), img->height(), true);
+}
+
+void raster_container::set_default_font(const litehtml::tchar_t* name, int size)
+{
+	m_default_font_name = name;
+	m_default_font_size = size;
+}
+
+raster_canvas& raster_container::get_canvas(litehtml::uint_ptr hdc)
+{
+	return hdc ? *(raster_canvas*) hdc : m_canvas;
+}
+
+void raster_container::apply_clip(raster_canvas& canvas)
+{
+	canvas.reset_clip();
+	litehtml::position clip = canvas.clip();
+	for (const auto& clip_box : m_clips)
+	{
+		clip = intersect(clip, clip_box);
+	}
+	canvas.set_clip(clip);
+}
+
+// The image scaled to width x height when they are given
+std::shared_ptr<raster_canvas> raster_container::find_image(const litehtml::tchar_t* src, const litehtml::tchar_t* baseurl, int width, int height)
+{
+	litehtml::tstring url;
+	make_url(src, baseurl, url);
+	std::shared_ptr<raster_canvas> img;
+	if (!m_images.find(url, img))
+	{
+		url = src;
+		if (!m_images.find(url, img))
+		{
+			return nullptr;
+		}
+	}
+	if (width < 0 || height < 0)
+	{
+		return img;
+	}
+
+	std::shared_ptr<raster_canvas> scaled;
+	if (!m_images.find_scaled(url, width, height, scaled))
+	{
+		scaled = std::make_shared<raster_canvas>(width, height);
+		scaled->draw_image(*img, 0, 0, width, height);
+		m_images.add_scaled(url, scaled, width, height);
+	}
+	return scaled;
+}
+
+litehtml::uint_ptr raster_container::create_font(const litehtml::tchar_t* faceName, int size, int weight, litehtml::font_style italic, unsigned int decoration, litehtml::font_metrics* fm)
+{
+	raster_font* font = m_fonts->create_font(faceName, size, weight, italic, decoration);
+	if (fm)
+	{
+		if (font)
+		{
+			fm->ascent		= font->ascent;
+			fm->descent		= font->descent;
+			fm->height		= font->ascent + font->descent;
+			fm->x_height	= font->x_height;
+		}
+		else
+		{
+			*fm = litehtml::font_metrics();
+		}
+	}
+	return (litehtml::uint_ptr) font;
+}
+
+void raster_container::delete_font(litehtml::uint_ptr hFont)
+{
+	if (hFont)
+	{
+		m_fonts->delete_font((raster_font*) hFont);
+	}
+}
+
+int raster_container::text_width(const litehtml::tchar_t* text, litehtml::uint_ptr hFont)
+{
+	return hFont ? m_fonts->text_width((raster_font*) hFont, text) : 0;
+}
+
+void raster_container::draw_text(litehtml::uint_ptr hdc, const litehtml::tchar_t* text, litehtml::uint_ptr hFont, litehtml::web_color color, const litehtml::position& pos)
+{
+	raster_font* font = (raster_font*) hFont;
+	if (!font)
+	{
+		return;
+	}
+	raster_canvas& canvas = get_canvas(hdc);
+	apply_clip(canvas);
+
+	int x = pos.left();
+	int y = pos.bottom() - font->descent;
+	m_fonts->draw_text(canvas, font, text, x, y, color);
+
+	if (font->decoration)
+	{
+		int tw = m_fonts->text_width(font, text);
+		int line_width = std::max(1, font->size / 14);
+		if (font->decoration & litehtml::font_decoration_underline)
+		{
+			canvas.fill_rect(x, y + 1, tw, line_width, color);
+		}
+		if (font->decoration & litehtml::font_decoration_linethrough)
+		{
+			canvas.fill_rect(x, y - font->x_height / 2 - line_width / 2, tw, line_width, color);
+		}
+		if (font->decoration & litehtml::font_decoration_overline)
+		{
+			canvas.fill_rect(x, y - font->ascent, tw, line_width, color);
+		}
+	}
+}
+
+int raster_container::pt_to_px(int pt)
+{
+	return (int) ((double) pt * 96 / 72.0);
+}
+
+int raster_container::get_default_font_size() const
+{
+	return m_default_font_size;
+}
+
+const litehtml::tchar_t* raster_container::get_default_font_name() const
+{
+	return m_default_font_name.c_str();
+}
+
+void raster_container::load_image(const litehtml::tchar_t* src, const litehtml::tchar_t* baseurl, const litehtml::string_map* attrs, bool redraw_on_ready)
+{
+}
+
+void raster_container::get_image_size(const litehtml::tchar_t* src, const litehtml::tchar_t* baseurl, const litehtml::string_map* attrs, litehtml::size& sz)
+{
+	litehtml::tstring url;
+	make_url(src, baseurl, url);
+	if (!m_images.get_size(url, sz) && !m_images.get_size(src, sz))
+	{
+		sz.width	= 0;
+		sz.height	= 0;
+	}
+}
+
+void raster_container::draw_background(litehtml::uint_ptr hdc, const litehtml::background_paint& bg)
+{
+	raster_canvas& canvas = get_canvas(hdc);
+	apply_clip(canvas);
+	canvas.set_clip(intersect(canvas.clip(), bg.clip_box));
+
+	canvas.fill_rect(bg.clip_box.x, bg.clip_box.y, bg.clip_box.width, bg.clip_box.height, bg.color);
+
+	litehtml::size img_size;
+	get_image_size(bg.image.c_str(), bg.baseurl.c_str(), nullptr, img_size);
+	int width	= bg.image_size.width ? bg.image_size.width : img_size.width;
+	int height	= bg.image_size.height ? bg.image_size.height : img_size.height;
+	if (bg.image.empty() || width <= 0 || height <= 0)
+	{
+		return;
+	}
+	// the image scaled once to the drawn size, the tiles are copied from it
+	std::shared_ptr<raster_canvas> img = find_image(bg.image.c_str(), bg.baseurl.c_str(), width, height);
+	if (img)
+	{
+		bool repeat_x = bg.repeat == litehtml::background_repeat_repeat || bg.repeat == litehtml::background_repeat_repeat_x;
+		bool repeat_y = bg.repeat == litehtml::background_repeat_repeat || bg.repeat == litehtml::background_repeat_repeat_y;
+
+		const litehtml::position& clip = canvas.clip();
+		int start_x = bg.position_x;
+		int start_y = bg.position_y;
+		if (repeat_x)
+		{
+			start_x -= (start_x - clip.left() + width - 1) / width * width;
+		}
+		if (repeat_y)
+		{
+			start_y -= (start_y - clip.top() + height - 1) / height * height;
+		}
+		for (int y = start_y; y < clip.bottom(); y += height)
+		{
+			for (int x = start_x; x < clip.right(); x += width)
+			{
+				canvas.draw_image(*img, x, y, width, height);
+				if (!repeat_x)
+				{
+					break;
+				}
+			}
+			if (!repeat_y)
+			{
+				break;
+			}
+		}
+	}
+}
+
+void raster_container::draw_borders(litehtml::uint_ptr hdc, const litehtml::borders& borders, const litehtml::position& draw_pos, bool root)
+{
+	raster_canvas& canvas = get_canvas(hdc);
+	apply_clip(canvas);
+
+	if (borders.top.width > 0 && borders.top.style > litehtml::border_style_hidden)
+	{
+		canvas.fill_rect(draw_pos.x, draw_pos.y, draw_pos.width, borders.top.width, borders.top.color);
+	}
+	if (borders.bottom.width > 0 && borders.bottom.style > litehtml::border_style_hidden)
+	{
+		canvas.fill_rect(draw_pos.x, draw_pos.bottom() - borders.bottom.width, draw_pos.width, borders.bottom.width, borders.bottom.color);
+	}
+	if (borders.left.width > 0 && borders.left.style > litehtml::border_style_hidden)
+	{
+		canvas.fill_rect(draw_pos.x, draw_pos.y, borders.left.width, draw_pos.height, borders.left.color);
+	}
+	if (borders.right.width > 0 && borders.right.style > litehtml::border_style_hidden)
+	{
+		canvas.fill_rect(draw_pos.right() - borders.right.width, draw_pos.y, borders.right.width, draw_pos.height, borders.right.color);
+	}
+}
+
+void raster_container::draw_list_marker(litehtml::uint_ptr hdc, const litehtml::list_marker& marker)
+{
+	raster_canvas& canvas = get_canvas(hdc);
+	apply_clip(canvas);
+
+	std::shared_ptr<raster_canvas> img = marker.image.empty() ? nullptr : find_image(marker.image.c_str(), marker.baseurl);
+	if (img)
+	{
+		canvas.draw_image(*img, marker.pos.x, marker.pos.y, img->width(), img->height());
+		return;
+	}
+	switch (marker.marker_type)
+	{
+	case litehtml::list_style_type_circle:
+		canvas.draw_ellipse(marker.pos.x, marker.pos.y, marker.pos.width, marker.pos.height, marker.color, 1);
+		break;
+	case litehtml::list_style_type_square:
+		canvas.fill_rect(marker.pos.x, marker.pos.y, marker.pos.width, marker.pos.height, marker.color);
+		break;
+	default:
+		canvas.fill_ellipse(marker.pos.x, marker.pos.y, marker.pos.width, marker.pos.height, marker.color);
+		break;
+	}
+}
+
+std::shared_ptr<litehtml::element> raster_container::create_element(const litehtml::tchar_t* tag_name, const litehtml::string_map& attributes, const std::shared_ptr<litehtml::document>& doc)
+{
+	return 0;
+}
+
+void raster_container::get_media_features(litehtml::media_features& media) const
+{
+	litehtml::position client;
+	get_client_rect(client);
+	media.type			= litehtml::media_type_screen;
+	media.width			= client.width;
+	media.height		= client.height;
+	media.depth			= 0;
+	media.device_width	= client.width;
+	media.device_height	= client.height;
+	media.device_depth	= 0;
+	media.color			= 8;
+	media.monochrome	= 0;
+	media.color_index	= 256;
+	media.resolution	= 96;
+}
+
+void raster_container::get_language(litehtml::tstring& language, litehtml::tstring& culture) const
+{
+	language = _t("en");
+	culture = _t("");
+}
+
+void raster_container::link(const std::shared_ptr<litehtml::document>& ptr, const litehtml::element::ptr& el)
+{
+}
+
+void raster_container::transform_text(litehtml::tstring& text, litehtml::text_transform tt)
+{
+	if (text.empty())
+	{
+		return;
+	}
+	// only the ASCII letters are changed
+	switch (tt)
+	{
+	case litehtml::text_transform_capitalize:
+		if (text[0] >= _t('a') && text[0] <= _t('z'))
+		{
+			text[0] = text[0] - _t('a') + _t('A');
+		}
+		break;
+	case litehtml::text_transform_uppercase:
+		for (auto& ch : text)
+		{
+			if (ch >= _t('a') && ch <= _t('z'))
+			{
+				ch = ch - _t('a') + _t('A');
+			}
+		}
+		break;
+	case litehtml::text_transform_lowercase:
+		for (auto& ch : text)
+		{
+			if (ch >= _t('A') && ch <= _t('Z'))
+			{
+				ch = ch - _t('A') + _t('a');
+			}
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+void raster_container::set_clip(const litehtml::position& pos, const litehtml::border_radiuses& bdr_radius, bool valid_x, bool valid_y)
+{
+	litehtml::position clip_pos = pos;
+	litehtml::position client_pos;
+	get_client_rect(client_pos);
+	if (!valid_x)
+	{
+		clip_pos.x		= client_pos.x;
+		clip_pos.width	= client_pos.width;
+	}
+	if (!valid_y)
+	{
+		clip_pos.y		= client_pos.y;
+		clip_pos.height	= client_pos.height;
+	}
+	m_clips.push_back(clip_pos);
+}
+
+void raster_container::del_clip()
+{
+	if (!m_clips.empty())
+	{
+		m_clips.pop_back();
+	}
+}
+
+void raster_container::make_url(const litehtml::tchar_t* url, const litehtml::tchar_t* basepath, litehtml::tstring& out)
+{
+	out = url;
+}
+
+void raster_container::set_caption(const litehtml::tchar_t* caption)
+{
+}
+
+void raster_container::set_base_url(const litehtml::tchar_t* base_url)
+{
+}
+
+void raster_container::on_anchor_click(const litehtml::tchar_t* url, const litehtml::element::ptr& el)
+{
+}
+
+void raster_container::set_cursor(const litehtml::tchar_t* cursor)
+{
+}
+
+void raster_container::import_css(litehtml::tstring& text, const litehtml::tstring& url, litehtml::tstring& baseurl)
+{
+}
+
+void raster_container::get_client_rect(litehtml::position& client) const
+{
+	client = litehtml::position(0, 0, m_canvas.width(), m_canvas.height());
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "raster_canvas.h"
+#include "raster_font.h"
+#include "../image_cache/image_cache.h"
+#include <memory>
+
+// Headless container drawing into an RGBA canvas in memory, with no
+// dependency on a windowing system. It is meant for server side rendering,
+// the benchmarks and the pixel tests.
+//
+// doc->draw() takes the canvas as hdc, (litehtml::uint_ptr) 0 draws into the
+// container canvas. Images are not decoded here: the decoded images are given
+// with set_image() and kept pinned in the image cache, the variants scaled for
+// drawing are evicted over its budget. The z axis is ignored, the document is drawn on the x/y plane.
+// Borders are drawn solid and the corners are not rounded.
+class raster_container : public litehtml::document_container
+{
+public:
+	typedef image_cache<std::shared_ptr<raster_canvas>>	images_cache;
+private:
+
+	raster_canvas						m_canvas;
+	std::unique_ptr<raster_font_engine>	m_own_fonts;
+	raster_font_engine*					m_fonts;
+	litehtml::position::vector			m_clips;
+	images_cache						m_images;
+	int									m_default_font_size;
+	litehtml::tstring					m_default_font_name;
+public:
+	// the font engine must live longer than the container, the bundled bitmap font is used without one
+	raster_container(int width, int height, raster_font_engine* fonts = nullptr);
+	virtual ~raster_container();
+
+	raster_canvas&						canvas() { return m_canvas; }
+	void								resize(int width, int height);
+	// clears the canvas with the background color and draws the part of the document under it
+	void								draw(const litehtml::document::ptr& doc, int scroll_x = 0, int scroll_y = 0, const litehtml::web_color& background = litehtml::web_color(255, 255, 255));
+	void								set_image(const litehtml::tstring& url, const std::shared_ptr<raster_canvas>& img);
+	images_cache&						images() { return m_images; }
+	void								set_default_font(const litehtml::tchar_t* name, int size);
+
+	virtual litehtml::uint_ptr			create_font(const litehtml::tchar_t* faceName, int size, int weight, litehtml::font_style italic, unsigned int decoration, litehtml::font_metrics* fm) override;
+	virtual void						delete_font(litehtml::uint_ptr hFont) override;
+	virtual int							text_width(const litehtml::tchar_t* text, litehtml::uint_ptr hFont) override;
+	virtual void						draw_text(litehtml::uint_ptr hdc, const litehtml::tchar_t* text, litehtml::uint_ptr hFont, litehtml::web_color color, const litehtml::position& pos) override;
+	virtual int							pt_to_px(int pt) override;
+	virtual int							get_default_font_size() const override;
+	virtual const litehtml::tchar_t*	get_default_font_name() const override;
+	virtual void 						load_image(const litehtml::tchar_t* src, const litehtml::tchar_t* baseurl, const litehtml::string_map* attrs, bool redraw_on_ready) override;
+	virtual void						get_image_size(const litehtml::tchar_t* src, const litehtml::tchar_t* baseurl, const litehtml::string_map* attrs, litehtml::size& sz) override;
+	virtual void						draw_background(litehtml::uint_ptr hdc, const litehtml::background_paint& bg) override;
+	virtual void						draw_borders(litehtml::uint_ptr hdc, const litehtml::borders& borders, const litehtml::position& draw_pos, bool root) override;
+	virtual void 						draw_list_marker(litehtml::uint_ptr hdc, const litehtml::list_marker& marker) override;
+	virtual std::shared_ptr<litehtml::element>	create_element(const litehtml::tchar_t *tag_name,
+																 const litehtml::string_map &attributes,
+																 const std::shared_ptr<litehtml::document> &doc) override;
+	virtual void						get_media_features(litehtml::media_features& media) const override;
+	virtual void						get_language(litehtml::tstring& language, litehtml::tstring & culture) const override;
+	virtual void 						link(const std::shared_ptr<litehtml::document> &ptr, const litehtml::element::ptr& el) override;
+
+	virtual	void						transform_text(litehtml::tstring& text, litehtml::text_transform tt) override;
+	virtual void						set_clip(const litehtml::position& pos, const litehtml::border_radiuses& bdr_radius, bool valid_x, bool valid_y) override;
+	virtual void						del_clip() override;
+
+	virtual void						make_url(const litehtml::tchar_t* url, const litehtml::tchar_t* basepath, litehtml::tstring& out);
+
+	virtual	void 						set_caption(const litehtml::tchar_t* caption) override;
+	virtual	void 						set_base_url(const litehtml::tchar_t* base_url) override;
+	virtual void						on_anchor_click(const litehtml::tchar_t* url, const litehtml::element::ptr& el) override;
+	virtual	void						set_cursor(const litehtml::tchar_t* cursor) override;
+	virtual void						import_css(litehtml::tstring& text, const litehtml::tstring& url, litehtml::tstring& baseurl) override;
+	virtual void						get_client_rect(litehtml::position& client) const override;
+
+private:
+	raster_canvas&						get_canvas(litehtml::uint_ptr hdc);
+	void								apply_clip(raster_canvas& canvas);
+	std::shared_ptr<raster_canvas>		find_image(const litehtml::tchar_t* src, const litehtml::tchar_t* baseurl, int width = -1, int height = -1);
+};
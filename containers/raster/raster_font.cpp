@@ -0,0 +1,424 @@
+#include "raster_font.h"
+#include <algorithm>
+
+#ifdef LITEHTML_RASTER_FREETYPE
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_SYNTHESIS_H
+#endif
+
+unsigned int raster_font_engine::next_char(const litehtml::tchar_t*& text)
+{
+#ifdef LITEHTML_UTF8
+	const unsigned char* str = (const unsigned char*) text;
+	unsigned int ch = *str++;
+	int extra = 0;
+	if (ch >= 0xF0)		{ ch &= 0x07; extra = 3; }
+	else if (ch >= 0xE0)	{ ch &= 0x0F; extra = 2; }
+	else if (ch >= 0xC0)	{ ch &= 0x1F; extra = 1; }
+	for (; extra && (*str & 0xC0) == 0x80; extra--)
+	{
+		ch = (ch << 6) | (*str++ & 0x3F);
+	}
+	text = (const litehtml::tchar_t*) str;
+	return ch;
+#else
+	return (unsigned int) *text++;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	// 8x16 cells of the characters 32 - 126 with the baseline under the row 12,
+	// one byte per row, the most significant bit on the left.
+	// Rasterized from Source Code Pro (SIL Open Font License) at 15px.
+	const int glyph_width		= 8;
+	const int glyph_height		= 16;
+	const int glyph_ascent		= 12;
+	const int glyph_x_height	= 7;
+	const int glyph_em			= 15;
+
+	const unsigned char glyphs[][glyph_height] =
+	{
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },	// space
+		{ 0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00 },	// !
+		{ 0x00, 0x00, 0x36, 0x36, 0x36, 0x22, 0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },	// "
+		{ 0x00, 0x00, 0x12, 0x12, 0x12, 0x3f, 0x10, 0x14, 0x7f, 0x24, 0x24, 0x24, 0x00, 0x00, 0x00, 0x00 },	// #
+		{ 0x00, 0x08, 0x08, 0x1e, 0x22, 0x20, 0x30, 0x1c, 0x02, 0x03, 0x62, 0x3e, 0x08, 0x08, 0x00, 0x00 },	// $
+		{ 0x00, 0x00, 0x70, 0x51, 0x89, 0x52, 0x70, 0x07, 0x05, 0x28, 0x45, 0x47, 0x00, 0x00, 0x00, 0x00 },	// %
+		{ 0x00, 0x00, 0x18, 0x24, 0x24, 0x28, 0x30, 0x71, 0x49, 0x46, 0x67, 0x39, 0x00, 0x00, 0x00, 0x00 },	// &
+		{ 0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },	// '
+		{ 0x00, 0x02, 0x04, 0x0c, 0x08, 0x18, 0x10, 0x10, 0x10, 0x10, 0x18, 0x08, 0x0c, 0x04, 0x02, 0x00 },	// (
+		{ 0x00, 0x20, 0x10, 0x18, 0x08, 0x0c, 0x04, 0x04, 0x04, 0x04, 0x0c, 0x08, 0x18, 0x10, 0x20, 0x00 },	// )
+		{ 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x3e, 0x1c, 0x14, 0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },	// *
+		{ 0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x7f, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00 },	// +
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c, 0x04, 0x0c, 0x18, 0x00 },	// ,
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },	// -
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x1c, 0x08, 0x00, 0x00, 0x00, 0x00 },	// .
+		{ 0x00, 0x02, 0x02, 0x06, 0x04, 0x04, 0x0c, 0x08, 0x18, 0x10, 0x10, 0x30, 0x20, 0x20, 0x00, 0x00 },	// /
+		{ 0x00, 0x00, 0x1c, 0x22, 0x63, 0x41, 0x49, 0x49, 0x41, 0x63, 0x22, 0x1c, 0x00, 0x00, 0x00, 0x00 },	// 0
+		{ 0x00, 0x00, 0x38, 0x38, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x7f, 0x00, 0x00, 0x00, 0x00 },	// 1
+		{ 0x00, 0x00, 0x3c, 0x66, 0x02, 0x02, 0x02, 0x04, 0x0c, 0x18, 0x30, 0x7f, 0x00, 0x00, 0x00, 0x00 },	// 2
+		{ 0x00, 0x00, 0x3c, 0x62, 0x02, 0x06, 0x1c, 0x06, 0x03, 0x03, 0x62, 0x3c, 0x00, 0x00, 0x00, 0x00 },	// 3
+		{ 0x00, 0x00, 0x06, 0x0e, 0x1e, 0x16, 0x26, 0x46, 0x7f, 0x06, 0x06, 0x06, 0x00, 0x00, 0x00, 0x00 },	// 4
+		{ 0x00, 0x00, 0x3e, 0x20, 0x20, 0x20, 0x3e, 0x03, 0x03, 0x03, 0x42, 0x3c, 0x00, 0x00, 0x00, 0x00 },	// 5
+		{ 0x00, 0x00, 0x1e, 0x30, 0x20, 0x60, 0x5e, 0x63, 0x61, 0x61, 0x33, 0x1e, 0x00, 0x00, 0x00, 0x00 },	// 6
+		{ 0x00, 0x00, 0x7f, 0x02, 0x06, 0x04, 0x0c, 0x08, 0x08, 0x08, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00 },	// 7
+		{ 0x00, 0x00, 0x1c, 0x22, 0x23, 0x32, 0x3e, 0x66, 0x43, 0x41, 0x63, 0x3e, 0x00, 0x00, 0x00, 0x00 },	// 8
+		{ 0x00, 0x00, 0x3c, 0x66, 0x43, 0x43, 0x63, 0x3d, 0x03, 0x02, 0x06, 0x3c, 0x00, 0x00, 0x00, 0x00 },	// 9
+		{ 0x00, 0x00, 0x00, 0x00, 0x08, 0x1c, 0x08, 0x00, 0x00, 0x08, 0x1c, 0x08, 0x00, 0x00, 0x00, 0x00 },	// :
+		{ 0x00, 0x00, 0x00, 0x00, 0x08, 0x1c, 0x08, 0x00, 0x00, 0x00, 0x0c, 0x0c, 0x04, 0x0c, 0x18, 0x00 },	// ;
+		{ 0x00, 0x00, 0x00, 0x00, 0x06, 0x0c, 0x30, 0x20, 0x30, 0x0c, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00 },	// <
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x7f, 0x00, 0x00, 0x00, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },	// =
+		{ 0x00, 0x00, 0x00, 0x00, 0x30, 0x18, 0x06, 0x02, 0x06, 0x18, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00 },	// >
+		{ 0x00, 0x00, 0x1c, 0x26, 0x02, 0x06, 0x04, 0x08, 0x08, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00 },	// ?
+		{ 0x00, 0x00, 0x1e, 0x33, 0x61, 0x41, 0x47, 0x4d, 0x59, 0x59, 0x4f, 0x60, 0x30, 0x1e, 0x00, 0x00 },	// @
+		{ 0x00, 0x00, 0x08, 0x1c, 0x14, 0x14, 0x36, 0x22, 0x3e, 0x63, 0x41, 0x41, 0x00, 0x00, 0x00, 0x00 },	// A
+		{ 0x00, 0x00, 0x7e, 0x62, 0x63, 0x62, 0x7e, 0x63, 0x61, 0x61, 0x63, 0x7e, 0x00, 0x00, 0x00, 0x00 },	// B
+		{ 0x00, 0x00, 0x1e, 0x31, 0x60, 0x60, 0x40, 0x40, 0x60, 0x60, 0x31, 0x1e, 0x00, 0x00, 0x00, 0x00 },	// C
+		{ 0x00, 0x00, 0x7c, 0x66, 0x63, 0x61, 0x61, 0x61, 0x61, 0x63, 0x66, 0x7c, 0x00, 0x00, 0x00, 0x00 },	// D
+		{ 0x00, 0x00, 0x3f, 0x20, 0x20, 0x20, 0x3e, 0x20, 0x20, 0x20, 0x20, 0x3f, 0x00, 0x00, 0x00, 0x00 },	// E
+		{ 0x00, 0x00, 0x3f, 0x20, 0x20, 0x20, 0x20, 0x3e, 0x20, 0x20, 0x20, 0x20, 0x00, 0x00, 0x00, 0x00 },	// F
+		{ 0x00, 0x00, 0x1e, 0x31, 0x60, 0x40, 0x40, 0x47, 0x41, 0x61, 0x31, 0x1e, 0x00, 0x00, 0x00, 0x00 },	// G
+		{ 0x00, 0x00, 0x63, 0x63, 0x63, 0x63, 0x7f, 0x63, 0x63, 0x63, 0x63, 0x63, 0x00, 0x00, 0x00, 0x00 },	// H
+		{ 0x00, 0x00, 0x7f, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x7f, 0x00, 0x00, 0x00, 0x00 },	// I
+		{ 0x00, 0x00, 0x3e, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x66, 0x3c, 0x00, 0x00, 0x00, 0x00 },	// J
+		{ 0x00, 0x00, 0x63, 0x62, 0x64, 0x6c, 0x7c, 0x74, 0x66, 0x62, 0x63, 0x61, 0x00, 0x00, 0x00, 0x00 },	// K
+		{ 0x00, 0x00, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x3f, 0x00, 0x00, 0x00, 0x00 },	// L
+		{ 0x00, 0x00, 0x63, 0x63, 0x63, 0x55, 0x55, 0x49, 0x49, 0x41, 0x41, 0x41, 0x00, 0x00, 0x00, 0x00 },	// M
+		{ 0x00, 0x00, 0x63, 0x63, 0x73, 0x53, 0x6b, 0x6b, 0x65, 0x67, 0x63, 0x63, 0x00, 0x00, 0x00, 0x00 },	// N
+		{ 0x00, 0x00, 0x1c, 0x22, 0x63, 0x41, 0x41, 0x41, 0x41, 0x63, 0x22, 0x1c, 0x00, 0x00, 0x00, 0x00 },	// O
+		{ 0x00, 0x00, 0x7e, 0x63, 0x61, 0x61, 0x63, 0x7e, 0x60, 0x60, 0x60, 0x60, 0x00, 0x00, 0x00, 0x00 },	// P
+		{ 0x00, 0x00, 0x1c, 0x22, 0x63, 0x41, 0x41, 0x41, 0x41, 0x63, 0x22, 0x1c, 0x0c, 0x07, 0x00, 0x00 },	// Q
+		{ 0x00, 0x00, 0x7e, 0x63, 0x61, 0x61, 0x63, 0x7e, 0x64, 0x66, 0x62, 0x61, 0x00, 0x00, 0x00, 0x00 },	// R
+		{ 0x00, 0x00, 0x1e, 0x22, 0x60, 0x20, 0x3c, 0x0e, 0x03, 0x01, 0x63, 0x3e, 0x00, 0x00, 0x00, 0x00 },	// S
+		{ 0x00, 0x00, 0x7f, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00 },	// T
+		{ 0x00, 0x00, 0x61, 0x61, 0x61, 0x61, 0x61, 0x61, 0x63, 0x63, 0x22, 0x1c, 0x00, 0x00, 0x00, 0x00 },	// U
+		{ 0x00, 0x00, 0x41, 0x41, 0x63, 0x22, 0x22, 0x36, 0x14, 0x14, 0x1c, 0x08, 0x00, 0x00, 0x00, 0x00 },	// V
+		{ 0x00, 0x00, 0xc0, 0xc1, 0xc1, 0x49, 0x49, 0x55, 0x55, 0x55, 0x63, 0x23, 0x00, 0x00, 0x00, 0x00 },	// W
+		{ 0x00, 0x00, 0x63, 0x22, 0x36, 0x14, 0x1c, 0x1c, 0x14, 0x36, 0x22, 0x43, 0x00, 0x00, 0x00, 0x00 },	// X
+		{ 0x00, 0x00, 0x41, 0x63, 0x22, 0x36, 0x14, 0x1c, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00 },	// Y
+		{ 0x00, 0x00, 0x7f, 0x03, 0x06, 0x04, 0x0c, 0x18, 0x10, 0x30, 0x60, 0x7f, 0x00, 0x00, 0x00, 0x00 },	// Z
+		{ 0x00, 0x1f, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1f, 0x00, 0x00 },	// [
+		{ 0x00, 0x20, 0x20, 0x30, 0x10, 0x10, 0x18, 0x08, 0x0c, 0x04, 0x04, 0x06, 0x02, 0x02, 0x00, 0x00 },	// backslash
+		{ 0x00, 0x7c, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x7c, 0x00, 0x00 },	// ]
+		{ 0x00, 0x00, 0x08, 0x1c, 0x14, 0x14, 0x22, 0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },	// ^
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7f, 0x00, 0x00 },	// _
+		{ 0x00, 0x18, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },	// `
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x3e, 0x22, 0x03, 0x1f, 0x63, 0x63, 0x3f, 0x00, 0x00, 0x00, 0x00 },	// a
+		{ 0x00, 0x60, 0x60, 0x60, 0x60, 0x7e, 0x63, 0x61, 0x61, 0x61, 0x63, 0x7e, 0x00, 0x00, 0x00, 0x00 },	// b
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x1e, 0x31, 0x60, 0x60, 0x60, 0x31, 0x1e, 0x00, 0x00, 0x00, 0x00 },	// c
+		{ 0x00, 0x03, 0x03, 0x03, 0x03, 0x3f, 0x63, 0x43, 0x43, 0x43, 0x63, 0x3f, 0x00, 0x00, 0x00, 0x00 },	// d
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x1e, 0x23, 0x61, 0x7f, 0x60, 0x20, 0x1e, 0x00, 0x00, 0x00, 0x00 },	// e
+		{ 0x00, 0x07, 0x0c, 0x08, 0x08, 0x3f, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00 },	// f
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x26, 0x62, 0x26, 0x3c, 0x20, 0x3f, 0x41, 0x61, 0x3e, 0x00 },	// g
+		{ 0x00, 0x60, 0x60, 0x60, 0x60, 0x6e, 0x73, 0x63, 0x61, 0x61, 0x61, 0x61, 0x00, 0x00, 0x00, 0x00 },	// h
+		{ 0x00, 0x0c, 0x0c, 0x00, 0x00, 0x7c, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x00, 0x00, 0x00 },	// i
+		{ 0x00, 0x0c, 0x0c, 0x00, 0x00, 0x7c, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0c, 0x78, 0x00 },	// j
+		{ 0x00, 0x20, 0x20, 0x20, 0x20, 0x23, 0x26, 0x2c, 0x3c, 0x26, 0x23, 0x21, 0x00, 0x00, 0x00, 0x00 },	// k
+		{ 0x00, 0x78, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x07, 0x00, 0x00, 0x00, 0x00 },	// l
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x7b, 0x6d, 0x49, 0x49, 0x49, 0x49, 0x49, 0x00, 0x00, 0x00, 0x00 },	// m
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x6e, 0x73, 0x63, 0x61, 0x61, 0x61, 0x61, 0x00, 0x00, 0x00, 0x00 },	// n
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x1c, 0x62, 0x41, 0x41, 0x41, 0x63, 0x1c, 0x00, 0x00, 0x00, 0x00 },	// o
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x7e, 0x63, 0x61, 0x61, 0x61, 0x63, 0x7e, 0x60, 0x60, 0x60, 0x00 },	// p
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x3f, 0x63, 0x43, 0x43, 0x43, 0x63, 0x3f, 0x03, 0x03, 0x03, 0x00 },	// q
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x27, 0x38, 0x30, 0x20, 0x20, 0x20, 0x20, 0x00, 0x00, 0x00, 0x00 },	// r
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x3e, 0x22, 0x30, 0x1e, 0x03, 0x63, 0x3e, 0x00, 0x00, 0x00, 0x00 },	// s
+		{ 0x00, 0x00, 0x00, 0x10, 0x10, 0x7f, 0x10, 0x10, 0x10, 0x10, 0x18, 0x0f, 0x00, 0x00, 0x00, 0x00 },	// t
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x43, 0x43, 0x43, 0x43, 0x63, 0x67, 0x3b, 0x00, 0x00, 0x00, 0x00 },	// u
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x41, 0x63, 0x22, 0x36, 0x14, 0x1c, 0x0c, 0x00, 0x00, 0x00, 0x00 },	// v
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0xc8, 0xc9, 0x5d, 0x55, 0x55, 0x77, 0x22, 0x00, 0x00, 0x00, 0x00 },	// w
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x63, 0x36, 0x1c, 0x18, 0x1c, 0x26, 0x63, 0x00, 0x00, 0x00, 0x00 },	// x
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x41, 0x63, 0x22, 0x32, 0x14, 0x1c, 0x0c, 0x08, 0x18, 0x70, 0x00 },	// y
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x3f, 0x02, 0x04, 0x08, 0x10, 0x20, 0x7f, 0x00, 0x00, 0x00, 0x00 },	// z
+		{ 0x00, 0x0f, 0x08, 0x08, 0x08, 0x08, 0x18, 0x30, 0x18, 0x08, 0x08, 0x08, 0x08, 0x0f, 0x00, 0x00 },	// {
+		{ 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08 },	// |
+		{ 0x00, 0x78, 0x08, 0x08, 0x08, 0x08, 0x08, 0x06, 0x0c, 0x08, 0x08, 0x08, 0x08, 0x78, 0x00, 0x00 },	// }
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x39, 0x4e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },	// ~
+	};
+
+	int scale(int val, int size)
+	{
+		return (val * size + glyph_em / 2) / glyph_em;
+	}
+
+	bool glyph_bit(const unsigned char* glyph, int col, int row, bool bold)
+	{
+		if (row < 0 || row >= glyph_height)
+		{
+			return false;
+		}
+		unsigned int bits = glyph[row];
+		if (bold)
+		{
+			bits |= bits >> 1;
+		}
+		return col >= 0 && col < glyph_width && (bits & (0x80 >> col));
+	}
+}
+
+int bitmap_font_engine::char_width(int size)
+{
+	return std::max(1, scale(glyph_width, size));
+}
+
+raster_font* bitmap_font_engine::create_font(const litehtml::tchar_t* face_name, int size, int weight, litehtml::font_style italic, unsigned int decoration)
+{
+	raster_font* font = new raster_font;
+	font->size			= std::max(size, 1);
+	font->weight		= weight;
+	font->italic		= italic == litehtml::fontStyleItalic;
+	font->decoration	= decoration;
+	font->ascent		= scale(glyph_ascent, font->size);
+	font->descent		= scale(glyph_height - glyph_ascent, font->size);
+	font->x_height		= scale(glyph_x_height, font->size);
+	font->face			= nullptr;
+	return font;
+}
+
+void bitmap_font_engine::delete_font(raster_font* font)
+{
+	delete font;
+}
+
+int bitmap_font_engine::text_width(raster_font* font, const litehtml::tchar_t* text)
+{
+	int count = 0;
+	while (*text)
+	{
+		next_char(text);
+		count++;
+	}
+	return count * char_width(font->size);
+}
+
+void bitmap_font_engine::draw_text(raster_canvas& canvas, raster_font* font, const litehtml::tchar_t* text, int x, int y, const litehtml::web_color& color)
+{
+	int cw = char_width(font->size);
+	int ch = font->ascent + font->descent;
+	if (ch <= 0)
+	{
+		return;
+	}
+	bool bold = font->weight >= 600;
+	// italic is slanted by 1/5
+	int slant = font->italic ? font->ascent / 5 + 1 : 0;
+	int top = y - font->ascent;
+
+	while (*text)
+	{
+		unsigned int c = next_char(text);
+		if (c > ' ')
+		{
+			const unsigned char* glyph = glyphs[(c < 127 ? c : '?') - ' '];
+			for (int ty = 0; ty < ch; ty++)
+			{
+				for (int tx = 0; tx < cw + slant; tx++)
+				{
+					// 4x4 samples of the pixel mapped back into the glyph cell
+					int inside = 0;
+					for (int sy = 0; sy < 4; sy++)
+					{
+						double fy = ty + (sy + 0.5) / 4;
+						double shift = font->italic ? (font->ascent - fy) / 5 : 0;
+						int row = (int) (fy * glyph_height / ch);
+						for (int sx = 0; sx < 4; sx++)
+						{
+							double fx = tx + (sx + 0.5) / 4 - shift;
+							if (fx >= 0 && glyph_bit(glyph, (int) (fx * glyph_width / cw), row, bold))
+							{
+								inside++;
+							}
+						}
+					}
+					if (inside)
+					{
+						canvas.blend_pixel(x + tx, top + ty, color, inside * 255 / 16);
+					}
+				}
+			}
+		}
+		x += cw;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+#ifdef LITEHTML_RASTER_FREETYPE
+
+freetype_font_engine::freetype_font_engine()
+{
+	FT_Library library = nullptr;
+	FT_Init_FreeType(&library);
+	m_library = library;
+}
+
+freetype_font_engine::~freetype_font_engine()
+{
+	if (m_library)
+	{
+		FT_Done_FreeType((FT_Library) m_library);
+	}
+}
+
+void freetype_font_engine::add_font_file(const litehtml::tchar_t* family, const char* path, int weight, bool italic)
+{
+	litehtml::tstring name = family;
+	litehtml::lcase(name);
+	font_file file;
+	file.path	= path;
+	file.weight	= weight;
+	file.italic	= italic;
+	m_files.insert(std::make_pair(name, file));
+}
+
+void freetype_font_engine::set_default_font_file(const char* path)
+{
+	m_default_file = path;
+}
+
+const freetype_font_engine::font_file* freetype_font_engine::find_file(const litehtml::tchar_t* face_name, int weight, bool italic) const
+{
+	litehtml::string_vector families;
+	litehtml::split_string(face_name, families, _t(","));
+	for (auto& family : families)
+	{
+		litehtml::trim(family);
+		if (family.length() >= 2 && (family.front() == _t('"') || family.front() == _t('\'')))
+		{
+			family = family.substr(1, family.length() - 2);
+		}
+		litehtml::lcase(family);
+
+		// the closest weight with the same style wins
+		const font_file* best = nullptr;
+		auto range = m_files.equal_range(family);
+		for (auto it = range.first; it != range.second; it++)
+		{
+			const font_file& file = it->second;
+			if (!best || (file.italic == italic) > (best->italic == italic) ||
+				((file.italic == italic) == (best->italic == italic) && abs(file.weight - weight) < abs(best->weight - weight)))
+			{
+				best = &file;
+			}
+		}
+		if (best)
+		{
+			return best;
+		}
+	}
+	return nullptr;
+}
+
+raster_font* freetype_font_engine::create_font(const litehtml::tchar_t* face_name, int size, int weight, litehtml::font_style italic, unsigned int decoration)
+{
+	if (!m_library)
+	{
+		return nullptr;
+	}
+	bool is_italic = italic == litehtml::fontStyleItalic;
+	const font_file* file = find_file(face_name, weight, is_italic);
+	const std::string& path = file ? file->path : m_default_file;
+
+	FT_Face face = nullptr;
+	if (path.empty() || FT_New_Face((FT_Library) m_library, path.c_str(), 0, &face))
+	{
+		return nullptr;
+	}
+	FT_Set_Pixel_Sizes(face, 0, std::max(size, 1));
+
+	raster_font* font = new raster_font;
+	font->size			= size;
+	// synthesized when the file doesn't have the style
+	font->weight		= (!file || file->weight < 600) ? weight : 400;
+	font->italic		= (!file || !file->italic) && is_italic;
+	font->decoration	= decoration;
+	font->ascent		= (int) (face->size->metrics.ascender >> 6);
+	font->descent		= (int) (-face->size->metrics.descender >> 6);
+	font->x_height		= font->ascent / 2;
+	if (!FT_Load_Char(face, 'x', FT_LOAD_DEFAULT))
+	{
+		font->x_height = (int) (face->glyph->metrics.height >> 6);
+	}
+	font->face			= face;
+	return font;
+}
+
+void freetype_font_engine::delete_font(raster_font* font)
+{
+	if (font)
+	{
+		FT_Done_Face((FT_Face) font->face);
+		delete font;
+	}
+}
+
+int freetype_font_engine::text_width(raster_font* font, const litehtml::tchar_t* text)
+{
+	if (!font)
+	{
+		return 0;
+	}
+	FT_Face face = (FT_Face) font->face;
+	FT_Pos width = 0;
+	while (*text)
+	{
+		if (!FT_Load_Char(face, next_char(text), FT_LOAD_DEFAULT))
+		{
+			if (font->weight >= 600)
+			{
+				FT_GlyphSlot_Embolden(face->glyph);
+			}
+			width += face->glyph->advance.x;
+		}
+	}
+	return (int) ((width + 32) >> 6);
+}
+
+void freetype_font_engine::draw_text(raster_canvas& canvas, raster_font* font, const litehtml::tchar_t* text, int x, int y, const litehtml::web_color& color)
+{
+	if (!font)
+	{
+		return;
+	}
+	FT_Face face = (FT_Face) font->face;
+	FT_Pos pen = x << 6;
+	while (*text)
+	{
+		if (FT_Load_Char(face, next_char(text), FT_LOAD_DEFAULT))
+		{
+			continue;
+		}
+		FT_GlyphSlot glyph = face->glyph;
+		if (font->weight >= 600)
+		{
+			FT_GlyphSlot_Embolden(glyph);
+		}
+		if (font->italic)
+		{
+			FT_GlyphSlot_Oblique(glyph);
+		}
+		if (!FT_Render_Glyph(glyph, FT_RENDER_MODE_NORMAL))
+		{
+			const FT_Bitmap& bmp = glyph->bitmap;
+			int left = (int) ((pen + 32) >> 6) + glyph->bitmap_left;
+			int top = y - glyph->bitmap_top;
+			for (unsigned int row = 0; row < bmp.rows; row++)
+			{
+				for (unsigned int col = 0; col < bmp.width; col++)
+				{
+					int coverage = bmp.buffer[row * bmp.pitch + col];
+					if (coverage)
+					{
+						canvas.blend_pixel(left + col, top + row, color, coverage);
+					}
+				}
+			}
+		}
+		pen += glyph->advance.x;
+	}
+}
+
+#endif
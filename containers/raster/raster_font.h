@@ -0,0 +1,80 @@
+#pragma once
+
+#include "raster_canvas.h"
+#include <map>
+
+struct raster_font
+{
+	int				size;
+	int				weight;
+	bool			italic;
+	unsigned int	decoration;
+	int				ascent;
+	int				descent;
+	int				x_height;
+	void*			face;		// owned by the font engine
+};
+
+// Measures and draws text for raster_container. Engines can be plugged in
+// to use a real font rasterizer.
+class raster_font_engine
+{
+public:
+	virtual ~raster_font_engine() {}
+
+	virtual raster_font*	create_font(const litehtml::tchar_t* face_name, int size, int weight, litehtml::font_style italic, unsigned int decoration) = 0;
+	virtual void			delete_font(raster_font* font) = 0;
+	virtual int				text_width(raster_font* font, const litehtml::tchar_t* text) = 0;
+	// x is the left of the text and y its baseline
+	virtual void			draw_text(raster_canvas& canvas, raster_font* font, const litehtml::tchar_t* text, int x, int y, const litehtml::web_color& color) = 0;
+
+	static unsigned int		next_char(const litehtml::tchar_t*& text);
+};
+
+// Bundled monospaced font of the printable ASCII characters, scaled to the
+// font size. It has no dependencies and draws the same pixels everywhere, so
+// it fits the pixel tests. Other characters are drawn as '?'.
+class bitmap_font_engine : public raster_font_engine
+{
+public:
+	virtual raster_font*	create_font(const litehtml::tchar_t* face_name, int size, int weight, litehtml::font_style italic, unsigned int decoration) override;
+	virtual void			delete_font(raster_font* font) override;
+	virtual int				text_width(raster_font* font, const litehtml::tchar_t* text) override;
+	virtual void			draw_text(raster_canvas& canvas, raster_font* font, const litehtml::tchar_t* text, int x, int y, const litehtml::web_color& color) override;
+
+	static int				char_width(int size);
+};
+
+#ifdef LITEHTML_RASTER_FREETYPE
+
+// Renders the text with FreeType. The font files are registered by family name,
+// families without a file use the default one. Bold and italic are synthesized
+// when no file is registered for the style.
+class freetype_font_engine : public raster_font_engine
+{
+	struct font_file
+	{
+		std::string	path;
+		int			weight;
+		bool		italic;
+	};
+
+	void*										m_library;
+	std::multimap<litehtml::tstring, font_file>	m_files;
+	std::string									m_default_file;
+public:
+	freetype_font_engine();
+	virtual ~freetype_font_engine();
+
+	void					add_font_file(const litehtml::tchar_t* family, const char* path, int weight = 400, bool italic = false);
+	void					set_default_font_file(const char* path);
+
+	virtual raster_font*	create_font(const litehtml::tchar_t* face_name, int size, int weight, litehtml::font_style italic, unsigned int decoration) override;
+	virtual void			delete_font(raster_font* font) override;
+	virtual int				text_width(raster_font* font, const litehtml::tchar_t* text) override;
+	virtual void			draw_text(raster_canvas& canvas, raster_font* font, const litehtml::tchar_t* text, int x, int y, const litehtml::web_color& color) override;
+private:
+	const font_file*		find_file(const litehtml::tchar_t* face_name, int weight, bool italic) const;
+};
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef LH_BINARY_STREAM_H
+#define LH_BINARY_STREAM_H
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include "os_types.h"
+
+namespace litehtml
+{
+	typedef std::vector<unsigned char>	byte_vector;
+
+	// Appends values to a byte buffer in host byte order.
+	// Blobs are meant to be read back by the same build (same tchar_t and endianness).
+	class binary_writer
+	{
+		byte_vector&	m_data;
+	public:
+		binary_writer(byte_vector& data) : m_data(data)
+		{
+		}
+
+		void write_bytes(const void* data, size_t size)
+		{
+			const unsigned char* bytes = (const unsigned char*) data;
+			m_data.insert(m_data.end(), bytes, bytes + size);
+		}
+
+		void write_int(int val)
+		{
+			write_bytes(&val, sizeof(val));
+		}
+
+		void write_bool(bool val)
+		{
+			unsigned char b = val ? 1 : 0;
+			write_bytes(&b, 1);
+		}
+
+		void write_string(const tstring& str)
+		{
+			write_int((int) str.length());
+			write_bytes(str.c_str(), str.length() * sizeof(tchar_t));
+		}
+	};
+
+	// Reads values written by binary_writer. Any read past the end puts the reader
+	// into the failed state and returns empty values.
+	class binary_reader
+	{
+		const unsigned char*	m_pos;
+		const unsigned char*	m_end;
+		bool					m_failed;
+	public:
+		binary_reader(const unsigned char* data, size_t size)
+		{
+			m_pos = data;
+			m_end = data + size;
+			m_failed = !data;
+		}
+
+		bool failed() const
+		{
+			return m_failed;
+		}
+
+		bool at_end() const
+		{
+			return m_pos == m_end;
+		}
+
+		// Puts the reader into the failed state, for data that is read but not valid
+		void fail()
+		{
+			m_failed = true;
+		}
+
+		bool read_bytes(void* data, size_t size)
+		{
+			if (m_failed || (size_t) (m_end - m_pos) < size)
+			{
+				m_failed = true;
+				return false;
+			}
+			memcpy(data, m_pos, size);
+			m_pos += size;
+			return true;
+		}
+
+		// Returns the next size bytes in place, the data is not copied
+		const unsigned char* read_data(size_t size)
+		{
+			if (m_failed || (size_t) (m_end - m_pos) < size)
+			{
+				m_failed = true;
+				return nullptr;
+			}
+			const unsigned char* data = m_pos;
+			m_pos += size;
+			return data;
+		}
+
+		int read_int()
+		{
+			int val = 0;
+			read_bytes(&val, sizeof(val));
+			return val;
+		}
+
+		bool read_bool()
+		{
+			unsigned char b = 0;
+			read_bytes(&b, 1);
+			return b != 0;
+		}
+
+		// Reads a count of items that are at least min_size bytes each, failing on bogus values
+		int read_count(size_t min_size = 1)
+		{
+			int count = read_int();
+			if (count < 0 || (size_t) (m_end - m_pos) / min_size < (size_t) count)
+			{
+				m_failed = true;
+				return 0;
+			}
+			return count;
+		}
+
+		tstring read_string()
+		{
+			int len = read_count(sizeof(tchar_t));
+			tstring str;
+			if (len)
+			{
+				str.assign((const tchar_t*) m_pos, len);
+				m_pos += len * sizeof(tchar_t);
+			}
+			return str;
+		}
+	};
+}
+
+#endif  // LH_BINARY_STREAM_H
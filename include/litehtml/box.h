@@ -13,6 +13,7 @@ namespace litehtml
 
 	class box
 	{
+		friend class layout_snapshot;
 	public:
 		typedef std::unique_ptr<litehtml::box>	ptr;
 		typedef std::vector< box::ptr >			vector;
@@ -52,12 +53,15 @@ namespace litehtml
 		virtual int					bottom_margin() = 0;
 		virtual void				y_shift(int shift) = 0;
 		virtual void				new_width(int left, int right, elements_vector& els) = 0;
+		virtual size_t				memory_size() const = 0;
 	};
 
 	//////////////////////////////////////////////////////////////////////////
 
 	class block_box : public box
 	{
+		friend class layout_snapshot;
+
 		element::ptr m_element;
 	public:
 		block_box(int top, int left, int front, int right) : box(top, left, front, right)
@@ -79,13 +83,42 @@ namespace litehtml
 		virtual int					bottom_margin();
 		virtual void				y_shift(int shift);
 		virtual void				new_width(int left, int right, elements_vector& els);
+		virtual size_t				memory_size() const;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// inline fragment placed into the line box. The element properties used by the line layout
+	// are fetched once when the element is added to the line.
+	struct line_box_item
+	{
+		typedef std::vector<line_box_item>	vector;
+
+		element*		el;
+		int				width;
+		int				height;
+		int				shift_left;
+		int				shift_right;
+		bool			is_white_space;
+		bool			is_break;
+		bool			is_text;
+		vertical_align	va;
+		font_metrics	fm;
+		int				line_height;
+
+		line_box_item() = default;
+		line_box_item(element* e);
+
+		int	full_width() const { return width + shift_left + shift_right; }
 	};
 
 	//////////////////////////////////////////////////////////////////////////
 
 	class line_box : public box
 	{
-		elements_vector			m_items;
+		friend class layout_snapshot;
+
+		line_box_item::vector	m_items;
 		int						m_height;
 		int						m_width;
 		int						m_depth;
@@ -119,6 +152,11 @@ namespace litehtml
 		virtual int					bottom_margin();
 		virtual void				y_shift(int shift);
 		virtual void				new_width(int left, int right, elements_vector& els);
+		virtual size_t				memory_size() const;
+
+		void						add_item(const line_box_item& item);
+		bool						can_hold(const line_box_item& item, white_space ws);
+		int							line_right() { return m_box_right; }
 
 	private:
 		bool						have_last_space();
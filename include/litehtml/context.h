@@ -2,18 +2,237 @@
 #define LH_CONTEXT_H
 
 #include "stylesheet.h"
+#include "document_stats.h"
+#include <atomic>
+#include <list>
+#include <mutex>
 
 namespace litehtml
 {
+	struct stylesheet_cache_stats
+	{
+		int		hits;
+		int		misses;
+		int		evictions;
+		int		entries;
+		size_t	size;
+
+		stylesheet_cache_stats()
+		{
+			hits = 0;
+			misses = 0;
+			evictions = 0;
+			entries = 0;
+			size = 0;
+		}
+	};
+
+	// Keeps the parsed document stylesheets, so documents sharing the same css
+	// don't parse it again. The cached rule sets are never changed: documents
+	// copy the selectors into their own css and share the declarations.
+	// Entries are evicted in least recently used order when the total size of
+	// the source texts grows over the limit.
+	class stylesheet_cache
+	{
+		// the hash orders the keys quickly, the text is only compared when the hashes are equal
+		struct key
+		{
+			tstring	text;
+			tstring	baseurl;
+			tstring	media;
+			size_t	hash;
+
+			bool operator<(const key& val) const
+			{
+				if (hash != val.hash) return hash < val.hash;
+				if (baseurl != val.baseurl) return baseurl < val.baseurl;
+				if (media != val.media) return media < val.media;
+				return text < val.text;
+			}
+		};
+
+		struct entry
+		{
+			std::shared_ptr<const css>			sheet;
+			size_t								size;
+			std::list<const key*>::iterator		lru;
+		};
+
+		std::map<key, entry>	m_entries;
+		std::list<const key*>	m_lru;		// the keys of m_entries, the most recently used first
+		size_t					m_max_size;
+		stylesheet_cache_stats	m_stats;
+		mutable std::mutex		m_mutex;
+	public:
+		stylesheet_cache()
+		{
+			m_max_size = 8 * 1024 * 1024;
+		}
+
+		std::shared_ptr<const css>	find(const tstring& text, const tstring& baseurl, const tstring& media);
+		void						add(const tstring& text, const tstring& baseurl, const tstring& media, const std::shared_ptr<const css>& sheet);
+		void						set_max_size(size_t max_size);
+		void						clear();
+		stylesheet_cache_stats		stats() const;
+
+	private:
+		static key	make_key(const tstring& text, const tstring& baseurl, const tstring& media);
+		void		evict(size_t max_size);
+	};
+
+	// Fonts shared by the documents of a context. Sharing is off by default:
+	// when enabled, the documents of a container share its fonts once the
+	// container is registered with share_fonts(). The fonts live as long as
+	// the returned registration, which has to be kept with the container and
+	// released before the container and the context are destroyed.
+	class font_cache
+	{
+	public:
+		class registration
+		{
+			font_cache*				m_cache;
+			document_container*		m_container;
+		public:
+			registration()
+			{
+				m_cache = nullptr;
+				m_container = nullptr;
+			}
+
+			registration(font_cache* cache, document_container* container)
+			{
+				m_cache = cache;
+				m_container = container;
+			}
+
+			registration(registration&& val)
+			{
+				m_cache = val.m_cache;
+				m_container = val.m_container;
+				val.m_cache = nullptr;
+			}
+
+			registration& operator=(registration&& val)
+			{
+				if (this != &val)
+				{
+					release();
+					m_cache = val.m_cache;
+					m_container = val.m_container;
+					val.m_cache = nullptr;
+				}
+				return *this;
+			}
+
+			registration(const registration&) = delete;
+			registration& operator=(const registration&) = delete;
+
+			~registration()
+			{
+				release();
+			}
+
+			// Deletes the fonts of the container, its documents stop sharing them
+			void release()
+			{
+				if (m_cache)
+				{
+					m_cache->release_fonts(m_container);
+					m_cache = nullptr;
+				}
+			}
+		};
+
+	private:
+		std::unordered_map<document_container*, fonts_map>	m_fonts;
+		std::atomic<bool>									m_enabled;
+		mutable std::mutex									m_mutex;
+	public:
+		font_cache()
+		{
+			m_enabled = false;
+		}
+
+		~font_cache()
+		{
+			clear();
+		}
+
+		void		enable(bool enabled)
+		{
+			m_enabled = enabled;
+		}
+		bool		enabled() const
+		{
+			return m_enabled;
+		}
+		registration	share_fonts(document_container* container);
+		bool			is_shared(document_container* container) const;
+		font_item		get_font(document_container* container, const font_key& key);
+		void			clear();
+		int				count() const;
+
+	private:
+		void		release_fonts(document_container* container);
+	};
+
+	// One context can be shared by documents created, rendered and drawn on
+	// different threads. The master stylesheet must be loaded before the context
+	// is shared: after that it is only read. Each document evaluates the media
+	// queries of the shared stylesheets on its own, and the stylesheet cache
+	// is locked. A single document must not be used by several threads at once.
 	class context
 	{
-		litehtml::css	m_master_css;
+		litehtml::css		m_master_css;
+		stylesheet_cache	m_stylesheets;
+		font_cache			m_fonts;
+		bool				m_stats_enabled;
+		stats_callback		m_stats_callback;
+		bool				m_trace_enabled;
 	public:
+		context()
+		{
+			m_stats_enabled = false;
+			m_trace_enabled = false;
+		}
+
 		void			load_master_stylesheet(const tchar_t* str);
-		litehtml::css&	master_css()
+		bool			load_master_stylesheet(const unsigned char* data, size_t size);
+		const litehtml::css&	master_css() const
 		{
 			return m_master_css;
 		}
+		stylesheet_cache& stylesheets()
+		{
+			return m_stylesheets;
+		}
+		font_cache& fonts()
+		{
+			return m_fonts;
+		}
+		// Statistics are enabled in the documents created with this context
+		void enable_stats(bool enable, const stats_callback& callback = stats_callback())
+		{
+			m_stats_enabled = enable;
+			m_stats_callback = callback;
+		}
+		bool stats_enabled() const
+		{
+			return m_stats_enabled;
+		}
+		const stats_callback& get_stats_callback() const
+		{
+			return m_stats_callback;
+		}
+		// The documents created with this context record trace spans
+		void enable_trace(bool enable)
+		{
+			m_trace_enabled = enable;
+		}
+		bool trace_enabled() const
+		{
+			return m_trace_enabled;
+		}
 	};
 }
 
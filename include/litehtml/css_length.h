@@ -28,6 +28,7 @@ namespace litehtml
 		css_units	units() const;
 		int			calc_percent(int width) const;
 		void		fromString(const tstring& str, const tstring& predefs = _t(""), int defValue = 0);
+		void		fromString(const tchar_t* str, const tchar_t* predefs = _t(""), int defValue = 0);
 	};
 
 	// css_length inlines
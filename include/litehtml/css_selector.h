@@ -228,19 +228,10 @@ namespace litehtml
 
 		bool parse(const tstring& text);
 		void calc_specificity();
-		bool is_media_valid() const;
+		bool is_media_valid(const document* doc) const;
 		void add_media_to_doc(document* doc) const;
 	};
 
-	inline bool css_selector::is_media_valid() const
-	{
-		if (!m_media_query)
-		{
-			return true;
-		}
-		return m_media_query->is_used();
-	}
-
 
 	//////////////////////////////////////////////////////////////////////////
 
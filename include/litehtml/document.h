@@ -4,6 +4,7 @@
 #include "style.h"
 #include "types.h"
 #include "context.h"
+#include "layout_snapshot.h"
 
 namespace litehtml
 {
@@ -47,10 +48,12 @@ namespace litehtml
 	};
 
 	class html_tag;
+	class el_image;
 
 	class document : public std::enable_shared_from_this<document>, public Document
 	{
 		friend class Document;
+		friend class layout_snapshot;
 	public:
 		typedef std::shared_ptr<document>	ptr;
 		typedef std::weak_ptr<document>		weak_ptr;
@@ -59,18 +62,33 @@ namespace litehtml
 		document_container*					m_container;
 		script_engine*						m_script;
 		fonts_map							m_fonts;
+		font_key							m_font_key;
+		bool								m_shared_fonts;
 		css_text::vector					m_css;
 		litehtml::css						m_styles;
 		litehtml::web_color					m_def_color;
 		litehtml::context*					m_context;
 		litehtml::size						m_size;
 		position::vector					m_fixed_boxes;
-		media_query_list::vector			m_media_lists;
+		std::map<media_query_list::ptr, bool>	m_media_lists;		// media query lists and whether they apply to this document
+		std::map<media_query_list::ptr, std::vector<element::weak_ptr>>	m_media_elements;	// elements that have selectors under the list
+		std::map<tstring, std::vector<std::weak_ptr<el_image>>>			m_image_elements;	// images by src, waiting for image_ready()
 		element::ptr						m_over_element;
 		elements_vector						m_tabular_elements;
 		media_features						m_media;
 		tstring                             m_lang;
 		tstring                             m_culture;
+		bool								m_lazy_layout;
+		position							m_layout_viewport;
+		int									m_layout_samples;
+		int									m_layout_samples_height;
+		int									m_render_width;		// max_width of the last layout, -1 before the first one
+		std::map<tstring, style::ptr>		m_inline_styles;
+		document_stats						m_stats;
+		bool								m_stats_enabled;
+		stats_callback						m_stats_callback;
+		document_trace						m_trace;
+		bool								m_trace_enabled;
 	public:
 		document(litehtml::document_container* objContainer, litehtml::context* ctx);
 		virtual ~document();
@@ -79,6 +97,11 @@ namespace litehtml
 		litehtml::script_engine*		script() { return m_script; }
 		uint_ptr						get_font(const tchar_t* name, int size, const tchar_t* weight, const tchar_t* style, const tchar_t* decoration, font_metrics* fm);
 		int								render(int max_width, render_type rt = render_all);
+		int								render(int max_width, const position& viewport, render_type rt = render_all);
+		bool							realize_layout(const position& region);
+		bool							is_layout_deferred(int top, int bottom) const;
+		void							add_layout_sample(int height);
+		int								get_estimated_height(int def_height) const;
 		void							draw(uint_ptr hdc, int x, int y, int z, const position* clip);
 		web_color						get_def_color() { return m_def_color; }
 		int								cvt_units(const tchar_t* str, int fontSize, bool* is_percent = 0) const;
@@ -91,24 +114,58 @@ namespace litehtml
 		bool							on_lbutton_up(int x, int y, int z, int client_x, int client_y, int client_z, position::vector& redraw_boxes);
 		bool							on_mouse_leave(position::vector& redraw_boxes);
 		litehtml::element::ptr			create_element(const tchar_t* tag_name, const string_map& attributes);
+		litehtml::element::ptr			create_element(const tchar_t* tag_name, string_map&& attributes);
 		element::ptr					root();
 		void							get_fixed_boxes(position::vector& fixed_boxes);
 		void							add_fixed_box(const position& pos);
 		void							add_media_list(media_query_list::ptr list);
+		bool							is_media_used(const media_query_list::ptr& list) const;
+		void							add_media_element(const media_query_list::ptr& list, const element::ptr& el);
+		void							add_image_element(const tstring& src, const std::shared_ptr<el_image>& el);
+		bool							image_ready(const tchar_t* src, const size& sz, position::vector& redraw_boxes);
+		style::ptr						get_inline_style(const tchar_t* str);
 		bool							media_changed();
 		bool							lang_changed();
 		bool                            match_lang(const tstring & lang);
 		void							add_tabular(const element::ptr& el);
 		const element::const_ptr		get_over_element() const { return m_over_element; }
+		document_memory_usage			memory_usage() const;
+		// Writes the element tree with the styles applied and the document style sheets. The snapshot
+		// is loaded by createFromSnapshot with the same master style sheet and user styles.
+		bool							save_snapshot(byte_vector& data, const litehtml::css* user_styles = 0) const;
+
+		void							enable_stats(bool enable) { m_stats_enabled = enable; }
+		bool							stats_enabled() const { return m_stats_enabled; }
+		const document_stats&			stats() const { return m_stats; }
+		void							reset_stats() { m_stats.clear(); }
+		void							set_stats_callback(const stats_callback& callback) { m_stats_callback = callback; }
+		const stats_callback&			get_stats_callback() const { return m_stats_callback; }
+		document_stats*					active_stats() { return m_stats_enabled ? &m_stats : nullptr; }
+		void							enable_trace(bool enable) { m_trace_enabled = enable; }
+		bool							trace_enabled() const { return m_trace_enabled; }
+		const document_trace&			trace() const { return m_trace; }
+		void							reset_trace() { m_trace.clear(); }
+		document_trace*					active_trace() { return m_trace_enabled ? &m_trace : nullptr; }
 
 		static litehtml::document::ptr createFromString(const tchar_t* str, litehtml::document_container* objPainter, litehtml::context* ctx, litehtml::css* user_styles = 0);
 		static litehtml::document::ptr createFromUTF8(const char* str, litehtml::document_container* objPainter, litehtml::context* ctx, litehtml::css* user_styles = 0);
+		// Parses length bytes of utf-8 without a terminating null, e.g. a mapped file. The text is
+		// only read during the call.
+		static litehtml::document::ptr createFromUTF8(const char* str, size_t length, litehtml::document_container* objPainter, litehtml::context* ctx, litehtml::css* user_styles = 0);
+		// Creates the document from save_snapshot() data without parsing the html or matching the selectors.
+		// The data is only read during the call, it can be a mapped file. Returns null for invalid data.
+		static litehtml::document::ptr createFromSnapshot(const unsigned char* data, size_t size, litehtml::document_container* objPainter, litehtml::context* ctx, litehtml::css* user_styles = 0);
 
 	private:
-		litehtml::uint_ptr	add_font(const tchar_t* name, int size, const tchar_t* weight, const tchar_t* style, const tchar_t* decoration, font_metrics* fm);
+		int					render_root(int max_width, render_type rt);
+		bool				relayout_dirty(position::vector& redraw_boxes);
+		void				parse_stylesheets();
+		void				init_elements();
+		litehtml::uint_ptr	add_font(const font_key& key, font_metrics* fm);
 
 		void create_node(void* gnode, elements_vector& elements, bool parseTextNode);
-		bool update_media_lists(const media_features& features);
+		bool update_media_lists(const media_features& features, media_query_list::vector* changed = 0);
+		void restyle_media_elements(const media_query_list::vector& lists);
 		void fix_tables_layout();
 		void fix_table_children(element::ptr& el_ptr, style_display disp, const tchar_t* disp_str);
 		void fix_table_parent(element::ptr& el_ptr, style_display disp, const tchar_t* disp_str);
@@ -0,0 +1,201 @@
+#ifndef LH_DOCUMENT_STATS_H
+#define LH_DOCUMENT_STATS_H
+
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+#include "os_types.h"
+
+namespace litehtml
+{
+	enum stats_phase
+	{
+		stats_phase_parse,				// gumbo parser
+		stats_phase_create_elements,
+		stats_phase_cascade,			// style sheets parsed and applied to the elements
+		stats_phase_parse_styles,
+		stats_phase_init,
+		stats_phase_render,
+		stats_phase_draw,
+
+		stats_phase_count
+	};
+
+	// Time spent by a document in each phase and the counts of the costly operations.
+	// The counters only grow inside the phases of a document with the statistics enabled.
+	struct document_stats
+	{
+		double	phase_time[stats_phase_count];		// milliseconds
+		int		phase_count[stats_phase_count];
+		int		elements_created;
+		int		selectors_tested;					// by apply_stylesheet
+		int		selectors_matched;
+		int		style_property_calls;
+		int		text_width_calls;
+		int		render_calls;
+		int		second_pass_renders;
+		int		table_min_max_renders;				// cell renders measuring the table columns
+		int		draw_calls;							// drawing calls to the container
+
+		document_stats()
+		{
+			clear();
+		}
+
+		void clear()
+		{
+			memset(this, 0, sizeof(document_stats));
+		}
+	};
+
+	// Called at the end of every phase
+	typedef std::function<void(stats_phase phase, double ms)>	stats_callback;
+
+	class element;
+
+	typedef std::chrono::steady_clock	trace_clock;
+
+	// Span of a traced function, timed in microseconds from the start of the trace
+	struct trace_event
+	{
+		const char*	name;
+		const char*	category;
+		tstring		tag;
+		tstring		id;
+		double		ts;
+		double		dur;
+	};
+
+	// Nested spans of the phases and of the layout, style and paint functions of
+	// the elements. to_json() writes them in the Chrome trace event format, which
+	// can be loaded in chrome://tracing or in the Perfetto UI.
+	class document_trace
+	{
+		std::vector<trace_event>	m_events;
+		trace_clock::time_point		m_start;
+	public:
+		document_trace()
+		{
+			m_start = trace_clock::now();
+		}
+
+		const std::vector<trace_event>& events() const
+		{
+			return m_events;
+		}
+
+		void clear()
+		{
+			m_events.clear();
+			m_start = trace_clock::now();
+		}
+
+		void		add(const char* name, const char* category, const element* el, const trace_clock::time_point& start);
+		std::string	to_json() const;
+	};
+
+	const char* get_stats_phase_name(stats_phase phase);
+
+#ifndef LITEHTML_NO_STATS
+
+	// Statistics and trace of the phase running on this thread, if they are enabled
+	extern thread_local document_stats* g_current_stats;
+	extern thread_local document_trace* g_current_trace;
+
+	// Times a phase and makes it current for the counters and the trace spans
+	class stats_scope
+	{
+		document_stats*			m_stats;
+		document_stats*			m_outer;
+		document_trace*			m_trace;
+		document_trace*			m_outer_trace;
+		const stats_callback*	m_callback;
+		stats_phase				m_phase;
+		trace_clock::time_point	m_start;
+	public:
+		stats_scope(document_stats* stats, document_trace* trace, const stats_callback* callback, stats_phase phase)
+		{
+			m_stats = stats;
+			m_outer = g_current_stats;
+			m_trace = trace;
+			m_outer_trace = g_current_trace;
+			m_callback = callback;
+			m_phase = phase;
+			if (m_stats || m_trace)
+			{
+				g_current_stats = m_stats;
+				g_current_trace = m_trace;
+				m_start = trace_clock::now();
+			}
+		}
+
+		~stats_scope()
+		{
+			if (m_trace)
+			{
+				m_trace->add(get_stats_phase_name(m_phase), "phase", nullptr, m_start);
+			}
+			if (m_stats)
+			{
+				double ms = std::chrono::duration<double, std::milli>(trace_clock::now() - m_start).count();
+				m_stats->phase_time[m_phase] += ms;
+				m_stats->phase_count[m_phase]++;
+				if (m_callback && *m_callback)
+				{
+					(*m_callback)(m_phase, ms);
+				}
+			}
+			if (m_stats || m_trace)
+			{
+				g_current_stats = m_outer;
+				g_current_trace = m_outer_trace;
+			}
+		}
+	};
+
+	// Span of an element function, recorded when a trace is running
+	class trace_scope
+	{
+		document_trace*			m_trace;
+		const char*				m_name;
+		const char*				m_category;
+		const element*			m_element;
+		trace_clock::time_point	m_start;
+	public:
+		trace_scope(const char* name, const char* category, const element* el)
+		{
+			m_trace = g_current_trace;
+			m_name = name;
+			m_category = category;
+			m_element = el;
+			if (m_trace)
+			{
+				m_start = trace_clock::now();
+			}
+		}
+
+		~trace_scope()
+		{
+			if (m_trace)
+			{
+				m_trace->add(m_name, m_category, m_element, m_start);
+			}
+		}
+	};
+
+#define LITEHTML_STATS_PHASE(doc, phase)	litehtml::stats_scope stats_scope_##phase((doc)->active_stats(), (doc)->active_trace(), &(doc)->get_stats_callback(), litehtml::phase)
+#define LITEHTML_STATS_COUNT(counter)		{ if (litehtml::g_current_stats) litehtml::g_current_stats->counter++; }
+#define LITEHTML_TRACE_SCOPE(name, category)	litehtml::trace_scope trace_scope_(name, category, this)
+
+#else
+
+#define LITEHTML_STATS_PHASE(doc, phase)
+#define LITEHTML_STATS_COUNT(counter)
+#define LITEHTML_TRACE_SCOPE(name, category)
+
+#endif
+}
+
+#endif  // LH_DOCUMENT_STATS_H
@@ -9,6 +9,8 @@ namespace litehtml
 	class el_image : public html_tag
 	{
 		tstring	m_src;
+		size	m_image_size;
+		bool	m_image_ready;
 	public:
 		el_image(const std::shared_ptr<litehtml::document>& doc);
 		virtual ~el_image(void);
@@ -20,8 +22,13 @@ namespace litehtml
 		virtual void	parse_styles(bool is_reparse = false) override;
 		virtual void	draw(uint_ptr hdc, int x, int y, int z, const position* clip) override;
 		virtual void	get_content_size(size& sz, int max_width) override;
+		virtual void	add_memory_usage(document_memory_usage& usage) const override;
+
+		const tstring&	get_src() const { return m_src; }
+		bool			set_image_size(const size& sz);
 	private:
 		int calc_max_height(int image_height);
+		void get_image_size(size& sz);
 	};
 }
 
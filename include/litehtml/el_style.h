@@ -7,6 +7,8 @@ namespace litehtml
 {
 	class el_style : public element
 	{
+		friend class document;
+
 		elements_vector		m_children;
 	public:
 		el_style(const std::shared_ptr<litehtml::document>& doc);
@@ -15,6 +17,7 @@ namespace litehtml
 		virtual void			parse_attributes() override;
 		virtual bool			appendChild(const ptr &el) override;
 		virtual const tchar_t*	get_tagName() const override;
+		virtual void			add_memory_usage(document_memory_usage& usage) const override;
 	};
 }
 
@@ -20,6 +20,7 @@ namespace litehtml
 
 		virtual void				get_text(tstring& text) override;
 		virtual const tchar_t*		get_style_property(const tchar_t* name, bool inherited, const tchar_t* def = 0) override;
+		virtual const property_value*	get_style_value(const tchar_t* name, bool inherited) override;
 		virtual void				parse_styles(bool is_reparse) override;
 		virtual int					get_base_line() override;
 		virtual void				draw(uint_ptr hdc, int x, int y, int z, const position* clip) override;
@@ -29,6 +30,7 @@ namespace litehtml
 		virtual white_space			get_white_space() const override;
 		virtual element_position	get_element_position(css_offsets* offsets = 0) const override;
 		virtual css_offsets			get_css_offsets() const override;
+		virtual void				add_memory_usage(document_memory_usage& usage) const override;
 
 	protected:
 		virtual void				get_content_size(size& sz, int max_width) override;
@@ -18,6 +18,7 @@ namespace litehtml
 		friend class document;
 		friend class Document;
 		friend class Element;
+		friend class layout_snapshot;
 	public:
 		typedef std::shared_ptr<litehtml::element>			ptr;
 		typedef std::shared_ptr<const litehtml::element>	const_ptr;
@@ -32,6 +33,8 @@ namespace litehtml
 		margins						m_padding;
 		margins						m_borders;
 		bool						m_skip;
+		bool						m_deferred;
+		bool						m_layout_dirty;		// the element or one of its descendants must be laid out again
 
 		virtual void select_all(const css_selector& selector, elements_vector& res);
 	public:
@@ -87,6 +90,7 @@ namespace litehtml
 
 		bool						in_normal_flow()			const;
 		litehtml::web_color			get_color(const tchar_t* prop_name, bool inherited, const litehtml::web_color& def_color = litehtml::web_color());
+		void						get_length(css_length& len, const tchar_t* prop_name, bool inherited, const tchar_t* def, const tchar_t* predefs = _t(""));
 		bool						is_inline_box()				const;
 		position					get_placement()				const;
 		bool						collapse_top_margin()		const;
@@ -99,10 +103,12 @@ namespace litehtml
 		element::ptr				parent() const;
 		void						parent(element::ptr par);
 		bool						is_visible() const;
+		bool						is_deferred() const;
 		int							calc_width(int defVal) const;
 		int							get_inline_shift_left();
 		int							get_inline_shift_right();
 		void						apply_relative_shift(int parent_width);
+		void						clear_layout_dirty();
 
 		std::shared_ptr<document>	get_document() const;
 
@@ -148,6 +154,7 @@ namespace litehtml
 		virtual css_length			get_css_depth() const;
 
 		virtual void				set_attr(const tchar_t* name, const tchar_t* val);
+		virtual void				set_attrs(string_map&& attrs);
 		virtual const tchar_t*		get_attr(const tchar_t* name, const tchar_t* def = 0) const;
 		virtual void				apply_stylesheet(const litehtml::css& stylesheet);
 		virtual void				refresh_styles();
@@ -177,6 +184,7 @@ namespace litehtml
 		virtual void				draw(uint_ptr hdc, int x, int y, int z, const position* clip);
 		virtual void				draw_background(uint_ptr hdc, int x, int y, int z, const position* clip);
 		virtual const tchar_t*		get_style_property(const tchar_t* name, bool inherited, const tchar_t* def = 0);
+		virtual const property_value*	get_style_value(const tchar_t* name, bool inherited);
 		virtual uint_ptr			get_font(font_metrics* fm = 0);
 		virtual int					get_font_size() const;
 		virtual void				get_text(tstring& text);
@@ -217,6 +225,12 @@ namespace litehtml
 		virtual element::ptr		get_element_by_point(int x, int y, int z, int client_x, int client_y, int client_z);
 		virtual element::ptr		get_child_by_point(int x, int y, int z, int client_x, int client_y, int client_z, draw_flag flag, int zindex);
 		virtual const background*	get_background(bool own_only = false);
+		virtual int					realize_deferred(int top, int bottom);
+		virtual bool				has_out_of_flow();		// the element or one of its descendants is floating, absolute or fixed
+		virtual bool				has_positioned();		// the element or one of its descendants is positioned, relative included
+		virtual void				children_changed();		// called after children are inserted or removed
+		virtual int					relayout_dirty(int& top);
+		virtual void				add_memory_usage(document_memory_usage& usage) const;
 	};
 
 	//////////////////////////////////////////////////////////////////////////
@@ -392,6 +406,11 @@ namespace litehtml
 		return m_borders.back;
 	}
 
+	inline bool litehtml::element::is_deferred() const
+	{
+		return m_deferred;
+	}
+
 	inline bool litehtml::element::skip()
 	{
 		return m_skip;
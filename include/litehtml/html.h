@@ -12,6 +12,8 @@
 #include "os_types.h"
 #include "api.h"
 #include "types.h"
+#include "keywords.h"
+#include "memory_usage.h"
 #include "background.h"
 #include "borders.h"
 #include "html_tag.h"
@@ -41,6 +43,7 @@ namespace litehtml
 		virtual int					get_default_font_size() const = 0;
 		virtual const litehtml::tchar_t*	get_default_font_name() const = 0;
 		virtual void				draw_list_marker(litehtml::uint_ptr hdc, const litehtml::list_marker& marker) = 0;
+		// load_image() can return before the image is loaded, the loaded size of <img> images is then given with document::image_ready()
 		virtual void				load_image(const litehtml::tchar_t* src, const litehtml::tchar_t* baseurl, const litehtml::string_map* attrs, bool redraw_on_ready) = 0;
 		virtual void				get_image_size(const litehtml::tchar_t* src, const litehtml::tchar_t* baseurl, const litehtml::string_map* attrs, litehtml::size& sz) = 0;
 		virtual void				draw_background(litehtml::uint_ptr hdc, const litehtml::background_paint& bg) = 0;
@@ -68,7 +71,9 @@ namespace litehtml
 	void trim(tstring &s);
 	void lcase(tstring &s);
 	int	 value_index(const tstring& val, const tstring& strings, int defValue = -1, tchar_t delim = _t(';'));
+	int	 value_index(const tchar_t* val, const tchar_t* strings, int defValue = -1, tchar_t delim = _t(';'));
 	bool value_in_list(const tstring& val, const tstring& strings, tchar_t delim = _t(';'));
+	bool value_in_list(const tchar_t* val, const tchar_t* strings, tchar_t delim = _t(';'));
 	tstring::size_type find_close_bracket(const tstring &s, tstring::size_type off, tchar_t open_b = _t('('), tchar_t close_b = _t(')'));
 	void split_string(const tstring& str, string_vector& tokens, const tstring& delims, const tstring& delims_preserve = _t(""), const tstring& quote = _t("\""));
 	void join_string(tstring& str, const string_vector& tokens, const tstring& delims);
@@ -40,10 +40,20 @@ namespace litehtml
 		friend class table_grid;
 		friend class block_box;
 		friend class line_box;
+		friend class layout_snapshot;
+		friend class document;
 	public:
 		typedef std::shared_ptr<litehtml::html_tag>	ptr;
 	protected:
 		box::vector				m_boxes;
+		line_box_item::vector	m_inline_items;
+		bool					m_inline_items_valid;
+		bool					m_inline_run;			// the children are all inline text, m_inline_items holds them
+		unsigned int			m_inline_items_generation;	// m_children_generation when m_inline_items were made
+		unsigned int			m_children_generation;	// changed by children_changed()
+		bool					m_has_out_of_flow;		// the cached results of has_out_of_flow() and has_positioned()
+		bool					m_has_positioned;
+		bool					m_out_of_flow_valid;
 		string_vector			m_class_values;
 		tstring					m_tag;
 		litehtml::style			m_style;
@@ -102,6 +112,7 @@ namespace litehtml
 		int						m_border_spacing_y;
 		int						m_border_spacing_z;
 		border_collapse			m_border_collapse;
+		table_layout			m_table_layout;
 
 		virtual void			select_all(const css_selector& selector, elements_vector& res) override;
 
@@ -149,6 +160,7 @@ namespace litehtml
 		virtual overflow			get_overflow() const override;
 
 		virtual void				set_attr(const tchar_t* name, const tchar_t* val) override;
+		virtual void				set_attrs(string_map&& attrs) override;
 		virtual const tchar_t*		get_attr(const tchar_t* name, const tchar_t* def = 0) const override;
 		virtual void				apply_stylesheet(const litehtml::css& stylesheet) override;
 		virtual void				refresh_styles() override;
@@ -177,6 +189,7 @@ namespace litehtml
 		virtual void				draw_background(uint_ptr hdc, int x, int y, int z, const position* clip) override;
 
 		virtual const tchar_t*		get_style_property(const tchar_t* name, bool inherited, const tchar_t* def = 0) override;
+		virtual const property_value*	get_style_value(const tchar_t* name, bool inherited) override;
 		virtual uint_ptr			get_font(font_metrics* fm = 0) override;
 		virtual int					get_font_size() const override;
 
@@ -230,12 +243,23 @@ namespace litehtml
 		virtual bool				is_nth_last_child(const element::ptr& el, int num, int off, bool of_type) const override;
 		virtual bool				is_only_child(const element::ptr& el, bool of_type) const override;
 		virtual const background*	get_background(bool own_only = false) override;
+		virtual int					realize_deferred(int top, int bottom) override;
+		virtual bool				has_out_of_flow() override;
+		virtual bool				has_positioned() override;
+		virtual void				children_changed() override;
+		virtual int					relayout_dirty(int& top) override;
+		virtual void				add_memory_usage(document_memory_usage& usage) const override;
 
 	protected:
 		void						draw_children_box(uint_ptr hdc, int x, int y, int z, const position* clip, draw_flag flag, int zindex);
 		void						draw_children_table(uint_ptr hdc, int x, int y, int z, const position* clip, draw_flag flag, int zindex);
 		int							render_box(int x, int y, int z, int max_width, bool second_pass = false);
 		int							render_table(int x, int y, int z, int max_width, bool second_pass = false);
+		bool						render_deferred(const element::ptr& el, int top, int z, int max_width);
+		bool						update_inline_items();
+		void						update_out_of_flow();
+		void						invalidate_out_of_flow();
+		int							place_inline_item(const element::ptr& el, const line_box_item& item, int max_width);
 		int							fix_line_width(int max_width, element_float flt);
 		void						parse_background();
 		void						init_background_paint(position pos, background_paint &bg_paint, const background* bg);
@@ -0,0 +1,75 @@
+#ifndef LH_KEYWORDS_H
+#define LH_KEYWORDS_H
+
+#include <vector>
+#include "os_types.h"
+#include "types.h"
+
+namespace litehtml
+{
+	// Hash table over a keyword list like style_display_strings.
+	// find() returns the same index as value_index() without scanning the list.
+	class keyword_table
+	{
+		struct entry
+		{
+			const tchar_t*	name;	// points into the list, not null terminated
+			int				length;
+			int				index;
+		};
+		std::vector<entry>	m_entries;
+		unsigned int		m_mask;
+
+		int find(const tchar_t* val, int length, int defValue) const;
+	public:
+		keyword_table(const tchar_t* strings, tchar_t delim = _t(';'));
+
+		int find(const tchar_t* val, int defValue = -1) const
+		{
+			return val ? find(val, (int) t_strlen(val), defValue) : defValue;
+		}
+		int find(const tstring& val, int defValue = -1) const
+		{
+			return find(val.c_str(), (int) val.length(), defValue);
+		}
+		bool contains(const tchar_t* val) const
+		{
+			return find(val) >= 0;
+		}
+		bool contains(const tstring& val) const
+		{
+			return find(val) >= 0;
+		}
+	};
+
+	extern const keyword_table style_display_keywords;
+	extern const keyword_table font_style_keywords;
+	extern const keyword_table font_variant_keywords;
+	extern const keyword_table font_weight_keywords;
+	extern const keyword_table list_style_type_keywords;
+	extern const keyword_table list_style_position_keywords;
+	extern const keyword_table vertical_align_keywords;
+	extern const keyword_table border_width_keywords;
+	extern const keyword_table border_style_keywords;
+	extern const keyword_table element_float_keywords;
+	extern const keyword_table element_clear_keywords;
+	extern const keyword_table css_units_keywords;
+	extern const keyword_table background_attachment_keywords;
+	extern const keyword_table background_repeat_keywords;
+	extern const keyword_table background_box_keywords;
+	extern const keyword_table element_position_keywords;
+	extern const keyword_table text_align_keywords;
+	extern const keyword_table text_transform_keywords;
+	extern const keyword_table white_space_keywords;
+	extern const keyword_table overflow_keywords;
+	extern const keyword_table visibility_keywords;
+	extern const keyword_table border_collapse_keywords;
+	extern const keyword_table table_layout_keywords;
+	extern const keyword_table pseudo_class_keywords;
+	extern const keyword_table media_orientation_keywords;
+	extern const keyword_table media_feature_keywords;
+	extern const keyword_table box_sizing_keywords;
+	extern const keyword_table media_type_keywords;
+}
+
+#endif  // LH_KEYWORDS_H
@@ -0,0 +1,108 @@
+#ifndef LH_LAYOUT_SNAPSHOT_H
+#define LH_LAYOUT_SNAPSHOT_H
+
+#include <string>
+#include <vector>
+#include "os_types.h"
+#include "types.h"
+#include "binary_stream.h"
+
+namespace litehtml
+{
+	// Result of document::render(): the boxes of every element, the line boxes, the
+	// floats and the table grids, by element in document order.
+	//
+	// A snapshot taken for some HTML, style sheets and width can be applied to a
+	// document created from the same sources instead of rendering it (warm start).
+	// The caller keys the snapshots by the sources and the width, apply() only checks
+	// that the document has the same tree. save() stores the snapshot in a compact
+	// binary form, to_json() writes it one element per line to compare the layouts of
+	// two versions with a text diff.
+	class layout_snapshot
+	{
+	public:
+		struct item_layout
+		{
+			int				el;			// element index
+			int				width;
+			int				height;
+			int				shift_left;
+			int				shift_right;
+			bool			is_white_space;
+			bool			is_break;
+			bool			is_text;
+			vertical_align	va;
+			font_metrics	fm;
+			int				line_height;
+		};
+
+		struct box_layout
+		{
+			bool			is_line;
+			int				top;
+			int				left;
+			int				front;
+			int				right;
+			int				el;			// element of a block box, -1 if none
+			// line boxes
+			int				height;
+			int				width;
+			int				depth;
+			int				line_height;
+			int				baseline;
+			text_align		align;
+			font_metrics	fm;
+			std::vector<item_layout>	items;
+		};
+
+		struct float_layout
+		{
+			position		pos;
+			element_float	float_side;
+			element_clear	clear_floats;
+			int				el;
+		};
+
+		struct element_layout
+		{
+			position		pos;
+			margins			margin;
+			margins			padding;
+			margins			borders;
+			bool			skip;
+			int				box_owner;	// element holding the box of the element, -1 if none
+			int				box_index;
+			std::vector<box_layout>		boxes;
+			std::vector<float_layout>	floats_left;
+			std::vector<float_layout>	floats_right;
+			std::vector<int>			rows;		// top, bottom and height of the table rows
+			std::vector<int>			columns;	// left, right and width of the table columns
+		};
+
+	private:
+		std::vector<element_layout>	m_elements;
+		unsigned int				m_fingerprint;
+		int							m_render_width;
+		size						m_size;
+		position::vector			m_fixed_boxes;
+	public:
+		layout_snapshot();
+
+		bool		empty() const			{ return m_elements.empty(); }
+		int			render_width() const	{ return m_render_width; }
+		const std::vector<element_layout>&	elements() const { return m_elements; }
+		void		clear();
+
+		// Takes the layout of a rendered document, the deferred blocks of a lazy layout are laid out first
+		bool		capture(document& doc);
+		// Sets the layout of a document that is not rendered yet or was rendered at another width.
+		// Returns false without changing the document when its tree is not the one of the snapshot.
+		bool		apply(document& doc) const;
+
+		bool		save(byte_vector& data) const;
+		bool		load(const unsigned char* data, size_t size);
+		std::string	to_json() const;
+	};
+}
+
+#endif  // LH_LAYOUT_SNAPSHOT_H
@@ -46,30 +46,28 @@ namespace litehtml
 		typedef std::vector<media_query_list::ptr>	vector;
 	private:
 		media_query::vector	m_queries;
-		bool				m_is_used;
+		tstring				m_text;		// normalized source, equal for the lists that check the same
 	public:
 		media_query_list();
 		media_query_list(const media_query_list& val);
 
 		static media_query_list::ptr create_from_string(const tstring& str, const std::shared_ptr<document>& doc);
-		bool is_used() const;
-		bool apply_media_features(const media_features& features);	// returns true if the m_is_used changed
+		// media_query_list is immutable, whether it applies is kept by each document
+		bool check(const media_features& features) const;
+		const tstring& text() const
+		{
+			return m_text;
+		}
 	};
 
 	inline media_query_list::media_query_list(const media_query_list& val)
 	{
-		m_is_used = val.m_is_used;
 		m_queries = val.m_queries;
+		m_text = val.m_text;
 	}
 
 	inline media_query_list::media_query_list()
 	{
-		m_is_used = false;
-	}
-
-	inline bool media_query_list::is_used() const
-	{
-		return m_is_used;
 	}
 
 }
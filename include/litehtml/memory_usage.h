@@ -0,0 +1,85 @@
+#ifndef LH_MEMORY_USAGE_H
+#define LH_MEMORY_USAGE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include "os_types.h"
+
+namespace litehtml
+{
+	// Heap memory held by a document, in bytes. It is estimated by walking the
+	// document structures: the objects allocated by the document and the capacity
+	// of their containers are counted, the allocator overhead is not.
+	// Memory shared with other documents (the master stylesheet, shared fonts)
+	// and the fonts themselves, owned by the container, are left out. The
+	// declarations of style sheets taken from the stylesheet cache are counted
+	// in every document using them.
+	struct document_memory_usage
+	{
+		size_t	elements;		// element objects and the element tree
+		size_t	attributes;
+		size_t	styles;			// declarations of the elements, inline styles and style sheets, style sheet sources
+		size_t	selectors;		// selectors used by the elements and the document style sheets
+		size_t	boxes;			// layout boxes, line items, floats and table grids
+		size_t	text;
+		size_t	fonts;			// fonts map of the document
+
+		document_memory_usage()
+		{
+			elements = 0;
+			attributes = 0;
+			styles = 0;
+			selectors = 0;
+			boxes = 0;
+			text = 0;
+			fonts = 0;
+		}
+
+		size_t total() const
+		{
+			return elements + attributes + styles + selectors + boxes + text + fonts;
+		}
+	};
+
+	// Nodes of std::map: the value plus the color and three links
+	const size_t map_node_overhead = 4 * sizeof(void*);
+
+	// Strings short enough for the small string buffer don't allocate
+	inline size_t string_memory(const tstring& str)
+	{
+		if (str.capacity() * sizeof(tchar_t) < sizeof(tstring))
+		{
+			return 0;
+		}
+		return (str.capacity() + 1) * sizeof(tchar_t);
+	}
+
+	template<class T>
+	size_t vector_memory(const std::vector<T>& vec)
+	{
+		return vec.capacity() * sizeof(T);
+	}
+
+	inline size_t string_vector_memory(const std::vector<tstring>& vec)
+	{
+		size_t size = vector_memory(vec);
+		for (const auto& str : vec)
+		{
+			size += string_memory(str);
+		}
+		return size;
+	}
+
+	inline size_t string_map_memory(const std::map<tstring, tstring>& map)
+	{
+		size_t size = map.size() * (sizeof(std::pair<const tstring, tstring>) + map_node_overhead);
+		for (const auto& item : map)
+		{
+			size += string_memory(item.first) + string_memory(item.second);
+		}
+		return size;
+	}
+}
+
+#endif  // LH_MEMORY_USAGE_H
@@ -2,35 +2,61 @@
 #define LH_STYLE_H
 
 #include "attributes.h"
+#include "css_length.h"
+#include "web_color.h"
 #include <string>
 
 namespace litehtml
 {
+	enum property_type
+	{
+		property_type_string,
+		property_type_length,
+		property_type_color,
+	};
+
 	class property_value
 	{
 	public:
-		tstring	m_value;
+		tstring			m_value;
 		bool			m_important;
+		// Typed form of m_value, parsed once when the declaration is added
+		property_type	m_type;
+		css_length		m_length;
+		const tchar_t*	m_predefs;	// keywords m_length was parsed with
+		web_color		m_color;
 
 		property_value()
 		{
 			m_important = false;
+			m_type = property_type_string;
+			m_predefs = 0;
 		}
 		property_value(const tchar_t* val, bool imp)
 		{
 			m_important = imp;
 			m_value = val;
+			m_type = property_type_string;
+			m_predefs = 0;
 		}
 		property_value(const property_value& val)
 		{
 			m_value = val.m_value;
 			m_important = val.m_important;
+			m_type = val.m_type;
+			m_length = val.m_length;
+			m_predefs = val.m_predefs;
+			m_color = val.m_color;
 		}
 
 		property_value& operator=(const property_value& val)
 		{
 			m_value = val.m_value;
 			m_important = val.m_important;
+			m_type = val.m_type;
+			m_length = val.m_length;
+			m_predefs = val.m_predefs;
+			m_color = val.m_color;
 			return *this;
 		}
 	};
@@ -61,15 +87,30 @@ namespace litehtml
 		}
 
 		void add_property(const tchar_t* name, const tchar_t* val, const tchar_t* baseurl, bool important);
+		void add_parsed_property(const tstring& name, const tstring& val, bool important);
+		void parse_property(const tstring& txt, const tchar_t* baseurl);
+
+		const props_map& properties() const
+		{
+			return m_properties;
+		}
+
+		size_t memory_size() const;
 
 		const tchar_t* get_property(const tchar_t* name) const
+		{
+			const property_value* val = get_property_value(name);
+			return val ? val->m_value.c_str() : 0;
+		}
+
+		const property_value* get_property_value(const tchar_t* name) const
 		{
 			if (name)
 			{
 				props_map::const_iterator f = m_properties.find(name);
 				if (f != m_properties.end())
 				{
-					return f->second.m_value.c_str();
+					return &f->second;
 				}
 			}
 			return 0;
@@ -82,13 +123,15 @@ namespace litehtml
 		}
 
 	private:
-		void parse_property(const tstring& txt, const tchar_t* baseurl);
 		void parse(const tchar_t* txt, const tchar_t* baseurl);
-		void parse_short_border(const tstring& prefix, const tstring& val, bool important);
+		void parse_short_border(const tchar_t* const* longhands, int sides, const tstring& val, bool important);
+		void parse_short_xyz(const tchar_t* const* longhands, const tstring& val, const tchar_t* delims, bool important);
+		void parse_short_box(const tchar_t* const* longhands, const tstring& val, bool important);
+		void parse_short_list_style(const tchar_t* const* longhands, const tstring& val, const tchar_t* baseurl, bool important);
 		void parse_short_background(const tstring& val, const tchar_t* baseurl, bool important);
 		void parse_short_font(const tstring& val, bool important);
-		void add_parsed_property(const tstring& name, const tstring& val, bool important);
 		void remove_property(const tstring& name, bool important);
+		void set_property(const tstring& name, const property_value& val);
 	};
 }
 
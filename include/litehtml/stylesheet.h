@@ -3,6 +3,7 @@
 
 #include "style.h"
 #include "css_selector.h"
+#include "binary_stream.h"
 
 namespace litehtml
 {
@@ -34,10 +35,17 @@ namespace litehtml
 
 		void	parse_stylesheet(const tchar_t* str, const tchar_t* baseurl, const std::shared_ptr <document>& doc, const media_query_list::ptr& media);
 		void	sort_selectors();
+		void	add_selectors(const css& src);
+		bool	has_media_queries() const;
+		bool	save(byte_vector& data) const;
+		bool	load(const unsigned char* data, size_t size);
 		static void	parse_css_url(const tstring& str, tstring& url);
 
 	private:
-		void	parse_atrule(const tstring& text, const tchar_t* baseurl, const std::shared_ptr<document>& doc, const media_query_list::ptr& media);
+		void	parse_stylesheet(const tchar_t* begin, const tchar_t* end, const tchar_t* baseurl, const std::shared_ptr<document>& doc, const media_query_list::ptr& media);
+		void	parse_declarations(const tchar_t* begin, const tchar_t* end, const style::ptr& st, const tchar_t* baseurl);
+		const tchar_t*	parse_atrule(const tchar_t* begin, const tchar_t* end, const tchar_t* baseurl, const std::shared_ptr<document>& doc, const media_query_list::ptr& media);
+		void	parse_import(const tstring& text, const tchar_t* baseurl, const std::shared_ptr<document>& doc, const media_query_list::ptr& media);
 		void	add_selector(css_selector::ptr selector);
 		bool	parse_selectors(const tstring& txt, const litehtml::style::ptr& styles, const media_query_list::ptr& media);
 
@@ -76,6 +76,8 @@ namespace litehtml
 		int			max_width;
 		int			width;
 		css_length	css_width;
+		css_length	css_fixed_width;
+		bool		fixed_from_cell;
 		int			border_left;
 		int			border_right;
 		int			left;
@@ -91,6 +93,8 @@ namespace litehtml
 			max_width = 0;
 			width = 0;
 			css_width.predef(0);
+			css_fixed_width.predef(0);
+			fixed_from_cell = false;
 		}
 
 		table_column(int min_w, int max_w)
@@ -103,6 +107,8 @@ namespace litehtml
 			min_width = min_w;
 			width = 0;
 			css_width.predef(0);
+			css_fixed_width.predef(0);
+			fixed_from_cell = false;
 		}
 
 		table_column(const table_column& val)
@@ -115,6 +121,8 @@ namespace litehtml
 			min_width = val.min_width;
 			width = val.width;
 			css_width = val.css_width;
+			css_fixed_width = val.css_fixed_width;
+			fixed_from_cell = val.fixed_from_cell;
 		}
 	};
 
@@ -207,6 +215,7 @@ namespace litehtml
 		rows					m_cells;
 		table_column::vector	m_columns;
 		table_row::vector		m_rows;
+		std::vector<css_length>	m_css_col_widths;
 	public:
 
 		table_grid()
@@ -218,6 +227,7 @@ namespace litehtml
 		void			clear();
 		void			begin_row(element::ptr& row);
 		void			add_cell(element::ptr& el);
+		void			add_column(element::ptr& el);
 		bool			is_rowspanned(int r, int c);
 		void			finish();
 		table_cell*		cell(int t_col, int t_row);
@@ -232,9 +242,11 @@ namespace litehtml
 		void			distribute_width(int width, int start, int end);
 		void			distribute_width(int width, int start, int end, table_column_accessor* acc);
 		int				calc_table_width(int block_width, bool is_auto, int& min_table_width, int& max_table_width);
+		int				calc_fixed_table_width(int block_width);
 		void			calc_horizontal_positions(margins& table_borders, border_collapse bc, int bdr_space_x);
 		void			calc_vertical_positions(margins& table_borders, border_collapse bc, int bdr_space_y);
 		void			calc_rows_height(int blockHeight, int borderSpacingY);
+		size_t			memory_size() const;
 	};
 }
 
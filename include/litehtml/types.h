@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <memory>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 namespace litehtml
@@ -53,6 +54,13 @@ namespace litehtml
 		{
 			width = height = depth = 0;
 		}
+
+		size(int width, int height, int depth)
+		{
+			this->width = width;
+			this->height = height;
+			this->depth = depth;
+		}
 	};
 
 	struct position : Rect
@@ -145,15 +153,15 @@ namespace litehtml
 				right() >= val->left() &&
 				bottom() >= val->top() &&
 				top() <= val->bottom() &&
-				front() >= val->back() &&
-				back() <= val->front())
+				front() <= val->back() &&
+				back() >= val->front())
 				|| (
 					val->left() <= right() &&
 					val->right() >= left() &&
 					val->bottom() >= top() &&
 					val->top() <= bottom() &&
-					val->front() >= back() &&
-					val->back() <= front());
+					val->front() <= back() &&
+					val->back() >= front());
 		}
 
 		bool empty() const
@@ -203,8 +211,6 @@ namespace litehtml
 		font_metrics	metrics;
 	};
 
-	typedef std::map<tstring, font_item>	fonts_map;
-
 	enum draw_flag
 	{
 		draw_root,
@@ -270,6 +276,44 @@ namespace litehtml
 		fontStyleItalic
 	};
 
+	// Resolved font descriptor: the fonts are cached by it
+	struct font_key
+	{
+		tstring			family;
+		int				size;
+		int				weight;
+		font_style		style;
+		unsigned int	decoration;
+
+		font_key()
+		{
+			size = 0;
+			weight = 400;
+			style = fontStyleNormal;
+			decoration = font_decoration_none;
+		}
+
+		bool operator==(const font_key& val) const
+		{
+			return size == val.size && weight == val.weight && style == val.style && decoration == val.decoration && family == val.family;
+		}
+	};
+
+	struct font_key_hash
+	{
+		size_t operator()(const font_key& key) const
+		{
+			size_t h = std::hash<tstring>()(key.family);
+			h = h * 31 + (size_t) key.size;
+			h = h * 31 + (size_t) key.weight;
+			h = h * 31 + (size_t) key.style;
+			h = h * 31 + (size_t) key.decoration;
+			return h;
+		}
+	};
+
+	typedef std::unordered_map<font_key, font_item, font_key_hash>	fonts_map;
+
 #define  font_variant_strings		_t("normal;small-caps")
 
 	enum font_variant
@@ -517,6 +561,14 @@ namespace litehtml
 		border_collapse_separate,
 	};
 
+#define table_layout_strings		_t("auto;fixed")
+
+	enum table_layout
+	{
+		table_layout_auto,
+		table_layout_fixed,
+	};
+
 
 #define pseudo_class_strings		_t("only-child;only-of-type;first-child;first-of-type;last-child;last-of-type;nth-child;nth-of-type;nth-last-child;nth-last-of-type;not;lang")
 
@@ -53,6 +53,8 @@ namespace litehtml
 			return *this;
 		}
 		static web_color            from_string(const tchar_t* str, litehtml::document_container* callback);
+		// Parses the colors that don't need the container to be resolved
+		static bool                 parse(const tchar_t* str, web_color& clr);
 		static litehtml::tstring    resolve_name(const tchar_t* name, litehtml::document_container* callback);
 		static bool                 is_color(const tchar_t* str);
 	};
@@ -98,6 +98,11 @@ void litehtml::block_box::new_width(int left, int right, elements_vector& els)
 
 }
 
+size_t litehtml::block_box::memory_size() const
+{
+	return sizeof(block_box);
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 litehtml::box_type litehtml::line_box::get_type()
@@ -120,16 +125,45 @@ int litehtml::line_box::depth()
 	return m_depth;
 }
 
+litehtml::line_box_item::line_box_item(element* e)
+{
+	el = e;
+	width = el->width();
+	height = el->height();
+	shift_left = el->get_inline_shift_left();
+	shift_right = el->get_inline_shift_right();
+	is_white_space = el->is_white_space();
+	is_break = el->is_break();
+	is_text = el->get_display() == display_inline_text;
+	va = va_baseline;
+	line_height = 0;
+	if (is_text)
+	{
+		el->get_font(&fm);
+		line_height = el->line_height();
+	}
+	else
+	{
+		va = el->get_vertical_align();
+	}
+}
+
 void litehtml::line_box::add_element(const element::ptr &el)
 {
+	add_item(line_box_item(el.get()));
+}
+
+void litehtml::line_box::add_item(const line_box_item& item)
+{
+	element* el = item.el;
 	el->m_skip = false;
 	el->m_box = 0;
 	bool add = true;
-	if ((m_items.empty() && el->is_white_space()) || el->is_break())
+	if ((m_items.empty() && item.is_white_space) || item.is_break)
 	{
 		el->m_skip = true;
 	}
-	else if (el->is_white_space())
+	else if (item.is_white_space)
 	{
 		if (have_last_space())
 		{
@@ -141,18 +175,15 @@ void litehtml::line_box::add_element(const element::ptr &el)
 	if (add)
 	{
 		el->m_box = this;
-		m_items.push_back(el);
 
 		if (!el->m_skip)
 		{
-			int el_shift_left = el->get_inline_shift_left();
-			int el_shift_right = el->get_inline_shift_right();
-
-			el->m_pos.x = m_box_left + m_width + el_shift_left + el->content_margins_left();
+			el->m_pos.x = m_box_left + m_width + item.shift_left + el->content_margins_left();
 			el->m_pos.y = m_box_top + el->content_margins_top();
 			el->m_pos.z = m_box_front + el->content_margins_front();
-			m_width += el->width() + el_shift_left + el_shift_right;
+			m_width += item.full_width();
 		}
+		m_items.push_back(item);
 	}
 }
 
@@ -166,12 +197,12 @@ void litehtml::line_box::finish(bool last_box)
 
 	for (auto i = m_items.rbegin(); i != m_items.rend(); i++)
 	{
-		if ((*i)->is_white_space() || (*i)->is_break())
+		if (i->is_white_space || i->is_break)
 		{
-			if (!(*i)->m_skip)
+			if (!i->el->m_skip)
 			{
-				(*i)->m_skip = true;
-				m_width -= (*i)->width();
+				i->el->m_skip = true;
+				m_width -= i->width;
 			}
 		}
 		else
@@ -204,17 +235,15 @@ void litehtml::line_box::finish(bool last_box)
 
 	m_height = 0;
 	// find line box baseline and line-height
-	for (const auto& el : m_items)
+	for (auto& item : m_items)
 	{
-		if (el->get_display() == display_inline_text)
+		if (item.is_text)
 		{
-			font_metrics fm;
-			el->get_font(&fm);
-			base_line = std::max(base_line, fm.base_line());
-			line_height = std::max(line_height, el->line_height());
-			m_height = std::max(m_height, fm.height);
+			base_line = std::max(base_line, item.fm.base_line());
+			line_height = std::max(line_height, item.line_height);
+			m_height = std::max(m_height, item.fm.height);
 		}
-		el->m_pos.x += add_x;
+		item.el->m_pos.x += add_x;
 	}
 
 	if (m_height)
@@ -227,17 +256,16 @@ void litehtml::line_box::finish(bool last_box)
 	int y1 = 0;
 	int y2 = m_height;
 
-	for (const auto& el : m_items)
+	for (const auto& item : m_items)
 	{
-		if (el->get_display() == display_inline_text)
+		element* el = item.el;
+		if (item.is_text)
 		{
-			font_metrics fm;
-			el->get_font(&fm);
-			el->m_pos.y = m_height - base_line - fm.ascent;
+			el->m_pos.y = m_height - base_line - item.fm.ascent;
 		}
 		else
 		{
-			switch (el->get_vertical_align())
+			switch (item.va)
 			{
 			case va_super:
 			case va_sub:
@@ -267,13 +295,14 @@ void litehtml::line_box::finish(bool last_box)
 
 	//css_offsets offsets;
 
-	for (const auto& el : m_items)
+	for (const auto& item : m_items)
 	{
+		element* el = item.el;
 		el->m_pos.y -= y1;
 		el->m_pos.y += m_box_top;
-		if (el->get_display() != display_inline_text)
+		if (!item.is_text)
 		{
-			switch (el->get_vertical_align())
+			switch (item.va)
 			{
 			case va_top:
 				el->m_pos.y = m_box_top + el->content_margins_top();
@@ -330,12 +359,32 @@ bool litehtml::line_box::can_hold(const element::ptr &el, white_space ws)
 	return true;
 }
 
+bool litehtml::line_box::can_hold(const line_box_item& item, white_space ws)
+{
+	if (item.is_break)
+	{
+		return false;
+	}
+
+	if (ws == white_space_nowrap || ws == white_space_pre)
+	{
+		return true;
+	}
+
+	if (m_box_left + m_width + item.full_width() > m_box_right)
+	{
+		return false;
+	}
+
+	return true;
+}
+
 bool litehtml::line_box::have_last_space()
 {
 	bool ret = false;
 	for (auto i = m_items.rbegin(); i != m_items.rend() && !ret; i++)
 	{
-		if ((*i)->is_white_space() || (*i)->is_break())
+		if (i->is_white_space || i->is_break)
 		{
 			ret = true;
 		}
@@ -352,7 +401,7 @@ bool litehtml::line_box::is_empty()
 	if (m_items.empty()) return true;
 	for (auto i = m_items.rbegin(); i != m_items.rend(); i++)
 	{
-		if (!(*i)->m_skip || (*i)->is_break())
+		if (!i->el->m_skip || i->is_break)
 		{
 			return false;
 		}
@@ -367,7 +416,13 @@ int litehtml::line_box::baseline()
 
 void litehtml::line_box::get_elements(elements_vector& els)
 {
-	els.insert(els.begin(), m_items.begin(), m_items.end());
+	elements_vector items;
+	items.reserve(m_items.size());
+	for (const auto& item : m_items)
+	{
+		items.push_back(item.el->shared_from_this());
+	}
+	els.insert(els.begin(), items.begin(), items.end());
 }
 
 int litehtml::line_box::top_margin()
@@ -383,9 +438,9 @@ int litehtml::line_box::bottom_margin()
 void litehtml::line_box::y_shift(int shift)
 {
 	m_box_top += shift;
-	for (auto& el : m_items)
+	for (auto& item : m_items)
 	{
-		el->m_pos.y += shift;
+		item.el->m_pos.y += shift;
 	}
 }
 
@@ -393,11 +448,11 @@ bool litehtml::line_box::is_break_only()
 {
 	if (m_items.empty()) return true;
 
-	if (m_items.front()->is_break())
+	if (m_items.front().is_break)
 	{
-		for (auto& el : m_items)
+		for (auto& item : m_items)
 		{
-			if (!el->m_skip)
+			if (!item.el->m_skip)
 			{
 				return false;
 			}
@@ -418,32 +473,36 @@ void litehtml::line_box::new_width(int left, int right, elements_vector& els)
 		auto remove_begin = m_items.end();
 		for (auto i = m_items.begin() + 1; i != m_items.end(); i++)
 		{
-			element::ptr el = (*i);
-
-			if (!el->m_skip)
+			if (!i->el->m_skip)
 			{
-				if (m_box_left + m_width + el->width() + el->get_inline_shift_right() + el->get_inline_shift_left() > m_box_right)
+				if (m_box_left + m_width + i->full_width() > m_box_right)
 				{
 					remove_begin = i;
 					break;
 				}
 				else
 				{
-					el->m_pos.x += add;
-					m_width += el->width() + el->get_inline_shift_right() + el->get_inline_shift_left();
+					i->el->m_pos.x += add;
+					m_width += i->full_width();
 				}
 			}
 		}
 		if (remove_begin != m_items.end())
 		{
-			els.insert(els.begin(), remove_begin, m_items.end());
-			m_items.erase(remove_begin, m_items.end());
-
-			for (const auto& el : els)
+			elements_vector removed;
+			removed.reserve(m_items.end() - remove_begin);
+			for (auto i = remove_begin; i != m_items.end(); i++)
 			{
-				el->m_box = 0;
+				i->el->m_box = 0;
+				removed.push_back(i->el->shared_from_this());
 			}
+			els.insert(els.begin(), removed.begin(), removed.end());
+			m_items.erase(remove_begin, m_items.end());
 		}
 	}
 }
 
+size_t litehtml::line_box::memory_size() const
+{
+	return sizeof(line_box) + vector_memory(m_items);
+}
@@ -9,3 +9,177 @@ void litehtml::context::load_master_stylesheet(const tchar_t* str)
 	m_master_css.parse_stylesheet(str, 0, std::shared_ptr<litehtml::document>(), media_query_list::ptr());
 	m_master_css.sort_selectors();
 }
+
+bool litehtml::context::load_master_stylesheet(const unsigned char* data, size_t size)
+{
+	// the binary stylesheet is stored already sorted
+	return m_master_css.load(data, size);
+}
+
+litehtml::stylesheet_cache::key litehtml::stylesheet_cache::make_key(const tstring& text, const tstring& baseurl, const tstring& media)
+{
+	key k;
+	k.baseurl = baseurl;
+	k.media = media;
+	k.text = text;
+	k.hash = std::hash<tstring>()(text);
+	return k;
+}
+
+std::shared_ptr<const litehtml::css> litehtml::stylesheet_cache::find(const tstring& text, const tstring& baseurl, const tstring& media)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	std::map<key, entry>::iterator i = m_entries.find(make_key(text, baseurl, media));
+	if (i == m_entries.end())
+	{
+		m_stats.misses++;
+		return nullptr;
+	}
+	m_stats.hits++;
+	m_lru.splice(m_lru.begin(), m_lru, i->second.lru);
+	return i->second.sheet;
+}
+
+void litehtml::stylesheet_cache::add(const tstring& text, const tstring& baseurl, const tstring& media, const std::shared_ptr<const css>& sheet)
+{
+	size_t size = text.length() * sizeof(tchar_t);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (!sheet || size > m_max_size)
+	{
+		return;
+	}
+
+	key k = make_key(text, baseurl, media);
+	if (m_entries.find(k) != m_entries.end())
+	{
+		return;
+	}
+	evict(m_max_size - size);
+
+	std::map<key, entry>::iterator i = m_entries.insert(std::make_pair(std::move(k), entry())).first;
+	m_lru.push_front(&i->first);
+	i->second.sheet = sheet;
+	i->second.size = size;
+	i->second.lru = m_lru.begin();
+
+	m_stats.entries++;
+	m_stats.size += size;
+}
+
+void litehtml::stylesheet_cache::set_max_size(size_t max_size)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_max_size = max_size;
+	evict(max_size);
+}
+
+void litehtml::stylesheet_cache::clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_entries.clear();
+	m_lru.clear();
+	m_stats.entries = 0;
+	m_stats.size = 0;
+}
+
+litehtml::stylesheet_cache_stats litehtml::stylesheet_cache::stats() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+void litehtml::stylesheet_cache::evict(size_t max_size)
+{
+	while (m_stats.size > max_size && !m_lru.empty())
+	{
+		std::map<key, entry>::iterator i = m_entries.find(*m_lru.back());
+		m_stats.size -= i->second.size;
+		m_stats.entries--;
+		m_stats.evictions++;
+		m_entries.erase(i);
+		m_lru.pop_back();
+	}
+}
+
+litehtml::font_cache::registration litehtml::font_cache::share_fonts(document_container* container)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_fonts[container];
+	return registration(this, container);
+}
+
+bool litehtml::font_cache::is_shared(document_container* container) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return m_fonts.find(container) != m_fonts.end();
+}
+
+litehtml::font_item litehtml::font_cache::get_font(document_container* container, const font_key& key)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto fonts = m_fonts.find(container);
+	if (fonts != m_fonts.end())
+	{
+		fonts_map::iterator f = fonts->second.find(key);
+		if (f != fonts->second.end())
+		{
+			return f->second;
+		}
+	}
+
+	font_item fi = { 0 };
+	fi.font = container->create_font(key.family.c_str(), key.size, key.weight, key.style, key.decoration, &fi.metrics);
+	// a font of a container that is not registered is not kept: nothing would delete it with the container
+	if (fonts != m_fonts.end())
+	{
+		fonts->second[key] = fi;
+	}
+	return fi;
+}
+
+void litehtml::font_cache::release_fonts(document_container* container)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto fonts = m_fonts.find(container);
+	if (fonts != m_fonts.end())
+	{
+		for (const auto& f : fonts->second)
+		{
+			container->delete_font(f.second.font);
+		}
+		m_fonts.erase(fonts);
+	}
+}
+
+void litehtml::font_cache::clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (const auto& fonts : m_fonts)
+	{
+		for (const auto& f : fonts.second)
+		{
+			fonts.first->delete_font(f.second.font);
+		}
+	}
+	m_fonts.clear();
+}
+
+int litehtml::font_cache::count() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	int count = 0;
+	for (const auto& fonts : m_fonts)
+	{
+		count += (int) fonts.second.size();
+	}
+	return count;
+}
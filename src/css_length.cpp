@@ -2,16 +2,21 @@
 #include "css_length.h"
 
 void litehtml::css_length::fromString(const tstring& str, const tstring& predefs, int defValue)
+{
+	fromString(str.c_str(), predefs.c_str(), defValue);
+}
+
+void litehtml::css_length::fromString(const tchar_t* str, const tchar_t* predefs, int defValue)
 {
 	// TODO: Make support for calc
-	if (str.substr(0, 4) == _t("calc"))
+	if (!t_strncmp(str, _t("calc"), 4))
 	{
 		m_is_predefined = true;
 		m_predef = 0;
 		return;
 	}
 
-	int predef = value_index(str.c_str(), predefs.c_str(), -1);
+	int predef = value_index(str, predefs, -1);
 	if (predef >= 0)
 	{
 		m_is_predefined = true;
@@ -21,31 +26,20 @@ void litehtml::css_length::fromString(const tstring& str, const tstring& predefs
 	{
 		m_is_predefined = false;
 
-		tstring num;
-		tstring un;
-		bool is_unit = false;
-		for (tstring::const_iterator chr = str.begin(); chr != str.end(); chr++)
+		// the number is followed by the units
+		const tchar_t* un = str;
+		while (t_isdigit(*un) || *un == _t('.') || *un == _t('+') || *un == _t('-'))
 		{
-			if (!is_unit)
-			{
-				if (t_isdigit(*chr) || *chr == _t('.') || *chr == _t('+') || *chr == _t('-'))
-				{
-					num += *chr;
-				}
-				else
-				{
-					is_unit = true;
-				}
-			}
-			if (is_unit)
-			{
-				un += *chr;
-			}
+			un++;
 		}
-		if (!num.empty())
+		if (un != str)
 		{
-			m_value = (float)t_strtod(num.c_str(), 0);
-			m_units = (css_units)value_index(un.c_str(), css_units_strings, css_units_none);
+			tchar_t num[32];
+			size_t len = std::min((size_t) (un - str), sizeof(num) / sizeof(num[0]) - 1);
+			memcpy(num, str, len * sizeof(tchar_t));
+			num[len] = 0;
+			m_value = (float)t_strtod(num, 0);
+			m_units = (css_units)css_units_keywords.find(un, css_units_none);
 		}
 		else
 		{
@@ -277,6 +277,15 @@ void litehtml::css_selector::calc_specificity()
 	}
 }
 
+bool litehtml::css_selector::is_media_valid(const document* doc) const
+{
+	if (!m_media_query)
+	{
+		return true;
+	}
+	return doc && doc->is_media_used(m_media_query);
+}
+
 void litehtml::css_selector::add_media_to_doc(document* doc) const
 {
 	if (m_media_query && doc)
@@ -23,20 +23,90 @@
 #include "el_tr.h"
 #include <math.h>
 #include <stdio.h>
+#include <set>
 #include <algorithm>
+#include <climits>
 #include "gumbo.h"
 #include "utf8_strings.h"
 
+namespace
+{
+	// Decodes the utf-8 character at str, len is set to its size in bytes. Invalid bytes are taken one by one.
+	litehtml::ucode_t utf8_char(const char* str, size_t& len)
+	{
+		const unsigned char* s = (const unsigned char*)str;
+		len = 1;
+		if (s[0] < 0x80) return s[0];
+		size_t n = 0;
+		litehtml::ucode_t c = 0;
+		if ((s[0] & 0xE0) == 0xC0)
+		{
+			n = 2;
+			c = s[0] & 0x1F;
+		}
+		else if ((s[0] & 0xF0) == 0xE0)
+		{
+			n = 3;
+			c = s[0] & 0x0F;
+		}
+		else if ((s[0] & 0xF8) == 0xF0)
+		{
+			n = 4;
+			c = s[0] & 0x07;
+		}
+		else
+		{
+			return s[0];
+		}
+		for (size_t i = 1; i < n; i++)
+		{
+			if ((s[i] & 0xC0) != 0x80) return s[0];
+			c = (c << 6) | (s[i] & 0x3F);
+		}
+		len = n;
+		return c;
+	}
+
+	litehtml::tstring utf8_piece(const char* str, size_t len)
+	{
+#ifdef LITEHTML_UTF8
+		return litehtml::tstring(str, len);
+#else
+		return litehtml::tstring(litehtml::utf8_to_wchar(std::string(str, len).c_str()));
+#endif
+	}
+
+	// The strings of the gumbo tree are freed as soon as the elements have their copy, so the
+	// gumbo tree and the elements do not hold the text of a large document at the same time.
+	// gumbo_destroy_output frees the null pointers left behind, which is a no-op.
+	void release_gumbo_text(const char*& text)
+	{
+		kGumboDefaultOptions.deallocator(kGumboDefaultOptions.userdata, (void*)text);
+		text = nullptr;
+	}
+}
+
 litehtml::document::document(litehtml::document_container* objContainer, litehtml::context* ctx) : Document()
 {
 	m_container = objContainer;
 	m_context = ctx;
+	m_lazy_layout = false;
+	m_shared_fonts = ctx && ctx->fonts().enabled() && ctx->fonts().is_shared(objContainer);
+	m_stats_enabled = ctx && ctx->stats_enabled();
+	m_trace_enabled = ctx && ctx->trace_enabled();
+	if (ctx)
+	{
+		m_stats_callback = ctx->get_stats_callback();
+	}
+	m_layout_samples = 0;
+	m_layout_samples_height = 0;
+	m_render_width = -1;
 }
 
 litehtml::document::~document()
 {
 	m_over_element = 0;
-	if (m_container)
+	if (m_container && !m_shared_fonts)
 	{
 		for (fonts_map::iterator f = m_fonts.begin(); f != m_fonts.end(); f++)
 		{
@@ -52,172 +122,226 @@ litehtml::document::ptr litehtml::document::createFromString(const tchar_t* str,
 
 litehtml::document::ptr litehtml::document::createFromUTF8(const char* str, litehtml::document_container* objPainter, litehtml::context* ctx, litehtml::css* user_styles)
 {
-	// parse document into GumboOutput
-	GumboOutput* output = gumbo_parse((const char*)str);
+	return createFromUTF8(str, strlen(str), objPainter, ctx, user_styles);
+}
 
+litehtml::document::ptr litehtml::document::createFromUTF8(const char* str, size_t length, litehtml::document_container* objPainter, litehtml::context* ctx, litehtml::css* user_styles)
+{
 	// Create litehtml::document
 	litehtml::document::ptr doc = std::make_shared<litehtml::document>(objPainter, ctx);
 
+	// parse document into GumboOutput
+	GumboOutput* output;
+	{
+		LITEHTML_STATS_PHASE(doc, stats_phase_parse);
+		output = gumbo_parse_with_options(&kGumboDefaultOptions, str, length);
+	}
+
 	// Create litehtml::elements.
-	elements_vector root_elements;
-	doc->create_node(output->root, root_elements, true);
-	if (!root_elements.empty())
 	{
-		doc->m_root = root_elements.back();
+		LITEHTML_STATS_PHASE(doc, stats_phase_create_elements);
+		elements_vector root_elements;
+		doc->create_node(output->root, root_elements, true);
+		if (!root_elements.empty())
+		{
+			doc->m_root = root_elements.back();
+		}
+		// Destroy GumboOutput
+		gumbo_destroy_output(&kGumboDefaultOptions, output);
 	}
-	// Destroy GumboOutput
-	gumbo_destroy_output(&kGumboDefaultOptions, output);
 
 	// Let's process created elements tree
 	if (doc->m_root)
 	{
-		doc->container()->get_media_features(doc->m_media);
-
-		// apply master CSS
-		doc->m_root->apply_stylesheet(ctx->master_css());
-
-		// parse elements attributes
-		doc->m_root->parse_attributes();
-
-		// parse style sheets linked in document
-		media_query_list::ptr media;
-		for (css_text::vector::iterator css = doc->m_css.begin(); css != doc->m_css.end(); css++)
 		{
-			if (!css->media.empty())
+			LITEHTML_STATS_PHASE(doc, stats_phase_cascade);
+			doc->container()->get_media_features(doc->m_media);
+
+			// the media queries of the shared style sheets are evaluated by each document
+			for (const auto& sel : ctx->master_css().selectors())
 			{
-				media = media_query_list::create_from_string(css->media, doc);
+				sel->add_media_to_doc(doc.get());
 			}
-			else
+			if (user_styles)
 			{
-				media = 0;
+				for (const auto& sel : user_styles->selectors())
+				{
+					sel->add_media_to_doc(doc.get());
+				}
 			}
-			doc->m_styles.parse_stylesheet(css->text.c_str(), css->baseurl.c_str(), doc, media);
-		}
-		// Sort css selectors using CSS rules.
-		doc->m_styles.sort_selectors();
-
-		// get current media features
-		if (!doc->m_media_lists.empty())
-		{
 			doc->update_media_lists(doc->m_media);
-		}
 
-		// Apply parsed styles.
-		doc->m_root->apply_stylesheet(doc->m_styles);
+			// apply master CSS
+			doc->m_root->apply_stylesheet(ctx->master_css());
 
-		// Apply user styles if any
-		if (user_styles)
-		{
-			doc->m_root->apply_stylesheet(*user_styles);
-		}
+			// parse elements attributes
+			doc->m_root->parse_attributes();
 
-		// Parse applied styles in the elements
-		doc->m_root->parse_styles();
+			// parse style sheets linked in document
+			doc->parse_stylesheets();
 
-		// Now the m_tabular_elements is filled with tabular elements.
-		// We have to check the tabular elements for missing table elements 
-		// and create the anonymous boxes in visual table layout
-		doc->fix_tables_layout();
+			// get current media features
+			if (!doc->m_media_lists.empty())
+			{
+				doc->update_media_lists(doc->m_media);
+			}
 
-		// Fanaly initialize elements
-		doc->m_root->init();
+			// Apply parsed styles.
+			doc->m_root->apply_stylesheet(doc->m_styles);
+
+			// Apply user styles if any
+			if (user_styles)
+			{
+				doc->m_root->apply_stylesheet(*user_styles);
+			}
+		}
+
+		doc->init_elements();
 	}
 
 	return doc;
 }
 
-litehtml::uint_ptr litehtml::document::add_font(const tchar_t* name, int size, const tchar_t* weight, const tchar_t* style, const tchar_t* decoration, font_metrics* fm)
+void litehtml::document::parse_stylesheets()
 {
-	uint_ptr ret = 0;
-
-	if (!name || (name && !t_strcasecmp(name, _t("inherit"))))
+	media_query_list::ptr media;
+	for (css_text::vector::iterator css = m_css.begin(); css != m_css.end(); css++)
 	{
-		name = m_container->get_default_font_name();
+		// style sheets with media queries depend on the document and are not shared
+		stylesheet_cache* cache = css->media.empty() ? &m_context->stylesheets() : nullptr;
+		if (cache)
+		{
+			std::shared_ptr<const litehtml::css> sheet = cache->find(css->text, css->baseurl, css->media);
+			if (sheet)
+			{
+				m_styles.add_selectors(*sheet);
+				continue;
+			}
+		}
+
+		if (!css->media.empty())
+		{
+			media = media_query_list::create_from_string(css->media, shared_from_this());
+		}
+		else
+		{
+			media = 0;
+		}
+		std::shared_ptr<litehtml::css> sheet = std::make_shared<litehtml::css>();
+		sheet->parse_stylesheet(css->text.c_str(), css->baseurl.c_str(), shared_from_this(), media);
+		m_styles.add_selectors(*sheet);
+
+		if (cache && !sheet->has_media_queries())
+		{
+			cache->add(css->text, css->baseurl, css->media, sheet);
+		}
 	}
+	// Sort css selectors using CSS rules.
+	m_styles.sort_selectors();
+}
 
-	if (!size)
+void litehtml::document::init_elements()
+{
+	// Parse applied styles in the elements
 	{
-		size = container()->get_default_font_size();
+		LITEHTML_STATS_PHASE(this, stats_phase_parse_styles);
+		m_root->parse_styles();
 	}
 
-	tchar_t strSize[20];
-	t_itoa(size, strSize, 20, 10);
+	LITEHTML_STATS_PHASE(this, stats_phase_init);
 
-	tstring key = name;
-	key += _t(":");
-	key += strSize;
-	key += _t(":");
-	key += weight;
-	key += _t(":");
-	key += style;
-	key += _t(":");
-	key += decoration;
+	// Now the m_tabular_elements is filled with tabular elements.
+	// We have to check the tabular elements for missing table elements 
+	// and create the anonymous boxes in visual table layout
+	fix_tables_layout();
 
-	if (m_fonts.find(key) == m_fonts.end())
+	// Fanaly initialize elements
+	m_root->init();
+}
+
+namespace
+{
+	int font_weight_value(const litehtml::tchar_t* weight)
 	{
-		font_style fs = (font_style)value_index(style, font_style_strings, fontStyleNormal);
-		int	fw = value_index(weight, font_weight_strings, -1);
+		int	fw = litehtml::font_weight_keywords.find(weight);
 		if (fw >= 0)
 		{
 			switch (fw)
 			{
 			case litehtml::fontWeightBold:
-				fw = 700;
-				break;
+				return 700;
 			case litehtml::fontWeightBolder:
-				fw = 600;
-				break;
+				return 600;
 			case litehtml::fontWeightLighter:
-				fw = 300;
-				break;
+				return 300;
+			case litehtml::fontWeightNormal:
+				return 400;
 			default:
-				fw = 400;
-				break;
+				return (fw - litehtml::fontWeight100 + 1) * 100;
 			}
 		}
-		else
+		fw = t_atoi(weight);
+		if (fw < 100)
 		{
-			fw = t_atoi(weight);
-			if (fw < 100)
-			{
-				fw = 400;
-			}
+			fw = 400;
 		}
+		return fw;
+	}
 
-		unsigned int decor = 0;
-
-		if (decoration)
+	unsigned int font_decoration_value(const litehtml::tchar_t* decoration)
+	{
+		unsigned int decor = litehtml::font_decoration_none;
+		if (!decoration)
 		{
-			std::vector<tstring> tokens;
-			split_string(decoration, tokens, _t(" "));
-			for (std::vector<tstring>::iterator i = tokens.begin(); i != tokens.end(); i++)
+			return decor;
+		}
+		const litehtml::tchar_t* pos = decoration;
+		while (*pos)
+		{
+			while (*pos == _t(' '))
 			{
-				if (!t_strcasecmp(i->c_str(), _t("underline")))
-				{
-					decor |= font_decoration_underline;
-				}
-				else if (!t_strcasecmp(i->c_str(), _t("line-through")))
-				{
-					decor |= font_decoration_linethrough;
-				}
-				else if (!t_strcasecmp(i->c_str(), _t("overline")))
-				{
-					decor |= font_decoration_overline;
-				}
+				pos++;
+			}
+			const litehtml::tchar_t* start = pos;
+			while (*pos && *pos != _t(' '))
+			{
+				pos++;
+			}
+			size_t len = pos - start;
+			if (len == 9 && !t_strncasecmp(start, _t("underline"), 9))
+			{
+				decor |= litehtml::font_decoration_underline;
+			}
+			else if (len == 12 && !t_strncasecmp(start, _t("line-through"), 12))
+			{
+				decor |= litehtml::font_decoration_linethrough;
+			}
+			else if (len == 8 && !t_strncasecmp(start, _t("overline"), 8))
+			{
+				decor |= litehtml::font_decoration_overline;
 			}
 		}
+		return decor;
+	}
+}
 
-		font_item fi = { 0 };
-
-		fi.font = m_container->create_font(name, size, fw, fs, decor, &fi.metrics);
-		m_fonts[key] = fi;
-		ret = fi.font;
-		if (fm)
-		{
-			*fm = fi.metrics;
-		}
+litehtml::uint_ptr litehtml::document::add_font(const font_key& key, font_metrics* fm)
+{
+	font_item fi = { 0 };
+	if (m_shared_fonts)
+	{
+		fi = m_context->fonts().get_font(m_container, key);
 	}
-	return ret;
+	else
+	{
+		fi.font = m_container->create_font(key.family.c_str(), key.size, key.weight, key.style, key.decoration, &fi.metrics);
+	}
+	m_fonts[key] = fi;
+	if (fm)
+	{
+		*fm = fi.metrics;
+	}
+	return fi.font;
 }
 
 litehtml::uint_ptr litehtml::document::get_font(const tchar_t* name, int size, const tchar_t* weight, const tchar_t* style, const tchar_t* decoration, font_metrics* fm)
@@ -232,20 +356,14 @@ litehtml::uint_ptr litehtml::document::get_font(const tchar_t* name, int size, c
 		size = m_container->get_default_font_size();
 	}
 
-	tchar_t strSize[20];
-	t_itoa(size, strSize, 20, 10);
-
-	tstring key = name;
-	key += _t(":");
-	key += strSize;
-	key += _t(":");
-	key += weight;
-	key += _t(":");
-	key += style;
-	key += _t(":");
-	key += decoration;
+	// the lookup key is reused to keep the family name buffer
+	m_font_key.family = name;
+	m_font_key.size = size;
+	m_font_key.weight = font_weight_value(weight);
+	m_font_key.style = (font_style)font_style_keywords.find(style, fontStyleNormal);
+	m_font_key.decoration = font_decoration_value(decoration);
 
-	fonts_map::iterator el = m_fonts.find(key);
+	fonts_map::iterator el = m_fonts.find(m_font_key);
 
 	if (el != m_fonts.end())
 	{
@@ -255,12 +373,90 @@ litehtml::uint_ptr litehtml::document::get_font(const tchar_t* name, int size, c
 		}
 		return el->second.font;
 	}
-	return add_font(name, size, weight, style, decoration, fm);
+	return add_font(m_font_key, fm);
 }
 
 int litehtml::document::render(int max_width, render_type rt)
 {
+	m_lazy_layout = false;
+	return render_root(max_width, rt);
+}
+
+int litehtml::document::render(int max_width, const position& viewport, render_type rt)
+{
+	// Lazy layout: the top-level blocks out of the viewport (plus one viewport height above and below)
+	// get the estimated height and are laid out when draw() or hit testing reaches them. The blocks
+	// holding floats or positioned elements are always laid out.
+	m_lazy_layout = true;
+	m_layout_viewport = viewport;
+	m_layout_viewport.y -= viewport.height;
+	m_layout_viewport.height *= 3;
+	return render_root(max_width, rt);
+}
+
+bool litehtml::document::realize_layout(const position& region)
+{
+	if (!m_root || !m_lazy_layout)
+	{
+		return false;
+	}
+
+	int shift = 0;
+	for (auto& el : m_root->m_children)
+	{
+		if (shift)
+		{
+			el->m_pos.y += shift;
+		}
+		position placement = el->get_placement();
+		shift += el->realize_deferred(region.top() - placement.y, region.bottom() - placement.y);
+	}
+	if (shift)
+	{
+		// the floats registered with <html> or <body> and the absolute or fixed elements are not moved
+		// with the boxes, such documents are laid out again completely and stop being lazy
+		if (m_root->has_out_of_flow())
+		{
+			m_lazy_layout = false;
+			render_root(m_render_width, render_all);
+			return true;
+		}
+		m_root->m_pos.height += shift;
+		m_size.width = 0;
+		m_size.height = 0;
+		m_size.depth = 0;
+		m_root->calc_document_size(m_size);
+		return true;
+	}
+	return false;
+}
+
+bool litehtml::document::is_layout_deferred(int top, int bottom) const
+{
+	return m_lazy_layout && (bottom <= m_layout_viewport.top() || top >= m_layout_viewport.bottom());
+}
+
+void litehtml::document::add_layout_sample(int height)
+{
+	m_layout_samples++;
+	m_layout_samples_height += height;
+}
+
+int litehtml::document::get_estimated_height(int def_height) const
+{
+	if (m_layout_samples)
+	{
+		return m_layout_samples_height / m_layout_samples;
+	}
+	return def_height;
+}
+
+int litehtml::document::render_root(int max_width, render_type rt)
+{
+	LITEHTML_STATS_PHASE(this, stats_phase_render);
 	int ret = 0;
+	m_layout_samples = 0;
+	m_layout_samples_height = 0;
 	if (m_root)
 	{
 		if (rt == render_fixed_only)
@@ -270,6 +466,8 @@ int litehtml::document::render(int max_width, render_type rt)
 		}
 		else
 		{
+			m_render_width = max_width;
+			m_root->clear_layout_dirty();
 			ret = m_root->render(0, 0, 0, max_width);
 			if (m_root->fetch_positioned())
 			{
@@ -287,8 +485,21 @@ int litehtml::document::render(int max_width, render_type rt)
 
 void litehtml::document::draw(uint_ptr hdc, int x, int y, int z, const position* clip)
 {
+	LITEHTML_STATS_PHASE(this, stats_phase_draw);
 	if (m_root)
 	{
+		if (m_lazy_layout)
+		{
+			position region(0, 0, 0, m_size.width, INT_MAX / 2, m_size.depth);
+			if (clip)
+			{
+				region = *clip;
+				region.x -= x;
+				region.y -= y;
+				region.z -= z;
+			}
+			realize_layout(region);
+		}
 		m_root->draw(hdc, x, y, z, clip);
 		m_root->draw_stacking_context(hdc, x, y, z, clip, true);
 	}
@@ -496,6 +707,7 @@ bool litehtml::document::on_lbutton_up(int x, int y, int z, int client_x, int cl
 	{
 		return false;
 	}
+	realize_layout(position(x, y, z, 1, 1, 1));
 	if (m_over_element)
 	{
 		if (m_over_element->on_lbutton_up())
@@ -508,6 +720,13 @@ bool litehtml::document::on_lbutton_up(int x, int y, int z, int client_x, int cl
 
 litehtml::element::ptr litehtml::document::create_element(const tchar_t* tag_name, const string_map& attributes)
 {
+	string_map attrs(attributes);
+	return create_element(tag_name, std::move(attrs));
+}
+
+litehtml::element::ptr litehtml::document::create_element(const tchar_t* tag_name, string_map&& attributes)
+{
+	LITEHTML_STATS_COUNT(elements_created);
 	element::ptr newTag;
 	document::ptr this_doc = shared_from_this();
 	if (m_container)
@@ -585,10 +804,7 @@ litehtml::element::ptr litehtml::document::create_element(const tchar_t* tag_nam
 	if (newTag)
 	{
 		newTag->set_tagName(tag_name);
-		for (string_map::const_iterator iter = attributes.begin(); iter != attributes.end(); iter++)
-		{
-			newTag->set_attr(iter->first.c_str(), iter->second.c_str());
-		}
+		newTag->set_attrs(std::move(attributes));
 	}
 
 	return newTag;
@@ -609,10 +825,10 @@ bool litehtml::document::media_changed()
 	if (!m_media_lists.empty())
 	{
 		container()->get_media_features(m_media);
-		if (update_media_lists(m_media))
+		media_query_list::vector changed;
+		if (update_media_lists(m_media, &changed))
 		{
-			m_root->refresh_styles();
-			m_root->parse_styles();
+			restyle_media_elements(changed);
 			return true;
 		}
 	}
@@ -640,28 +856,298 @@ bool litehtml::document::lang_changed()
 	return false;
 }
 
-bool litehtml::document::update_media_lists(const media_features& features)
+bool litehtml::document::update_media_lists(const media_features& features, media_query_list::vector* changed)
 {
 	bool update_styles = false;
-	for (media_query_list::vector::iterator iter = m_media_lists.begin(); iter != m_media_lists.end(); iter++)
+	// the same query is usually repeated by many @media rules, check it once
+	std::map<tstring, bool> results;
+	for (auto& list : m_media_lists)
 	{
-		if ((*iter)->apply_media_features(features))
+		auto res = results.insert(std::make_pair(list.first->text(), false));
+		if (res.second)
 		{
+			res.first->second = list.first->check(features);
+		}
+		bool apply = res.first->second;
+		if (apply != list.second)
+		{
+			list.second = apply;
 			update_styles = true;
+			if (changed)
+			{
+				changed->push_back(list.first);
+			}
 		}
 	}
 	return update_styles;
 }
 
+void litehtml::document::restyle_media_elements(const media_query_list::vector& lists)
+{
+	std::set<const element*> restyle;
+	elements_vector elements;
+	for (const auto& list : lists)
+	{
+		auto iter = m_media_elements.find(list);
+		if (iter == m_media_elements.end())
+		{
+			continue;
+		}
+		for (const auto& weak_el : iter->second)
+		{
+			element::ptr el = weak_el.lock();
+			if (el && restyle.insert(el.get()).second)
+			{
+				elements.push_back(el);
+			}
+		}
+	}
+
+	for (const auto& el : elements)
+	{
+		// descendants are restyled along with their ancestor
+		bool nested = false;
+		for (element::ptr parent = el->parent(); parent && !nested; parent = parent->parent())
+		{
+			nested = restyle.find(parent.get()) != restyle.end();
+		}
+		if (!nested)
+		{
+			el->refresh_styles();
+			el->parse_styles();
+		}
+	}
+}
+
 void litehtml::document::add_media_list(media_query_list::ptr list)
 {
 	if (list)
 	{
-		if (std::find(m_media_lists.begin(), m_media_lists.end(), list) == m_media_lists.end())
+		m_media_lists.insert(std::make_pair(list, false));
+	}
+}
+
+bool litehtml::document::is_media_used(const media_query_list::ptr& list) const
+{
+	auto iter = m_media_lists.find(list);
+	return iter != m_media_lists.end() && iter->second;
+}
+
+void litehtml::document::add_media_element(const media_query_list::ptr& list, const element::ptr& el)
+{
+	std::vector<element::weak_ptr>& elements = m_media_elements[list];
+	// selectors under one list are adjacent, so the repeats come in a row
+	if (elements.empty() || elements.back().lock() != el)
+	{
+		elements.push_back(el);
+	}
+}
+
+void litehtml::document::add_image_element(const tstring& src, const std::shared_ptr<el_image>& el)
+{
+	std::vector<std::weak_ptr<el_image>>& elements = m_image_elements[src];
+	for (const auto& weak_el : elements)
+	{
+		if (weak_el.lock() == el)
+		{
+			return;
+		}
+	}
+	elements.push_back(el);
+}
+
+// Called by the container when the image requested with load_image() is loaded, src is the one given
+// to load_image(). The images whose size depends on the loaded one are laid out again along with their
+// ancestors, the rest of the document keeps its layout. Returns true when redraw_boxes has the areas
+// to draw again, in document coordinates.
+bool litehtml::document::image_ready(const tchar_t* src, const size& sz, position::vector& redraw_boxes)
+{
+	auto iter = m_image_elements.find(src);
+	if (iter == m_image_elements.end())
+	{
+		return false;
+	}
+
+	size_t redraw_count = redraw_boxes.size();
+	bool relayout = false;
+	for (const auto& weak_el : iter->second)
+	{
+		std::shared_ptr<el_image> el = weak_el.lock();
+		if (!el)
+		{
+			continue;
+		}
+		if (el->set_image_size(sz))
+		{
+			for (element::ptr cur = el; cur && !cur->m_layout_dirty; cur = cur->parent())
+			{
+				cur->m_layout_dirty = true;
+			}
+			relayout = true;
+		}
+		else if (m_render_width >= 0)
+		{
+			position pos = el->get_placement();
+			pos += el->m_padding;
+			pos += el->m_borders;
+			redraw_boxes.push_back(pos);
+		}
+	}
+
+	// before the first layout the images just keep their size
+	if (relayout && m_root && m_render_width >= 0)
+	{
+		relayout_dirty(redraw_boxes);
+	}
+	return redraw_boxes.size() != redraw_count;
+}
+
+bool litehtml::document::relayout_dirty(position::vector& redraw_boxes)
+{
+	int old_height = m_size.height;
+	int top = INT_MAX;
+	int shift = 0;
+
+	// the floats are registered with <html> or <body> and are not moved with the boxes, the
+	// documents with floats are laid out again completely
+	auto has_floats = [](const element::ptr& el)
+	{
+		html_tag* tag = dynamic_cast<html_tag*>(el.get());
+		return tag && (!tag->m_floats_left.empty() || !tag->m_floats_right.empty());
+	};
+	bool complete = !has_floats(m_root);
+	for (auto& el : m_root->m_children)
+	{
+		complete = complete && !has_floats(el);
+	}
+
+	for (auto& el : m_root->m_children)
+	{
+		if (!complete)
+		{
+			break;
+		}
+		if (shift)
 		{
-			m_media_lists.push_back(list);
+			el->m_pos.y += shift;
+		}
+		if (el->m_layout_dirty)
+		{
+			position placement = el->get_placement();
+			int el_top = INT_MAX;
+			shift += el->relayout_dirty(el_top);
+			if (el_top != INT_MAX)
+			{
+				top = std::min(top, placement.y + el_top);
+			}
+			// the changed images in floats, positioned or inline content of <body> need the full layout
+			for (auto& child : el->m_children)
+			{
+				complete = complete && !child->m_layout_dirty;
+			}
 		}
 	}
+
+	if (!complete)
+	{
+		render_root(m_render_width, render_all);
+		redraw_boxes.push_back(position(0, 0, 0, std::max(m_size.width, 1), std::max(std::max(m_size.height, old_height), 1), m_size.depth));
+		return true;
+	}
+	m_root->clear_layout_dirty();
+	if (top == INT_MAX)
+	{
+		return false;
+	}
+	m_root->m_pos.height += shift;
+
+	if (m_root->fetch_positioned())
+	{
+		m_fixed_boxes.clear();
+		m_root->render_positioned(render_all);
+	}
+	m_size.width = 0;
+	m_size.height = 0;
+	m_size.depth = 0;
+	m_root->calc_document_size(m_size);
+
+	// everything below the top of the first changed block can move
+	int bottom = std::max(m_size.height, old_height);
+	redraw_boxes.push_back(position(0, top, 0, m_size.width, std::max(bottom - top, 0), m_size.depth));
+	return true;
+}
+
+litehtml::style::ptr litehtml::document::get_inline_style(const tchar_t* str)
+{
+	// the repeated style attributes share the parsed style, a page of distinct ones stops filling the cache
+	const size_t max_inline_styles = 1024;
+
+	tstring key = str;
+	std::map<tstring, style::ptr>::iterator i = m_inline_styles.find(key);
+	if (i != m_inline_styles.end())
+	{
+		return i->second;
+	}
+	style::ptr st = std::make_shared<style>();
+	st->add(str, NULL);
+	if (m_inline_styles.size() < max_inline_styles)
+	{
+		m_inline_styles.insert(std::make_pair(std::move(key), st));
+	}
+	return st;
+}
+
+litehtml::document_memory_usage litehtml::document::memory_usage() const
+{
+	document_memory_usage usage;
+	usage.elements = sizeof(document) + vector_memory(m_tabular_elements);
+	if (m_root)
+	{
+		m_root->add_memory_usage(usage);
+	}
+
+	usage.styles += vector_memory(m_css);
+	for (const auto& css : m_css)
+	{
+		usage.styles += string_memory(css.text) + string_memory(css.baseurl) + string_memory(css.media);
+	}
+	for (const auto& st : m_inline_styles)
+	{
+		usage.styles += sizeof(std::map<tstring, style::ptr>::value_type) + map_node_overhead + string_memory(st.first) + sizeof(style) + st.second->memory_size();
+	}
+
+	usage.selectors += vector_memory(m_styles.selectors()) + m_styles.selectors().size() * sizeof(css_selector);
+	// the selectors of a rule share its declarations
+	std::set<const style*> rule_styles;
+	for (const auto& sel : m_styles.selectors())
+	{
+		if (sel->m_style && rule_styles.insert(sel->m_style.get()).second)
+		{
+			usage.styles += sizeof(style) + sel->m_style->memory_size();
+		}
+	}
+	usage.selectors += m_media_lists.size() * (sizeof(std::map<media_query_list::ptr, bool>::value_type) + map_node_overhead);
+	for (const auto& item : m_media_elements)
+	{
+		usage.selectors += sizeof(std::map<media_query_list::ptr, std::vector<element::weak_ptr>>::value_type) + map_node_overhead + vector_memory(item.second);
+	}
+	for (const auto& item : m_image_elements)
+	{
+		usage.elements += sizeof(std::map<tstring, std::vector<std::weak_ptr<el_image>>>::value_type) + map_node_overhead + string_memory(item.first) + vector_memory(item.second);
+	}
+
+	usage.boxes += vector_memory(m_fixed_boxes);
+
+	// the shared fonts belong to the context
+	if (!m_shared_fonts)
+	{
+		usage.fonts += m_fonts.bucket_count() * sizeof(void*) + m_fonts.size() * (sizeof(fonts_map::value_type) + sizeof(void*));
+		for (const auto& font : m_fonts)
+		{
+			usage.fonts += string_memory(font.first.family);
+		}
+	}
+	return usage;
 }
 
 void litehtml::document::create_node(void* gnode, elements_vector& elements, bool parseTextNode)
@@ -676,7 +1162,8 @@ void litehtml::document::create_node(void* gnode, elements_vector& elements, boo
 		for (unsigned int i = 0; i < node->v.element.attributes.length; i++)
 		{
 			attr = (GumboAttribute*)node->v.element.attributes.data[i];
-			attrs[tstring(litehtml_from_utf8(attr->name))] = litehtml_from_utf8(attr->value);
+			attrs.emplace(litehtml_from_utf8(attr->name), litehtml_from_utf8(attr->value));
+			release_gumbo_text(attr->value);
 		}
 
 
@@ -684,7 +1171,7 @@ void litehtml::document::create_node(void* gnode, elements_vector& elements, boo
 		const char* tag = gumbo_normalized_tagname(node->v.element.tag);
 		if (tag[0])
 		{
-			ret = create_element(litehtml_from_utf8(tag), attrs);
+			ret = create_element(litehtml_from_utf8(tag), std::move(attrs));
 		}
 		else
 		{
@@ -693,7 +1180,7 @@ void litehtml::document::create_node(void* gnode, elements_vector& elements, boo
 				std::string strA;
 				gumbo_tag_from_original_text(&node->v.element.original_tag);
 				strA.append(node->v.element.original_tag.data, node->v.element.original_tag.length);
-				ret = create_element(litehtml_from_utf8(strA.c_str()), attrs);
+				ret = create_element(litehtml_from_utf8(strA.c_str()), std::move(attrs));
 			}
 		}
 		if (!strcmp(tag, "script"))
@@ -720,49 +1207,45 @@ void litehtml::document::create_node(void* gnode, elements_vector& elements, boo
 	break;
 	case GUMBO_NODE_TEXT:
 	{
-		std::wstring str;
-		std::wstring str_in = (const wchar_t*)(utf8_to_wchar(node->v.text.text));
+		const char* text = node->v.text.text;
 		if (!parseTextNode)
 		{
-			elements.push_back(std::make_shared<el_text>(litehtml_from_wchar(str_in.c_str()), shared_from_this()));
+			elements.push_back(std::make_shared<el_text>(litehtml_from_utf8(text), shared_from_this()));
+			release_gumbo_text(node->v.text.text);
 			break;
 		}
-		ucode_t c;
-		for (size_t i = 0; i < str_in.length(); i++)
+		// the words are cut from the utf-8 text, spaces and CJK characters are separate elements
+		size_t word = 0;
+		size_t i = 0;
+		while (text[i])
 		{
-			c = (ucode_t)str_in[i];
-			if (c <= ' ' && (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f'))
+			size_t len = 1;
+			ucode_t c = utf8_char(text + i, len);
+			if ((c <= ' ' && (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f')) ||
+				// CJK character range
+				(c >= 0x4E00 && c <= 0x9FCC))
 			{
-				if (!str.empty())
+				if (i > word)
 				{
-					elements.push_back(std::make_shared<el_text>(litehtml_from_wchar(str.c_str()), shared_from_this()));
-					str.clear();
+					elements.push_back(std::make_shared<el_text>(utf8_piece(text + word, i - word).c_str(), shared_from_this()));
 				}
-				str += c;
-				elements.push_back(std::make_shared<el_space>(litehtml_from_wchar(str.c_str()), shared_from_this()));
-				str.clear();
-			}
-			// CJK character range
-			else if (c >= 0x4E00 && c <= 0x9FCC)
-			{
-				if (!str.empty())
+				if (c <= ' ')
 				{
-					elements.push_back(std::make_shared<el_text>(litehtml_from_wchar(str.c_str()), shared_from_this()));
-					str.clear();
+					elements.push_back(std::make_shared<el_space>(utf8_piece(text + i, len).c_str(), shared_from_this()));
 				}
-				str += c;
-				elements.push_back(std::make_shared<el_text>(litehtml_from_wchar(str.c_str()), shared_from_this()));
-				str.clear();
-			}
-			else
-			{
-				str += c;
+				else
+				{
+					elements.push_back(std::make_shared<el_text>(utf8_piece(text + i, len).c_str(), shared_from_this()));
+				}
+				word = i + len;
 			}
+			i += len;
 		}
-		if (!str.empty())
+		if (i > word)
 		{
-			elements.push_back(std::make_shared<el_text>(litehtml_from_wchar(str.c_str()), shared_from_this()));
+			elements.push_back(std::make_shared<el_text>(utf8_piece(text + word, i - word).c_str(), shared_from_this()));
 		}
+		release_gumbo_text(node->v.text.text);
 	}
 	break;
 	case GUMBO_NODE_CDATA:
@@ -770,6 +1253,7 @@ void litehtml::document::create_node(void* gnode, elements_vector& elements, boo
 		element::ptr ret = std::make_shared<el_cdata>(shared_from_this());
 		ret->set_data(litehtml_from_utf8(node->v.text.text));
 		elements.push_back(ret);
+		release_gumbo_text(node->v.text.text);
 	}
 	break;
 	case GUMBO_NODE_COMMENT:
@@ -777,6 +1261,7 @@ void litehtml::document::create_node(void* gnode, elements_vector& elements, boo
 		element::ptr ret = std::make_shared<el_comment>(shared_from_this());
 		ret->set_data(litehtml_from_utf8(node->v.text.text));
 		elements.push_back(ret);
+		release_gumbo_text(node->v.text.text);
 	}
 	break;
 	case GUMBO_NODE_WHITESPACE:
@@ -786,6 +1271,7 @@ void litehtml::document::create_node(void* gnode, elements_vector& elements, boo
 		{
 			elements.push_back(std::make_shared<el_space>(str.substr(i, 1).c_str(), shared_from_this()));
 		}
+		release_gumbo_text(node->v.text.text);
 	}
 	break;
 	default:
@@ -863,13 +1349,15 @@ void litehtml::document::fix_table_children(element::ptr& el_ptr, style_display
 		{
 			cur_iter = el_ptr->m_children.erase(cur_iter);
 		}
+		el_ptr->children_changed();
 		first_iter = cur_iter;
 		tmp.clear();
 	};
 
 	while (cur_iter != el_ptr->m_children.end())
 	{
-		if ((*cur_iter)->get_display() != disp)
+		style_display cur_disp = (*cur_iter)->get_display();
+		if (cur_disp != disp && !(disp == display_table_row_group && (cur_disp == display_table_column || cur_disp == display_table_column_group)))
 		{
 			if (!(*cur_iter)->is_white_space() || ((*cur_iter)->is_white_space() && !tmp.empty()))
 			{
@@ -966,6 +1454,7 @@ void litehtml::document::fix_table_parent(element::ptr& el_ptr, style_display di
 			);
 			first = parent->m_children.erase(first, last + 1);
 			parent->m_children.insert(first, annon_tag);
+			parent->children_changed();
 		}
 	}
 }
@@ -0,0 +1,578 @@
+#include "html.h"
+#include "document.h"
+#include "stylesheet.h"
+#include "html_tag.h"
+#include "el_text.h"
+#include "el_space.h"
+#include "el_comment.h"
+#include "el_cdata.h"
+#include "el_before_after.h"
+#include "el_style.h"
+#include "el_script.h"
+#include <map>
+
+namespace
+{
+	// "LHDS" - the signature of the document snapshots written by document::save_snapshot
+	const int dom_binary_signature	= 0x5344484C;
+	const int dom_binary_version	= 2;
+
+	enum snapshot_node
+	{
+		snapshot_node_tag,
+		snapshot_node_anonymous,	// anonymous table boxes, created without a tag name
+		snapshot_node_before,
+		snapshot_node_after,
+		snapshot_node_text,
+		snapshot_node_space,
+		snapshot_node_comment,
+		snapshot_node_cdata,
+		snapshot_node_style,
+		snapshot_node_script,
+	};
+
+	enum snapshot_sheet
+	{
+		snapshot_sheet_master,
+		snapshot_sheet_document,
+		snapshot_sheet_user,
+	};
+
+	typedef std::map<const litehtml::css_selector*, std::pair<int, int>>	selector_ids;
+
+	void add_selector_ids(selector_ids& ids, const litehtml::css* sheet, snapshot_sheet sheet_id)
+	{
+		if (sheet)
+		{
+			for (size_t i = 0; i < sheet->selectors().size(); i++)
+			{
+				ids[sheet->selectors()[i].get()] = std::make_pair((int) sheet_id, (int) i);
+			}
+		}
+	}
+
+	// FNV-1a hash of the stored data, it has to be the same on all platforms
+	class snapshot_hash
+	{
+		unsigned int	m_hash;
+	public:
+		snapshot_hash()
+		{
+			m_hash = 2166136261u;
+		}
+
+		void add_bytes(const void* data, size_t size)
+		{
+			const unsigned char* bytes = (const unsigned char*) data;
+			for (size_t i = 0; i < size; i++)
+			{
+				m_hash = (m_hash ^ bytes[i]) * 16777619u;
+			}
+		}
+
+		void add_int(int val)
+		{
+			add_bytes(&val, sizeof(val));
+		}
+
+		void add_string(const litehtml::tstring& str)
+		{
+			add_int((int) str.length());
+			add_bytes(str.c_str(), str.length() * sizeof(litehtml::tchar_t));
+		}
+
+		int value() const
+		{
+			return (int) m_hash;
+		}
+	};
+
+	// Hash of the selectors and declarations of a style sheet. The used selectors are stored by index,
+	// so a snapshot can only be loaded with the same master and user style sheets.
+	int stylesheet_hash(const litehtml::css* sheet)
+	{
+		snapshot_hash hash;
+		if (sheet)
+		{
+			for (const auto& sel : sheet->selectors())
+			{
+				hash.add_int(sel->m_media_query ? 1 : 0);
+				for (const litehtml::css_selector* part = sel.get(); part; part = part->m_left.get())
+				{
+					hash.add_int(part->m_specificity.a);
+					hash.add_int(part->m_specificity.b);
+					hash.add_int(part->m_specificity.c);
+					hash.add_int(part->m_specificity.d);
+					hash.add_int(part->m_order);
+					hash.add_int(part->m_combinator);
+					hash.add_string(part->m_right.m_tag);
+					for (const auto& attr : part->m_right.m_attrs)
+					{
+						hash.add_string(attr.attribute);
+						hash.add_string(attr.val);
+						for (const auto& cls : attr.class_val)
+						{
+							hash.add_string(cls);
+						}
+						hash.add_int(attr.condition);
+					}
+				}
+				if (sel->m_style)
+				{
+					for (const auto& prop : sel->m_style->properties())
+					{
+						hash.add_string(prop.first);
+						hash.add_string(prop.second.m_value);
+						hash.add_int(prop.second.m_important ? 1 : 0);
+					}
+				}
+			}
+		}
+		return hash.value();
+	}
+
+	// Style state of a tag, set once the attributes are parsed
+	struct pending_style
+	{
+		litehtml::html_tag*		tag;
+		litehtml::style			st;
+		litehtml::string_vector	pseudo_classes;
+		std::vector<int>		used;		// sheet, selector index and used flag for every used selector
+	};
+}
+
+bool litehtml::document::save_snapshot(byte_vector& data, const litehtml::css* user_styles) const
+{
+	if (!m_root)
+	{
+		return false;
+	}
+
+	selector_ids ids;
+	add_selector_ids(ids, m_context ? &m_context->master_css() : nullptr, snapshot_sheet_master);
+	add_selector_ids(ids, &m_styles, snapshot_sheet_document);
+	add_selector_ids(ids, user_styles, snapshot_sheet_user);
+
+	byte_vector nodes;
+	binary_writer out_nodes(nodes);
+	int count = 0;
+	// writes a node and the number of its children
+	auto write_node = [&](const element::ptr& el) -> bool
+	{
+		count++;
+		const html_tag* tag = dynamic_cast<const html_tag*>(el.get());
+		if (tag)
+		{
+			snapshot_node node = snapshot_node_tag;
+			// the tag names are set in lower case, the anonymous tags keep the name given by the constructor
+			if (tag->m_tag == _t("NEW"))
+			{
+				node = snapshot_node_anonymous;
+			}
+			else if (tag->m_tag == _t("::before"))
+			{
+				node = snapshot_node_before;
+			}
+			else if (tag->m_tag == _t("::after"))
+			{
+				node = snapshot_node_after;
+			}
+			out_nodes.write_int(node);
+			out_nodes.write_string(tag->m_tag);
+			out_nodes.write_int((int) tag->m_attrs.size());
+			for (const auto& attr : tag->m_attrs)
+			{
+				out_nodes.write_string(attr.first);
+				out_nodes.write_string(attr.second);
+			}
+			out_nodes.write_int((int) tag->m_style.properties().size());
+			for (const auto& prop : tag->m_style.properties())
+			{
+				out_nodes.write_string(prop.first);
+				out_nodes.write_string(prop.second.m_value);
+				out_nodes.write_bool(prop.second.m_important);
+			}
+			out_nodes.write_int((int) tag->m_pseudo_classes.size());
+			for (const auto& pc : tag->m_pseudo_classes)
+			{
+				out_nodes.write_string(pc);
+			}
+			out_nodes.write_int((int) tag->m_used_styles.size());
+			for (const auto& us : tag->m_used_styles)
+			{
+				auto id = ids.find(us->m_selector.get());
+				if (id == ids.end())
+				{
+					return false;
+				}
+				out_nodes.write_int(id->second.first);
+				out_nodes.write_int(id->second.second);
+				out_nodes.write_bool(us->m_used);
+			}
+		}
+		else
+		{
+			snapshot_node node;
+			if (dynamic_cast<const el_space*>(el.get()))
+			{
+				node = snapshot_node_space;
+			}
+			else if (dynamic_cast<const el_text*>(el.get()))
+			{
+				node = snapshot_node_text;
+			}
+			else if (dynamic_cast<const el_comment*>(el.get()))
+			{
+				node = snapshot_node_comment;
+			}
+			else if (dynamic_cast<const el_cdata*>(el.get()))
+			{
+				node = snapshot_node_cdata;
+			}
+			else if (dynamic_cast<const el_style*>(el.get()))
+			{
+				node = snapshot_node_style;
+			}
+			else if (dynamic_cast<const el_script*>(el.get()))
+			{
+				node = snapshot_node_script;
+			}
+			else
+			{
+				// elements of the container that are not tags can't be created again
+				return false;
+			}
+			tstring text;
+			if (node == snapshot_node_style)
+			{
+				for (const auto& child : static_cast<const el_style*>(el.get())->m_children)
+				{
+					child->get_text(text);
+				}
+			}
+			else if (node == snapshot_node_script)
+			{
+				text = static_cast<const el_script*>(el.get())->m_text;
+			}
+			else
+			{
+				el->get_text(text);
+			}
+			out_nodes.write_int(node);
+			out_nodes.write_string(text);
+		}
+
+		out_nodes.write_int((int) el->m_children.size());
+		return true;
+	};
+
+	// the children follow their parent, in the order createFromSnapshot reads them back with its stack
+	struct open_node
+	{
+		const element*	el;
+		size_t			next_child;
+	};
+	std::vector<open_node> open;
+	if (!write_node(m_root))
+	{
+		return false;
+	}
+	open.push_back({ m_root.get(), 0 });
+	while (!open.empty())
+	{
+		open_node& top = open.back();
+		if (top.next_child == top.el->m_children.size())
+		{
+			open.pop_back();
+			continue;
+		}
+		const element::ptr& child = top.el->m_children[top.next_child++];
+		if (!write_node(child))
+		{
+			return false;
+		}
+		open.push_back({ child.get(), 0 });
+	}
+
+	binary_writer out(data);
+	out.write_int(dom_binary_signature);
+	out.write_int(dom_binary_version);
+	out.write_int((int) sizeof(tchar_t));
+	out.write_int(m_context ? (int) m_context->master_css().selectors().size() : 0);
+	out.write_int(user_styles ? (int) user_styles->selectors().size() : 0);
+	out.write_int(stylesheet_hash(m_context ? &m_context->master_css() : nullptr));
+	out.write_int(stylesheet_hash(user_styles));
+
+	out.write_int(m_media.type);
+	out.write_int(m_media.width);
+	out.write_int(m_media.height);
+	out.write_int(m_media.depth);
+	out.write_int(m_media.device_width);
+	out.write_int(m_media.device_height);
+	out.write_int(m_media.device_depth);
+	out.write_int(m_media.color);
+	out.write_int(m_media.color_index);
+	out.write_int(m_media.monochrome);
+	out.write_int(m_media.resolution);
+
+	// the document style sheets with media queries are parsed again from the sources
+	byte_vector styles;
+	bool parsed_styles = m_styles.save(styles);
+	out.write_bool(parsed_styles);
+	if (parsed_styles)
+	{
+		out.write_int((int) styles.size());
+		out.write_bytes(styles.data(), styles.size());
+	}
+
+	out.write_int(count);
+	out.write_bytes(nodes.data(), nodes.size());
+	return true;
+}
+
+litehtml::document::ptr litehtml::document::createFromSnapshot(const unsigned char* data, size_t size, litehtml::document_container* objPainter, litehtml::context* ctx, litehtml::css* user_styles)
+{
+	binary_reader in(data, size);
+	if (in.read_int() != dom_binary_signature || in.read_int() != dom_binary_version || in.read_int() != (int) sizeof(tchar_t))
+	{
+		return nullptr;
+	}
+	// the used selectors are stored by index
+	if (in.read_int() != (int) ctx->master_css().selectors().size() || in.read_int() != (user_styles ? (int) user_styles->selectors().size() : 0) ||
+		in.read_int() != stylesheet_hash(&ctx->master_css()) || in.read_int() != stylesheet_hash(user_styles))
+	{
+		return nullptr;
+	}
+
+	litehtml::document::ptr doc = std::make_shared<litehtml::document>(objPainter, ctx);
+
+	doc->m_media.type = (media_type) in.read_int();
+	doc->m_media.width = in.read_int();
+	doc->m_media.height = in.read_int();
+	doc->m_media.depth = in.read_int();
+	doc->m_media.device_width = in.read_int();
+	doc->m_media.device_height = in.read_int();
+	doc->m_media.device_depth = in.read_int();
+	doc->m_media.color = in.read_int();
+	doc->m_media.color_index = in.read_int();
+	doc->m_media.monochrome = in.read_int();
+	doc->m_media.resolution = in.read_int();
+
+	bool parsed_styles = in.read_bool();
+	const unsigned char* styles_data = nullptr;
+	int styles_size = 0;
+	if (parsed_styles)
+	{
+		styles_size = in.read_count();
+		styles_data = in.read_data(styles_size);
+	}
+
+	std::vector<pending_style> styles;
+	{
+		LITEHTML_STATS_PHASE(doc, stats_phase_create_elements);
+		int count = in.read_count();
+		int created = 0;
+		// reads a node without its children
+		auto read_node = [&]() -> element::ptr
+		{
+			if (++created > count || in.failed())
+			{
+				return nullptr;
+			}
+			element::ptr el;
+			snapshot_node node = (snapshot_node) in.read_int();
+			switch (node)
+			{
+			case snapshot_node_tag:
+			case snapshot_node_anonymous:
+			case snapshot_node_before:
+			case snapshot_node_after:
+				{
+					tstring tag_name = in.read_string();
+					string_map attrs;
+					int attrs_count = in.read_count();
+					for (int i = 0; i < attrs_count && !in.failed(); i++)
+					{
+						tstring name = in.read_string();
+						attrs[name] = in.read_string();
+					}
+					if (node == snapshot_node_tag)
+					{
+						el = doc->create_element(tag_name.c_str(), std::move(attrs));
+					}
+					else
+					{
+						if (node == snapshot_node_before)
+						{
+							el = std::make_shared<el_before>(doc);
+						}
+						else if (node == snapshot_node_after)
+						{
+							el = std::make_shared<el_after>(doc);
+						}
+						else
+						{
+							el = std::make_shared<html_tag>(doc);
+						}
+						el->set_attrs(std::move(attrs));
+					}
+
+					pending_style ps;
+					ps.tag = dynamic_cast<html_tag*>(el.get());
+					int props_count = in.read_count();
+					for (int i = 0; i < props_count && !in.failed(); i++)
+					{
+						tstring name = in.read_string();
+						tstring val = in.read_string();
+						ps.st.add_parsed_property(name, val, in.read_bool());
+					}
+					ps.pseudo_classes.resize(in.read_count());
+					for (auto& pc : ps.pseudo_classes)
+					{
+						pc = in.read_string();
+					}
+					ps.used.resize(in.read_count(sizeof(int) * 2 + 1) * 3);
+					for (size_t i = 0; i < ps.used.size(); i += 3)
+					{
+						ps.used[i] = in.read_int();
+						ps.used[i + 1] = in.read_int();
+						ps.used[i + 2] = in.read_bool() ? 1 : 0;
+					}
+					if (!ps.tag)
+					{
+						return nullptr;
+					}
+					styles.push_back(std::move(ps));
+				}
+				break;
+			case snapshot_node_text:
+				el = std::make_shared<el_text>(in.read_string().c_str(), doc);
+				break;
+			case snapshot_node_space:
+				el = std::make_shared<el_space>(in.read_string().c_str(), doc);
+				break;
+			case snapshot_node_comment:
+				el = std::make_shared<el_comment>(doc);
+				el->set_data(in.read_string().c_str());
+				break;
+			case snapshot_node_cdata:
+				el = std::make_shared<el_cdata>(doc);
+				el->set_data(in.read_string().c_str());
+				break;
+			case snapshot_node_style:
+			case snapshot_node_script:
+				{
+					el = doc->create_element(node == snapshot_node_style ? _t("style") : _t("script"), string_map());
+					tstring text = in.read_string();
+					if (el && !text.empty())
+					{
+						el->appendChild(std::make_shared<el_text>(text.c_str(), doc));
+					}
+				}
+				break;
+			default:
+				return nullptr;
+			}
+
+			return el;
+		};
+
+		// the tree is built with a stack of the open nodes, the nesting depth comes from the data
+		struct open_node
+		{
+			element::ptr	el;
+			int				children;
+		};
+		std::vector<open_node> open;
+		element::ptr root = read_node();
+		if (root)
+		{
+			open.push_back({ root, in.read_count() });
+		}
+		while (!open.empty() && !in.failed())
+		{
+			if (!open.back().children)
+			{
+				open.pop_back();
+				continue;
+			}
+			open.back().children--;
+			element::ptr child = read_node();
+			if (!child)
+			{
+				root = nullptr;
+				break;
+			}
+			open.back().el->appendChild(child);
+			open.push_back({ child, in.read_count() });
+		}
+		doc->m_root = root;
+		if (!doc->m_root || in.failed() || !in.at_end() || created != count)
+		{
+			return nullptr;
+		}
+	}
+
+	{
+		LITEHTML_STATS_PHASE(doc, stats_phase_cascade);
+
+		// the media lists are evaluated for the media of the snapshot, the styles were applied for it
+		for (const auto& sel : ctx->master_css().selectors())
+		{
+			sel->add_media_to_doc(doc.get());
+		}
+		if (user_styles)
+		{
+			for (const auto& sel : user_styles->selectors())
+			{
+				sel->add_media_to_doc(doc.get());
+			}
+		}
+
+		// the attributes fill the document style sheets and notify the container (title, base url, links)
+		doc->m_root->parse_attributes();
+
+		if (parsed_styles)
+		{
+			if (!doc->m_styles.load(styles_data, styles_size))
+			{
+				return nullptr;
+			}
+		}
+		else
+		{
+			doc->parse_stylesheets();
+		}
+		doc->update_media_lists(doc->m_media);
+
+		const css* sheets[] = { &ctx->master_css(), &doc->m_styles, user_styles };
+		for (auto& ps : styles)
+		{
+			html_tag* tag = ps.tag;
+			tag->m_style = ps.st;
+			tag->m_pseudo_classes = std::move(ps.pseudo_classes);
+			tag->m_used_styles.clear();
+			for (size_t i = 0; i < ps.used.size(); i += 3)
+			{
+				int sheet = ps.used[i];
+				int idx = ps.used[i + 1];
+				if (sheet < snapshot_sheet_master || sheet > snapshot_sheet_user || !sheets[sheet] || idx < 0 || idx >= (int) sheets[sheet]->selectors().size())
+				{
+					return nullptr;
+				}
+				const css_selector::ptr& sel = sheets[sheet]->selectors()[idx];
+				if (sel->m_media_query)
+				{
+					doc->add_media_element(sel->m_media_query, tag->shared_from_this());
+				}
+				tag->m_used_styles.push_back(std::unique_ptr<used_selector>(new used_selector(sel, ps.used[i + 2] != 0)));
+			}
+		}
+	}
+
+	doc->init_elements();
+
+	// the container media can differ from the one of the snapshot
+	doc->media_changed();
+	return doc;
+}
@@ -0,0 +1,104 @@
+#include "html.h"
+#include "document_stats.h"
+#include "element.h"
+#include "utf8_strings.h"
+#include <stdio.h>
+
+#ifndef LITEHTML_NO_STATS
+thread_local litehtml::document_stats* litehtml::g_current_stats = nullptr;
+thread_local litehtml::document_trace* litehtml::g_current_trace = nullptr;
+#endif
+
+const char* litehtml::get_stats_phase_name(stats_phase phase)
+{
+	static const char* const names[stats_phase_count] = { "parse", "create_elements", "cascade", "parse_styles", "init", "render", "draw" };
+	return phase >= 0 && phase < stats_phase_count ? names[phase] : "";
+}
+
+void litehtml::document_trace::add(const char* name, const char* category, const element* el, const trace_clock::time_point& start)
+{
+	trace_clock::time_point end = trace_clock::now();
+
+	trace_event ev;
+	ev.name = name;
+	ev.category = category;
+	ev.ts = std::chrono::duration<double, std::micro>(start - m_start).count();
+	ev.dur = std::chrono::duration<double, std::micro>(end - start).count();
+	if (el)
+	{
+		const tchar_t* tag = el->get_tagName();
+		const tchar_t* id = el->get_attr(_t("id"));
+		if (tag)
+		{
+			ev.tag = tag;
+		}
+		if (id)
+		{
+			ev.id = id;
+		}
+	}
+	m_events.push_back(std::move(ev));
+}
+
+namespace
+{
+	void append_json_string(std::string& json, const char* str)
+	{
+		json += '"';
+		for (; *str; str++)
+		{
+			switch (*str)
+			{
+			case '"':	json += "\\\"";	break;
+			case '\\':	json += "\\\\";	break;
+			case '\n':	json += "\\n";	break;
+			case '\r':	json += "\\r";	break;
+			case '\t':	json += "\\t";	break;
+			default:
+				if ((unsigned char) *str < 0x20)
+				{
+					char buf[8];
+					snprintf(buf, sizeof(buf), "\\u%04x", (unsigned char) *str);
+					json += buf;
+				}
+				else
+				{
+					json += *str;
+				}
+				break;
+			}
+		}
+		json += '"';
+	}
+}
+
+std::string litehtml::document_trace::to_json() const
+{
+	std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	char buf[128];
+	for (size_t i = 0; i < m_events.size(); i++)
+	{
+		const trace_event& ev = m_events[i];
+		if (i)
+		{
+			json += ",\n";
+		}
+		json += "{\"name\":";
+		append_json_string(json, ev.name);
+		json += ",\"cat\":";
+		append_json_string(json, ev.category);
+		snprintf(buf, sizeof(buf), ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1", ev.ts, ev.dur);
+		json += buf;
+		if (!ev.tag.empty() || !ev.id.empty())
+		{
+			json += ",\"args\":{\"tag\":";
+			append_json_string(json, litehtml_to_utf8(ev.tag.c_str()));
+			json += ",\"id\":";
+			append_json_string(json, litehtml_to_utf8(ev.id.c_str()));
+			json += '}';
+		}
+		json += '}';
+	}
+	json += "]}\n";
+	return json;
+}
@@ -203,6 +203,7 @@ void litehtml::el_asset::draw( uint_ptr hdc, int x, int y, const position* clip
 			background_paint bg_paint;
 			init_background_paint(pos, bg_paint, bg);
 
+			LITEHTML_STATS_COUNT(draw_calls);
 			get_document()->container()->draw_background(hdc, bg_paint);
 		}
 	}
@@ -227,6 +228,7 @@ void litehtml::el_asset::draw( uint_ptr hdc, int x, int y, const position* clip
 			bg.position_x			= pos.x;
 			bg.position_y			= pos.y;
 			bg.position_z			= pos.z;
+			LITEHTML_STATS_COUNT(draw_calls);
 			get_document()->container()->draw_background(hdc, bg);
 		}
 	}
@@ -241,6 +243,7 @@ void litehtml::el_asset::draw( uint_ptr hdc, int x, int y, const position* clip
 		borders bdr = m_css_borders;
 		bdr.radius = m_css_borders.radius.calc_percents(border_box.width, border_box.height);
 
+		LITEHTML_STATS_COUNT(draw_calls);
 		get_document()->container()->draw_borders(hdc, bdr, border_box, have_parent() ? false : true);
 	}
 }
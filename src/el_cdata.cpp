@@ -22,3 +22,10 @@ void litehtml::el_cdata::set_data(const tchar_t* data)
 		m_text += data;
 	}
 }
+
+void litehtml::el_cdata::add_memory_usage(document_memory_usage& usage) const
+{
+	element::add_memory_usage(usage);
+	usage.elements += sizeof(el_cdata) - sizeof(element) - sizeof(m_text);
+	usage.text += sizeof(m_text) + string_memory(m_text);
+}
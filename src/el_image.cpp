@@ -5,6 +5,7 @@
 litehtml::el_image::el_image(const std::shared_ptr<litehtml::document>& doc) : html_tag(doc)
 {
 	m_display = display_inline_block;
+	m_image_ready = false;
 }
 
 litehtml::el_image::~el_image(void)
@@ -13,7 +14,26 @@ litehtml::el_image::~el_image(void)
 
 void litehtml::el_image::get_content_size(size& sz, int max_width)
 {
-	get_document()->container()->get_image_size(m_src.c_str(), 0, 0, sz);
+	get_image_size(sz);
+}
+
+void litehtml::el_image::get_image_size(size& sz)
+{
+	// until the container reports the image with document::image_ready() the size is asked for every layout
+	if (!m_image_ready)
+	{
+		get_document()->container()->get_image_size(m_src.c_str(), 0, 0, m_image_size);
+	}
+	sz = m_image_size;
+}
+
+bool litehtml::el_image::set_image_size(const size& sz)
+{
+	bool changed = sz.width != m_image_size.width || sz.height != m_image_size.height || sz.depth != m_image_size.depth;
+	m_image_size = sz;
+	m_image_ready = true;
+	// the size given by width and height does not depend on the image
+	return changed && (m_css_width.is_predefined() || m_css_height.is_predefined());
 }
 
 int litehtml::el_image::calc_max_height(int image_height)
@@ -55,7 +75,7 @@ int litehtml::el_image::render(int x, int y, int z, int max_width, bool second_p
 	document::ptr doc = get_document();
 
 	litehtml::size sz;
-	doc->container()->get_image_size(m_src.c_str(), 0, 0, sz);
+	get_image_size(sz);
 
 	m_pos.width = sz.width;
 	m_pos.height = sz.height;
@@ -205,6 +225,7 @@ void litehtml::el_image::draw(uint_ptr hdc, int x, int y, int z, const position*
 			background_paint bg_paint;
 			init_background_paint(pos, bg_paint, bg);
 
+			LITEHTML_STATS_COUNT(draw_calls);
 			get_document()->container()->draw_background(hdc, bg_paint);
 		}
 	}
@@ -229,6 +250,7 @@ void litehtml::el_image::draw(uint_ptr hdc, int x, int y, int z, const position*
 			bg.position_x = pos.x;
 			bg.position_y = pos.y;
 			bg.position_z = pos.z;
+			LITEHTML_STATS_COUNT(draw_calls);
 			get_document()->container()->draw_background(hdc, bg);
 		}
 	}
@@ -243,6 +265,7 @@ void litehtml::el_image::draw(uint_ptr hdc, int x, int y, int z, const position*
 		borders bdr = m_css_borders;
 		bdr.radius = m_css_borders.radius.calc_percents(border_box.width, border_box.height, border_box.depth);
 
+		LITEHTML_STATS_COUNT(draw_calls);
 		get_document()->container()->draw_borders(hdc, bdr, border_box, have_parent() ? false : true);
 	}
 }
@@ -253,6 +276,7 @@ void litehtml::el_image::parse_styles(bool is_reparse /*= false*/)
 
 	if (!m_src.empty())
 	{
+		get_document()->add_image_element(m_src, std::static_pointer_cast<el_image>(shared_from_this()));
 		if (!m_css_height.is_predefined() && !m_css_width.is_predefined())
 		{
 			get_document()->container()->load_image(m_src.c_str(), 0, 0, true);
@@ -263,3 +287,9 @@ void litehtml::el_image::parse_styles(bool is_reparse /*= false*/)
 		}
 	}
 }
+
+void litehtml::el_image::add_memory_usage(document_memory_usage& usage) const
+{
+	html_tag::add_memory_usage(usage);
+	usage.elements += sizeof(el_image) - sizeof(html_tag) + string_memory(m_src);
+}
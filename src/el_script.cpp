@@ -29,3 +29,10 @@ const litehtml::tchar_t* litehtml::el_script::get_tagName() const
 {
 	return _t("script");
 }
+
+void litehtml::el_script::add_memory_usage(document_memory_usage& usage) const
+{
+	element::add_memory_usage(usage);
+	usage.elements += sizeof(el_script) - sizeof(element) - sizeof(m_text);
+	usage.text += sizeof(m_text) + string_memory(m_text);
+}
@@ -31,3 +31,14 @@ const litehtml::tchar_t* litehtml::el_style::get_tagName() const
 {
 	return _t("style");
 }
+
+void litehtml::el_style::add_memory_usage(document_memory_usage& usage) const
+{
+	element::add_memory_usage(usage);
+	// the text nodes are kept out of the element tree
+	usage.elements += sizeof(el_style) - sizeof(element) + vector_memory(m_children);
+	for (const auto& el : m_children)
+	{
+		el->add_memory_usage(usage);
+	}
+}
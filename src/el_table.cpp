@@ -10,6 +10,7 @@ litehtml::el_table::el_table(const std::shared_ptr<litehtml::document>& doc) : h
 	m_border_spacing_y = 0;
 	m_border_spacing_z = 0;
 	m_border_collapse = border_collapse_separate;
+	m_table_layout = table_layout_auto;
 }
 
 litehtml::el_table::~el_table()
@@ -19,7 +20,8 @@ litehtml::el_table::~el_table()
 bool litehtml::el_table::appendChild(const litehtml::element::ptr& el)
 {
 	if (!el)	return false;
-	if (!t_strcmp(el->get_tagName(), _t("tbody")) || !t_strcmp(el->get_tagName(), _t("thead")) || !t_strcmp(el->get_tagName(), _t("tfoot")))
+	if (!t_strcmp(el->get_tagName(), _t("tbody")) || !t_strcmp(el->get_tagName(), _t("thead")) || !t_strcmp(el->get_tagName(), _t("tfoot")) ||
+		!t_strcmp(el->get_tagName(), _t("colgroup")) || !t_strcmp(el->get_tagName(), _t("col")))
 	{
 		return html_tag::appendChild(el);
 	}
@@ -30,13 +32,14 @@ void litehtml::el_table::parse_styles(bool is_reparse)
 {
 	html_tag::parse_styles(is_reparse);
 
-	m_border_collapse = (border_collapse)value_index(get_style_property(_t("border-collapse"), true, _t("separate")), border_collapse_strings, border_collapse_separate);
+	m_border_collapse = (border_collapse)border_collapse_keywords.find(get_style_property(_t("border-collapse"), true, _t("separate")), border_collapse_separate);
+	m_table_layout = (table_layout)table_layout_keywords.find(get_style_property(_t("table-layout"), false, _t("auto")), table_layout_auto);
 
 	if (m_border_collapse == border_collapse_separate)
 	{
-		m_css_border_spacing_x.fromString(get_style_property(_t("-litehtml-border-spacing-x"), true, _t("0px")));
-		m_css_border_spacing_y.fromString(get_style_property(_t("-litehtml-border-spacing-y"), true, _t("0px")));
-		m_css_border_spacing_z.fromString(get_style_property(_t("-litehtml-border-spacing-z"), true, _t("0px")));
+		get_length(m_css_border_spacing_x, _t("-litehtml-border-spacing-x"), true, _t("0px"));
+		get_length(m_css_border_spacing_y, _t("-litehtml-border-spacing-y"), true, _t("0px"));
+		get_length(m_css_border_spacing_z, _t("-litehtml-border-spacing-z"), true, _t("0px"));
 
 		int fntsz = get_font_size();
 		document::ptr doc = get_document();
@@ -40,9 +40,22 @@ const litehtml::tchar_t* litehtml::el_text::get_style_property(const tchar_t* na
 	return def;
 }
 
+const litehtml::property_value* litehtml::el_text::get_style_value(const tchar_t* name, bool inherited)
+{
+	if (inherited)
+	{
+		element::ptr el_parent = parent();
+		if (el_parent)
+		{
+			return el_parent->get_style_value(name, inherited);
+		}
+	}
+	return 0;
+}
+
 void litehtml::el_text::parse_styles(bool is_reparse)
 {
-	m_text_transform = (text_transform)value_index(get_style_property(_t("text-transform"), true, _t("none")), text_transform_strings, text_transform_none);
+	m_text_transform = (text_transform)text_transform_keywords.find(get_style_property(_t("text-transform"), true, _t("none")), text_transform_none);
 	if (m_text_transform != text_transform_none)
 	{
 		m_transformed_text = m_text;
@@ -85,6 +98,7 @@ void litehtml::el_text::parse_styles(bool is_reparse)
 	else
 	{
 		m_size.height = fm.height;
+		LITEHTML_STATS_COUNT(text_width_calls);
 		m_size.width = get_document()->container()->text_width(m_use_transformed ? m_transformed_text.c_str() : m_text.c_str(), font);
 		m_size.depth = 0;
 	}
@@ -122,6 +136,7 @@ void litehtml::el_text::draw(uint_ptr hdc, int x, int y, int z, const position*
 
 			uint_ptr font = el_parent->get_font();
 			litehtml::web_color color = el_parent->get_color(_t("color"), true, doc->get_def_color());
+			LITEHTML_STATS_COUNT(draw_calls);
 			doc->container()->draw_text(hdc, m_use_transformed ? m_transformed_text.c_str() : m_text.c_str(), font, color, pos);
 		}
 	}
@@ -190,3 +205,11 @@ litehtml::css_offsets litehtml::el_text::get_css_offsets() const
 	}
 	return css_offsets();
 }
+
+void litehtml::el_text::add_memory_usage(document_memory_usage& usage) const
+{
+	element::add_memory_usage(usage);
+	// short strings are kept in the string objects, so they are counted as text
+	usage.elements += sizeof(el_text) - sizeof(element) - sizeof(m_text) - sizeof(m_transformed_text);
+	usage.text += sizeof(m_text) + sizeof(m_transformed_text) + string_memory(m_text) + string_memory(m_transformed_text);
+}
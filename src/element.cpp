@@ -9,6 +9,8 @@ litehtml::element::element(const std::shared_ptr<litehtml::document>& doc) : m_d
 {
 	m_box = 0;
 	m_skip = false;
+	m_deferred = false;
+	m_layout_dirty = false;
 }
 
 litehtml::element::~element()
@@ -48,12 +50,33 @@ bool litehtml::element::is_point_inside(int x, int y, int z)
 
 litehtml::web_color litehtml::element::get_color(const tchar_t* prop_name, bool inherited, const litehtml::web_color& def_color)
 {
-	const tchar_t* clrstr = get_style_property(prop_name, inherited, 0);
-	if (!clrstr)
+	const property_value* val = get_style_value(prop_name, inherited);
+	if (!val)
 	{
 		return def_color;
 	}
-	return web_color::from_string(clrstr, get_document()->container());
+	if (val->m_type == property_type_color)
+	{
+		return val->m_color;
+	}
+	return web_color::from_string(val->m_value.c_str(), get_document()->container());
+}
+
+void litehtml::element::get_length(css_length& len, const tchar_t* prop_name, bool inherited, const tchar_t* def, const tchar_t* predefs)
+{
+	const property_value* val = get_style_value(prop_name, inherited);
+	if (!val)
+	{
+		len.fromString(def, predefs);
+	}
+	else if (val->m_type == property_type_length && !t_strcmp(val->m_predefs, predefs))
+	{
+		len = val->m_length;
+	}
+	else
+	{
+		len.fromString(val->m_value, predefs);
+	}
 }
 
 litehtml::position litehtml::element::get_placement() const
@@ -383,6 +406,46 @@ void litehtml::element::apply_relative_shift(int parent_width)
 	}
 }
 
+void litehtml::element::clear_layout_dirty()
+{
+	// the dirty elements are the chains from the changed elements to the root
+	m_layout_dirty = false;
+	for (auto& el : m_children)
+	{
+		if (el->m_layout_dirty)
+		{
+			el->clear_layout_dirty();
+		}
+	}
+}
+
+void litehtml::element::add_memory_usage(document_memory_usage& usage) const
+{
+	usage.elements += sizeof(element) + vector_memory(m_children);
+	for (const auto& el : m_children)
+	{
+		el->add_memory_usage(usage);
+	}
+}
+
+bool litehtml::element::has_out_of_flow()
+{
+	return get_element_position() >= element_position_absolute || get_float() != float_none;
+}
+
+bool litehtml::element::has_positioned()
+{
+	return is_positioned();
+}
+
+void litehtml::element::set_attrs(string_map&& attrs)
+{
+	for (const auto& attr : attrs)
+	{
+		set_attr(attr.first.c_str(), attr.second.c_str());
+	}
+}
+
 void litehtml::element::calc_auto_margins(int parent_width)							LITEHTML_EMPTY_FUNC
 const litehtml::background* litehtml::element::get_background(bool own_only)		LITEHTML_RETURN_FUNC(0)
 litehtml::element::ptr litehtml::element::get_element_by_point(int x, int y, int z, int client_x, int client_y, int client_z)	LITEHTML_RETURN_FUNC(0)
@@ -438,10 +501,13 @@ int litehtml::element::get_floats_height(element_float el_float) const				LITEHT
 bool litehtml::element::is_floats_holder() const									LITEHTML_RETURN_FUNC(false)
 void litehtml::element::get_content_size(size& sz, int max_width)					LITEHTML_EMPTY_FUNC
 void litehtml::element::init()														LITEHTML_EMPTY_FUNC
+int litehtml::element::realize_deferred(int top, int bottom)						LITEHTML_RETURN_FUNC(0)
+int litehtml::element::relayout_dirty(int& top)										LITEHTML_RETURN_FUNC(0)
 int litehtml::element::render(int x, int y, int z, int max_width, bool second_pass)	LITEHTML_RETURN_FUNC(0)
 bool litehtml::element::appendChild(const ptr &el)									LITEHTML_RETURN_FUNC(false)
 bool litehtml::element::removeChild(const ptr &el)									LITEHTML_RETURN_FUNC(false)
 void litehtml::element::clearRecursive()											LITEHTML_EMPTY_FUNC
+void litehtml::element::children_changed()										LITEHTML_EMPTY_FUNC
 const litehtml::tchar_t* litehtml::element::get_tagName() const						LITEHTML_RETURN_FUNC(_t(""))
 void litehtml::element::set_tagName(const tchar_t* tag)							LITEHTML_EMPTY_FUNC
 void litehtml::element::set_data(const tchar_t* data)								LITEHTML_EMPTY_FUNC
@@ -473,6 +539,7 @@ int litehtml::element::line_height() const											LITEHTML_RETURN_FUNC(0)
 void litehtml::element::draw(uint_ptr hdc, int x, int y, int z, const position* clip)	LITEHTML_EMPTY_FUNC
 void litehtml::element::draw_background(uint_ptr hdc, int x, int y, int z, const position* clip)	LITEHTML_EMPTY_FUNC
 const litehtml::tchar_t* litehtml::element::get_style_property(const tchar_t* name, bool inherited, const tchar_t* def /*= 0*/)	LITEHTML_RETURN_FUNC(0)
+const litehtml::property_value* litehtml::element::get_style_value(const tchar_t* name, bool inherited)	LITEHTML_RETURN_FUNC(0)
 litehtml::uint_ptr litehtml::element::get_font(font_metrics* fm /*= 0*/)			LITEHTML_RETURN_FUNC(0)
 int litehtml::element::get_font_size()	const										LITEHTML_RETURN_FUNC(0)
 void litehtml::element::get_text(tstring& text)									LITEHTML_EMPTY_FUNC
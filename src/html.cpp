@@ -47,50 +47,48 @@ litehtml::tstring::size_type litehtml::find_close_bracket(const tstring &s, tstr
 
 int litehtml::value_index(const tstring& val, const tstring& strings, int defValue, tchar_t delim)
 {
-	if (val.empty() || strings.empty() || !delim)
+	return value_index(val.c_str(), strings.c_str(), defValue, delim);
+}
+
+int litehtml::value_index(const tchar_t* val, const tchar_t* strings, int defValue, tchar_t delim)
+{
+	if (!val || !strings || !val[0] || !strings[0] || !delim)
 	{
 		return defValue;
 	}
 
+	size_t len = t_strlen(val);
 	int idx = 0;
-	tstring::size_type delim_start = 0;
-	tstring::size_type delim_end = strings.find(delim, delim_start);
-	tstring::size_type item_len = 0;
+	const tchar_t* start = strings;
 	while (true)
 	{
-		if (delim_end == tstring::npos)
+		const tchar_t* end = start;
+		while (*end && *end != delim)
 		{
-			item_len = strings.length() - delim_start;
+			end++;
 		}
-		else
+		if ((size_t) (end - start) == len && !t_strncmp(start, val, len))
 		{
-			item_len = delim_end - delim_start;
+			return idx;
 		}
-		if (item_len == val.length())
+		if (!*end)
 		{
-			if (val == strings.substr(delim_start, item_len))
-			{
-				return idx;
-			}
+			break;
 		}
 		idx++;
-		delim_start = delim_end;
-		if (delim_start == tstring::npos) break;
-		delim_start++;
-		if (delim_start == strings.length()) break;
-		delim_end = strings.find(delim, delim_start);
+		start = end + 1;
 	}
 	return defValue;
 }
 
 bool litehtml::value_in_list(const tstring& val, const tstring& strings, tchar_t delim)
 {
-	int idx = value_index(val, strings, -1, delim);
-	if (idx >= 0)
-	{
-		return true;
-	}
-	return false;
+	return value_index(val.c_str(), strings.c_str(), -1, delim) >= 0;
+}
+
+bool litehtml::value_in_list(const tchar_t* val, const tchar_t* strings, tchar_t delim)
+{
+	return value_index(val, strings, -1, delim) >= 0;
 }
 
 void litehtml::split_string(const tstring& str, string_vector& tokens, const tstring& delims, const tstring& delims_preserve, const tstring& quote)
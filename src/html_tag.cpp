@@ -32,6 +32,14 @@ litehtml::html_tag::html_tag(const std::shared_ptr<litehtml::document>& doc) : l
 	m_border_spacing_y = 0;
 	m_border_spacing_z = 0;
 	m_border_collapse = border_collapse_separate;
+	m_table_layout = table_layout_auto;
+	m_inline_items_valid = false;
+	m_inline_run = false;
+	m_inline_items_generation = 0;
+	m_children_generation = 0;
+	m_has_out_of_flow = false;
+	m_has_positioned = false;
+	m_out_of_flow_valid = false;
 }
 
 litehtml::html_tag::~html_tag()
@@ -44,6 +52,7 @@ bool litehtml::html_tag::appendChild(const element::ptr &el)
 	{
 		el->parent(shared_from_this());
 		m_children.push_back(el);
+		children_changed();
 		return true;
 	}
 	return false;
@@ -55,6 +64,7 @@ bool litehtml::html_tag::removeChild(const element::ptr &el)
 	{
 		el->parent(nullptr);
 		m_children.erase(std::remove(m_children.begin(), m_children.end(), el), m_children.end());
+		children_changed();
 		return true;
 	}
 	return false;
@@ -104,6 +114,36 @@ void litehtml::html_tag::set_attr(const tchar_t* name, const tchar_t* val)
 	}
 }
 
+void litehtml::html_tag::set_attrs(string_map&& attrs)
+{
+	// the parser gives lower case names: take over the whole map instead of copying it attribute by attribute
+	bool lower_case = m_attrs.empty();
+	for (auto attr = attrs.begin(); attr != attrs.end() && lower_case; attr++)
+	{
+		for (tchar_t ch : attr->first)
+		{
+			if (ch != std::tolower(ch, std::locale::classic()))
+			{
+				lower_case = false;
+				break;
+			}
+		}
+	}
+	if (!lower_case)
+	{
+		element::set_attrs(std::move(attrs));
+		return;
+	}
+
+	m_attrs = std::move(attrs);
+	string_map::const_iterator cls = m_attrs.find(_t("class"));
+	if (cls != m_attrs.end())
+	{
+		m_class_values.resize(0);
+		split_string(cls->second, m_class_values, _t(" "));
+	}
+}
+
 const litehtml::tchar_t* litehtml::html_tag::get_attr(const tchar_t* name, const tchar_t* def) const
 {
 	string_map::const_iterator attr = m_attrs.find(name);
@@ -168,15 +208,23 @@ litehtml::element::ptr litehtml::html_tag::select_one(const css_selector& select
 
 void litehtml::html_tag::apply_stylesheet(const litehtml::css& stylesheet)
 {
+	LITEHTML_TRACE_SCOPE("apply_stylesheet", "style");
 	remove_before_after();
 
+	document::ptr doc = get_document();
 	for (const auto& sel : stylesheet.selectors())
 	{
+		LITEHTML_STATS_COUNT(selectors_tested);
 		int apply = select(*sel, false);
 		if (apply != select_no_match)
 		{
+			LITEHTML_STATS_COUNT(selectors_matched);
 			used_selector::ptr us = std::unique_ptr<used_selector>(new used_selector(sel, false));
-			if (sel->is_media_valid())
+			if (sel->m_media_query && doc)
+			{
+				doc->add_media_element(sel->m_media_query, shared_from_this());
+			}
+			if (sel->is_media_valid(doc.get()))
 			{
 				if (apply & select_match_pseudo_class)
 				{
@@ -292,6 +340,7 @@ litehtml::uint_ptr litehtml::html_tag::get_font(font_metrics* fm)
 
 const litehtml::tchar_t* litehtml::html_tag::get_style_property(const tchar_t* name, bool inherited, const tchar_t* def /*= 0*/)
 {
+	LITEHTML_STATS_COUNT(style_property_calls);
 	const tchar_t* ret = m_style.get_property(name);
 	element::ptr el_parent = parent();
 	if (el_parent)
@@ -308,24 +357,51 @@ const litehtml::tchar_t* litehtml::html_tag::get_style_property(const tchar_t* n
 	return ret;
 }
 
+const litehtml::property_value* litehtml::html_tag::get_style_value(const tchar_t* name, bool inherited)
+{
+	const property_value* ret = m_style.get_property_value(name);
+	element::ptr el_parent = parent();
+	if (el_parent)
+	{
+		if ((ret && !t_strcasecmp(ret->m_value.c_str(), _t("inherit"))) || (!ret && inherited))
+		{
+			ret = el_parent->get_style_value(name, inherited);
+		}
+	}
+	return ret;
+}
+
 void litehtml::html_tag::parse_styles(bool is_reparse)
 {
+	LITEHTML_TRACE_SCOPE("parse_styles", "style");
+	m_inline_items_valid = false;
+	invalidate_out_of_flow();
+
+	document::ptr doc = get_document();
+
 	const tchar_t* style = get_attr(_t("style"));
 	if (style)
 	{
-		m_style.add(style, NULL);
+		// identical style attributes are parsed only once per document
+		if (doc)
+		{
+			m_style.combine(*doc->get_inline_style(style));
+		}
+		else
+		{
+			m_style.add(style, NULL);
+		}
 	}
 
 	init_font();
-	document::ptr doc = get_document();
 
-	m_el_position = (element_position)value_index(get_style_property(_t("position"), false, _t("static")), element_position_strings, element_position_fixed);
-	m_text_align = (text_align)value_index(get_style_property(_t("text-align"), true, _t("left")), text_align_strings, text_align_left);
-	m_overflow = (overflow)value_index(get_style_property(_t("overflow"), false, _t("visible")), overflow_strings, overflow_visible);
-	m_white_space = (white_space)value_index(get_style_property(_t("white-space"), true, _t("normal")), white_space_strings, white_space_normal);
-	m_display = (style_display)value_index(get_style_property(_t("display"), false, _t("inline")), style_display_strings, display_inline);
-	m_visibility = (visibility)value_index(get_style_property(_t("visibility"), true, _t("visible")), visibility_strings, visibility_visible);
-	m_box_sizing = (box_sizing)value_index(get_style_property(_t("box-sizing"), false, _t("content-box")), box_sizing_strings, box_sizing_content_box);
+	m_el_position = (element_position)element_position_keywords.find(get_style_property(_t("position"), false, _t("static")), element_position_fixed);
+	m_text_align = (text_align)text_align_keywords.find(get_style_property(_t("text-align"), true, _t("left")), text_align_left);
+	m_overflow = (overflow)overflow_keywords.find(get_style_property(_t("overflow"), false, _t("visible")), overflow_visible);
+	m_white_space = (white_space)white_space_keywords.find(get_style_property(_t("white-space"), true, _t("normal")), white_space_normal);
+	m_display = (style_display)style_display_keywords.find(get_style_property(_t("display"), false, _t("inline")), display_inline);
+	m_visibility = (visibility)visibility_keywords.find(get_style_property(_t("visibility"), true, _t("visible")), visibility_visible);
+	m_box_sizing = (box_sizing)box_sizing_keywords.find(get_style_property(_t("box-sizing"), false, _t("content-box")), box_sizing_content_box);
 
 	if (m_el_position != element_position_static)
 	{
@@ -337,12 +413,12 @@ void litehtml::html_tag::parse_styles(bool is_reparse)
 	}
 
 	const tchar_t* va = get_style_property(_t("vertical-align"), true, _t("baseline"));
-	m_vertical_align = (vertical_align)value_index(va, vertical_align_strings, va_baseline);
+	m_vertical_align = (vertical_align)vertical_align_keywords.find(va, va_baseline);
 
 	const tchar_t* fl = get_style_property(_t("float"), false, _t("none"));
-	m_float = (element_float)value_index(fl, element_float_strings, float_none);
+	m_float = (element_float)element_float_keywords.find(fl, float_none);
 
-	m_clear = (element_clear)value_index(get_style_property(_t("clear"), false, _t("none")), element_clear_strings, clear_none);
+	m_clear = (element_clear)element_clear_keywords.find(get_style_property(_t("clear"), false, _t("none")), clear_none);
 
 	if (m_float != float_none)
 	{
@@ -374,34 +450,34 @@ void litehtml::html_tag::parse_styles(bool is_reparse)
 		}
 	}
 
-	m_css_text_indent.fromString(get_style_property(_t("text-indent"), true, _t("0")), _t("0"));
+	get_length(m_css_text_indent, _t("text-indent"), true, _t("0"), _t("0"));
 
-	m_css_width.fromString(get_style_property(_t("width"), false, _t("auto")), _t("auto"));
-	m_css_height.fromString(get_style_property(_t("height"), false, _t("auto")), _t("auto"));
-	m_css_depth.fromString(get_style_property(_t("depth"), false, _t("auto")), _t("auto"));
+	get_length(m_css_width, _t("width"), false, _t("auto"), _t("auto"));
+	get_length(m_css_height, _t("height"), false, _t("auto"), _t("auto"));
+	get_length(m_css_depth, _t("depth"), false, _t("auto"), _t("auto"));
 
 	doc->cvt_units(m_css_width, m_font_size);
 	doc->cvt_units(m_css_height, m_font_size);
 	doc->cvt_units(m_css_depth, m_font_size);
 
-	m_css_min_width.fromString(get_style_property(_t("min-width"), false, _t("0")));
-	m_css_min_height.fromString(get_style_property(_t("min-height"), false, _t("0")));
-	m_css_min_depth.fromString(get_style_property(_t("min-depth"), false, _t("0")));
+	get_length(m_css_min_width, _t("min-width"), false, _t("0"));
+	get_length(m_css_min_height, _t("min-height"), false, _t("0"));
+	get_length(m_css_min_depth, _t("min-depth"), false, _t("0"));
 
-	m_css_max_width.fromString(get_style_property(_t("max-width"), false, _t("none")), _t("none"));
-	m_css_max_height.fromString(get_style_property(_t("max-height"), false, _t("none")), _t("none"));
-	m_css_max_depth.fromString(get_style_property(_t("max-depth"), false, _t("none")), _t("none"));
+	get_length(m_css_max_width, _t("max-width"), false, _t("none"), _t("none"));
+	get_length(m_css_max_height, _t("max-height"), false, _t("none"), _t("none"));
+	get_length(m_css_max_depth, _t("max-depth"), false, _t("none"), _t("none"));
 
 	doc->cvt_units(m_css_min_width, m_font_size);
 	doc->cvt_units(m_css_min_height, m_font_size);
 	doc->cvt_units(m_css_min_depth, m_font_size);
 
-	m_css_offsets.left.fromString(get_style_property(_t("left"), false, _t("auto")), _t("auto"));
-	m_css_offsets.right.fromString(get_style_property(_t("right"), false, _t("auto")), _t("auto"));
-	m_css_offsets.top.fromString(get_style_property(_t("top"), false, _t("auto")), _t("auto"));
-	m_css_offsets.bottom.fromString(get_style_property(_t("bottom"), false, _t("auto")), _t("auto"));
-	m_css_offsets.front.fromString(get_style_property(_t("front"), false, _t("auto")), _t("auto"));
-	m_css_offsets.back.fromString(get_style_property(_t("back"), false, _t("auto")), _t("auto"));
+	get_length(m_css_offsets.left, _t("left"), false, _t("auto"), _t("auto"));
+	get_length(m_css_offsets.right, _t("right"), false, _t("auto"), _t("auto"));
+	get_length(m_css_offsets.top, _t("top"), false, _t("auto"), _t("auto"));
+	get_length(m_css_offsets.bottom, _t("bottom"), false, _t("auto"), _t("auto"));
+	get_length(m_css_offsets.front, _t("front"), false, _t("auto"), _t("auto"));
+	get_length(m_css_offsets.back, _t("back"), false, _t("auto"), _t("auto"));
 
 	doc->cvt_units(m_css_offsets.left, m_font_size);
 	doc->cvt_units(m_css_offsets.right, m_font_size);
@@ -410,60 +486,60 @@ void litehtml::html_tag::parse_styles(bool is_reparse)
 	doc->cvt_units(m_css_offsets.front, m_font_size);
 	doc->cvt_units(m_css_offsets.back, m_font_size);
 
-	m_css_margins.left.fromString(get_style_property(_t("margin-left"), false, _t("0")), _t("auto"));
-	m_css_margins.right.fromString(get_style_property(_t("margin-right"), false, _t("0")), _t("auto"));
-	m_css_margins.top.fromString(get_style_property(_t("margin-top"), false, _t("0")), _t("auto"));
-	m_css_margins.bottom.fromString(get_style_property(_t("margin-bottom"), false, _t("0")), _t("auto"));
-	m_css_margins.front.fromString(get_style_property(_t("margin-front"), false, _t("0")), _t("auto"));
-	m_css_margins.back.fromString(get_style_property(_t("margin-back"), false, _t("0")), _t("auto"));
+	get_length(m_css_margins.left, _t("margin-left"), false, _t("0"), _t("auto"));
+	get_length(m_css_margins.right, _t("margin-right"), false, _t("0"), _t("auto"));
+	get_length(m_css_margins.top, _t("margin-top"), false, _t("0"), _t("auto"));
+	get_length(m_css_margins.bottom, _t("margin-bottom"), false, _t("0"), _t("auto"));
+	get_length(m_css_margins.front, _t("margin-front"), false, _t("0"), _t("auto"));
+	get_length(m_css_margins.back, _t("margin-back"), false, _t("0"), _t("auto"));
 
-	m_css_padding.left.fromString(get_style_property(_t("padding-left"), false, _t("0")), _t(""));
-	m_css_padding.right.fromString(get_style_property(_t("padding-right"), false, _t("0")), _t(""));
-	m_css_padding.top.fromString(get_style_property(_t("padding-top"), false, _t("0")), _t(""));
-	m_css_padding.bottom.fromString(get_style_property(_t("padding-bottom"), false, _t("0")), _t(""));
-	m_css_padding.front.fromString(get_style_property(_t("padding-front"), false, _t("0")), _t(""));
-	m_css_padding.back.fromString(get_style_property(_t("padding-back"), false, _t("0")), _t(""));
+	get_length(m_css_padding.left, _t("padding-left"), false, _t("0"), _t(""));
+	get_length(m_css_padding.right, _t("padding-right"), false, _t("0"), _t(""));
+	get_length(m_css_padding.top, _t("padding-top"), false, _t("0"), _t(""));
+	get_length(m_css_padding.bottom, _t("padding-bottom"), false, _t("0"), _t(""));
+	get_length(m_css_padding.front, _t("padding-front"), false, _t("0"), _t(""));
+	get_length(m_css_padding.back, _t("padding-back"), false, _t("0"), _t(""));
 
-	m_css_borders.left.width.fromString(get_style_property(_t("border-left-width"), false, _t("medium")), border_width_strings);
-	m_css_borders.right.width.fromString(get_style_property(_t("border-right-width"), false, _t("medium")), border_width_strings);
-	m_css_borders.top.width.fromString(get_style_property(_t("border-top-width"), false, _t("medium")), border_width_strings);
-	m_css_borders.bottom.width.fromString(get_style_property(_t("border-bottom-width"), false, _t("medium")), border_width_strings);
-	m_css_borders.front.width.fromString(get_style_property(_t("border-front-width"), false, _t("medium")), border_width_strings);
-	m_css_borders.back.width.fromString(get_style_property(_t("border-back-width"), false, _t("medium")), border_width_strings);
+	get_length(m_css_borders.left.width, _t("border-left-width"), false, _t("medium"), border_width_strings);
+	get_length(m_css_borders.right.width, _t("border-right-width"), false, _t("medium"), border_width_strings);
+	get_length(m_css_borders.top.width, _t("border-top-width"), false, _t("medium"), border_width_strings);
+	get_length(m_css_borders.bottom.width, _t("border-bottom-width"), false, _t("medium"), border_width_strings);
+	get_length(m_css_borders.front.width, _t("border-front-width"), false, _t("medium"), border_width_strings);
+	get_length(m_css_borders.back.width, _t("border-back-width"), false, _t("medium"), border_width_strings);
 
-	m_css_borders.left.color = web_color::from_string(get_style_property(_t("border-left-color"), false, _t("")), doc->container());
-	m_css_borders.left.style = (border_style)value_index(get_style_property(_t("border-left-style"), false, _t("none")), border_style_strings, border_style_none);
+	m_css_borders.left.color = get_color(_t("border-left-color"), false, web_color(0, 0, 0));
+	m_css_borders.left.style = (border_style)border_style_keywords.find(get_style_property(_t("border-left-style"), false, _t("none")), border_style_none);
 
-	m_css_borders.right.color = web_color::from_string(get_style_property(_t("border-right-color"), false, _t("")), doc->container());
-	m_css_borders.right.style = (border_style)value_index(get_style_property(_t("border-right-style"), false, _t("none")), border_style_strings, border_style_none);
+	m_css_borders.right.color = get_color(_t("border-right-color"), false, web_color(0, 0, 0));
+	m_css_borders.right.style = (border_style)border_style_keywords.find(get_style_property(_t("border-right-style"), false, _t("none")), border_style_none);
 
-	m_css_borders.top.color = web_color::from_string(get_style_property(_t("border-top-color"), false, _t("")), doc->container());
-	m_css_borders.top.style = (border_style)value_index(get_style_property(_t("border-top-style"), false, _t("none")), border_style_strings, border_style_none);
+	m_css_borders.top.color = get_color(_t("border-top-color"), false, web_color(0, 0, 0));
+	m_css_borders.top.style = (border_style)border_style_keywords.find(get_style_property(_t("border-top-style"), false, _t("none")), border_style_none);
 
-	m_css_borders.bottom.color = web_color::from_string(get_style_property(_t("border-bottom-color"), false, _t("")), doc->container());
-	m_css_borders.bottom.style = (border_style)value_index(get_style_property(_t("border-bottom-style"), false, _t("none")), border_style_strings, border_style_none);
+	m_css_borders.bottom.color = get_color(_t("border-bottom-color"), false, web_color(0, 0, 0));
+	m_css_borders.bottom.style = (border_style)border_style_keywords.find(get_style_property(_t("border-bottom-style"), false, _t("none")), border_style_none);
 
-	m_css_borders.front.color = web_color::from_string(get_style_property(_t("border-front-color"), false, _t("")), doc->container());
-	m_css_borders.front.style = (border_style)value_index(get_style_property(_t("border-front-style"), false, _t("none")), border_style_strings, border_style_none);
+	m_css_borders.front.color = get_color(_t("border-front-color"), false, web_color(0, 0, 0));
+	m_css_borders.front.style = (border_style)border_style_keywords.find(get_style_property(_t("border-front-style"), false, _t("none")), border_style_none);
 
-	m_css_borders.back.color = web_color::from_string(get_style_property(_t("border-back-color"), false, _t("")), doc->container());
-	m_css_borders.back.style = (border_style)value_index(get_style_property(_t("border-back-style"), false, _t("none")), border_style_strings, border_style_none);
+	m_css_borders.back.color = get_color(_t("border-back-color"), false, web_color(0, 0, 0));
+	m_css_borders.back.style = (border_style)border_style_keywords.find(get_style_property(_t("border-back-style"), false, _t("none")), border_style_none);
 
-	m_css_borders.radius.top_left_x.fromString(get_style_property(_t("border-top-left-radius-x"), false, _t("0")));
-	m_css_borders.radius.top_left_y.fromString(get_style_property(_t("border-top-left-radius-y"), false, _t("0")));
-	m_css_borders.radius.top_left_z.fromString(get_style_property(_t("border-top-left-radius-z"), false, _t("0")));
+	get_length(m_css_borders.radius.top_left_x, _t("border-top-left-radius-x"), false, _t("0"));
+	get_length(m_css_borders.radius.top_left_y, _t("border-top-left-radius-y"), false, _t("0"));
+	get_length(m_css_borders.radius.top_left_z, _t("border-top-left-radius-z"), false, _t("0"));
 
-	m_css_borders.radius.top_right_x.fromString(get_style_property(_t("border-top-right-radius-x"), false, _t("0")));
-	m_css_borders.radius.top_right_y.fromString(get_style_property(_t("border-top-right-radius-y"), false, _t("0")));
-	m_css_borders.radius.top_right_z.fromString(get_style_property(_t("border-top-right-radius-z"), false, _t("0")));
+	get_length(m_css_borders.radius.top_right_x, _t("border-top-right-radius-x"), false, _t("0"));
+	get_length(m_css_borders.radius.top_right_y, _t("border-top-right-radius-y"), false, _t("0"));
+	get_length(m_css_borders.radius.top_right_z, _t("border-top-right-radius-z"), false, _t("0"));
 
-	m_css_borders.radius.bottom_right_x.fromString(get_style_property(_t("border-bottom-right-radius-x"), false, _t("0")));
-	m_css_borders.radius.bottom_right_y.fromString(get_style_property(_t("border-bottom-right-radius-y"), false, _t("0")));
-	m_css_borders.radius.bottom_right_z.fromString(get_style_property(_t("border-bottom-right-radius-z"), false, _t("0")));
+	get_length(m_css_borders.radius.bottom_right_x, _t("border-bottom-right-radius-x"), false, _t("0"));
+	get_length(m_css_borders.radius.bottom_right_y, _t("border-bottom-right-radius-y"), false, _t("0"));
+	get_length(m_css_borders.radius.bottom_right_z, _t("border-bottom-right-radius-z"), false, _t("0"));
 
-	m_css_borders.radius.bottom_left_x.fromString(get_style_property(_t("border-bottom-left-radius-x"), false, _t("0")));
-	m_css_borders.radius.bottom_left_y.fromString(get_style_property(_t("border-bottom-left-radius-y"), false, _t("0")));
-	m_css_borders.radius.bottom_left_z.fromString(get_style_property(_t("border-bottom-left-radius-z"), false, _t("0")));
+	get_length(m_css_borders.radius.bottom_left_x, _t("border-bottom-left-radius-x"), false, _t("0"));
+	get_length(m_css_borders.radius.bottom_left_y, _t("border-bottom-left-radius-y"), false, _t("0"));
+	get_length(m_css_borders.radius.bottom_left_z, _t("border-bottom-left-radius-z"), false, _t("0"));
 
 	doc->cvt_units(m_css_borders.radius.bottom_left_x, m_font_size);
 	doc->cvt_units(m_css_borders.radius.bottom_left_y, m_font_size);
@@ -502,7 +578,7 @@ void litehtml::html_tag::parse_styles(bool is_reparse)
 	m_borders.back = doc->cvt_units(m_css_borders.back.width, m_font_size);
 
 	css_length line_height;
-	line_height.fromString(get_style_property(_t("line-height"), true, _t("normal")), _t("normal"));
+	get_length(line_height, _t("line-height"), true, _t("normal"), _t("normal"));
 	if (line_height.is_predefined())
 	{
 		m_line_height = m_font_metrics.height;
@@ -522,10 +598,10 @@ void litehtml::html_tag::parse_styles(bool is_reparse)
 	if (m_display == display_list_item)
 	{
 		const tchar_t* list_type = get_style_property(_t("list-style-type"), true, _t("disc"));
-		m_list_style_type = (list_style_type)value_index(list_type, list_style_type_strings, list_style_type_disc);
+		m_list_style_type = (list_style_type)list_style_type_keywords.find(list_type, list_style_type_disc);
 
 		const tchar_t* list_pos = get_style_property(_t("list-style-position"), true, _t("outside"));
-		m_list_style_position = (list_style_position)value_index(list_pos, list_style_position_strings, list_style_position_outside);
+		m_list_style_position = (list_style_position)list_style_position_keywords.find(list_pos, list_style_position_outside);
 
 		const tchar_t* list_image = get_style_property(_t("list-style-image"), true, 0);
 		if (list_image && list_image[0])
@@ -551,6 +627,11 @@ void litehtml::html_tag::parse_styles(bool is_reparse)
 
 int litehtml::html_tag::render(int x, int y, int z, int max_width, bool second_pass)
 {
+	LITEHTML_STATS_COUNT(render_calls);
+	if (second_pass)
+	{
+		LITEHTML_STATS_COUNT(second_pass_renders);
+	}
 	if (m_display == display_table || m_display == display_inline_table)
 	{
 		return render_table(x, y, z, max_width, second_pass);
@@ -596,6 +677,30 @@ void litehtml::html_tag::init()
 			m_grid = std::unique_ptr<table_grid>(new table_grid());
 		}
 
+		for (auto& el : m_children)
+		{
+			if (el->get_display() == display_table_column)
+			{
+				m_grid->add_column(el);
+			}
+			else if (el->get_display() == display_table_column_group)
+			{
+				bool has_columns = false;
+				for (auto& col : el->m_children)
+				{
+					if (col->get_display() == display_table_column)
+					{
+						m_grid->add_column(col);
+						has_columns = true;
+					}
+				}
+				if (!has_columns)
+				{
+					m_grid->add_column(el);
+				}
+			}
+		}
+
 		go_inside_table 		table_selector;
 		table_rows_selector		row_selector;
 		table_cells_selector	cell_selector;
@@ -857,7 +962,7 @@ int litehtml::html_tag::select(const css_element_selector& selector, bool apply_
 					selector_name = i->val;
 				}
 
-				int selector = value_index(selector_name.c_str(), pseudo_class_strings);
+				int selector = pseudo_class_keywords.find(selector_name);
 
 				switch (selector)
 				{
@@ -1646,24 +1751,20 @@ void litehtml::html_tag::parse_background()
 	doc->cvt_units(m_bg.m_position.depth, m_font_size);
 
 	// parse background_attachment
-	m_bg.m_attachment = (background_attachment)value_index(
-		get_style_property(_t("background-attachment"), false, _t("scroll")),
-		background_attachment_strings, background_attachment_scroll);
+	m_bg.m_attachment = (background_attachment)background_attachment_keywords.find(
+		get_style_property(_t("background-attachment"), false, _t("scroll")), background_attachment_scroll);
 
 	// parse background_attachment
-	m_bg.m_repeat = (background_repeat)value_index(
-		get_style_property(_t("background-repeat"), false, _t("repeat")),
-		background_repeat_strings, background_repeat_repeat);
+	m_bg.m_repeat = (background_repeat)background_repeat_keywords.find(
+		get_style_property(_t("background-repeat"), false, _t("repeat")), background_repeat_repeat);
 
 	// parse background_clip
-	m_bg.m_clip = (background_box)value_index(
-		get_style_property(_t("background-clip"), false, _t("border-box")),
-		background_box_strings, background_box_border);
+	m_bg.m_clip = (background_box)background_box_keywords.find(
+		get_style_property(_t("background-clip"), false, _t("border-box")), background_box_border);
 
 	// parse background_origin
-	m_bg.m_origin = (background_box)value_index(
-		get_style_property(_t("background-origin"), false, _t("padding-box")),
-		background_box_strings, background_box_content);
+	m_bg.m_origin = (background_box)background_box_keywords.find(
+		get_style_property(_t("background-origin"), false, _t("padding-box")), background_box_content);
 
 	// parse background-image
 	css::parse_css_url(get_style_property(_t("background-image"), false, _t("")), m_bg.m_image);
@@ -1870,9 +1971,10 @@ bool litehtml::html_tag::find_styles_changes(position::vector& redraw_boxes, int
 
 	bool ret = false;
 	bool apply = false;
+	document::ptr doc = get_document();
 	for (used_selector::vector::iterator iter = m_used_styles.begin(); iter != m_used_styles.end() && !apply; iter++)
 	{
-		if ((*iter)->m_selector->is_media_valid())
+		if ((*iter)->m_selector->is_media_valid(doc.get()))
 		{
 			int res = select(*((*iter)->m_selector), true);
 			if ((res == select_no_match && (*iter)->m_used) || (res == select_match && !(*iter)->m_used))
@@ -2147,6 +2249,7 @@ void litehtml::html_tag::draw_background(uint_ptr hdc, int x, int y, int z, cons
 				background_paint bg_paint;
 				init_background_paint(pos, bg_paint, bg);
 
+				LITEHTML_STATS_COUNT(draw_calls);
 				get_document()->container()->draw_background(hdc, bg_paint);
 			}
 			position border_box = pos;
@@ -2155,6 +2258,7 @@ void litehtml::html_tag::draw_background(uint_ptr hdc, int x, int y, int z, cons
 
 			borders bdr = m_css_borders;
 			bdr.radius = m_css_borders.radius.calc_percents(border_box.width, border_box.height, border_box.depth);
+			LITEHTML_STATS_COUNT(draw_calls);
 			get_document()->container()->draw_borders(hdc, bdr, border_box, have_parent() ? false : true);
 		}
 	}
@@ -2222,10 +2326,12 @@ void litehtml::html_tag::draw_background(uint_ptr hdc, int x, int y, int z, cons
 				if (bg)
 				{
 					bg_paint.border_radius = bdr.radius.calc_percents(bg_paint.border_box.width, bg_paint.border_box.width, bg_paint.border_box.depth);
+					LITEHTML_STATS_COUNT(draw_calls);
 					get_document()->container()->draw_background(hdc, bg_paint);
 				}
 				borders b = bdr;
 				b.radius = bdr.radius.calc_percents(box->width, box->height, box->depth);
+				LITEHTML_STATS_COUNT(draw_calls);
 				get_document()->container()->draw_borders(hdc, b, *box, false);
 			}
 		}
@@ -2512,7 +2618,7 @@ int litehtml::html_tag::place_element(const element::ptr &el, int max_width)
 			{
 				ret_width = el->render(line_ctx.left, line_ctx.top, line_ctx.front, line_ctx.width()) + line_ctx.left + (max_width - line_ctx.right);
 			}
-			else
+			else if (!render_deferred(el, line_ctx.top, line_ctx.front, max_width))
 			{
 				ret_width = el->render(0, line_ctx.top, line_ctx.front, max_width);
 			}
@@ -2533,6 +2639,264 @@ int litehtml::html_tag::place_element(const element::ptr &el, int max_width)
 	return ret_width;
 }
 
+bool litehtml::html_tag::update_inline_items()
+{
+	// only text nodes are inline text, so the result changes with the children and the fonts
+	if (m_inline_items_valid && m_inline_items_generation == m_children_generation)
+	{
+		return m_inline_run;
+	}
+
+	m_inline_items.clear();
+	m_inline_items_valid = true;
+	m_inline_items_generation = m_children_generation;
+	m_inline_run = false;
+	for (const auto& el : m_children)
+	{
+		if (el->get_display() != display_inline_text)
+		{
+			m_inline_items.clear();
+			return false;
+		}
+	}
+	for (const auto& el : m_children)
+	{
+		size sz;
+		el->get_content_size(sz, 0);
+		el->m_pos = sz;
+		m_inline_items.push_back(line_box_item(el.get()));
+	}
+	m_inline_run = !m_inline_items.empty();
+	return m_inline_run;
+}
+
+int litehtml::html_tag::place_inline_item(const element::ptr& el, const line_box_item& item, int max_width)
+{
+	el->m_pos.width = item.width;
+	el->m_pos.height = item.height;
+
+	if (!m_boxes.empty() && m_boxes.back()->get_type() == box_line)
+	{
+		line_box* lb = static_cast<line_box*>(m_boxes.back().get());
+		if (lb->can_hold(item, m_white_space))
+		{
+			lb->add_item(item);
+			if (!el->skip())
+			{
+				return el->right() + (max_width - lb->line_right());
+			}
+			return 0;
+		}
+	}
+	return place_element(el, max_width);
+}
+
+// Floats are registered with the floats holder and positioned elements are placed by
+// render_positioned() of their containing block or drawn by its stacking context, both only
+// when the block is rendered. The results are kept until the styles or the children of the
+// element or a descendant change.
+bool litehtml::html_tag::has_out_of_flow()
+{
+	update_out_of_flow();
+	return m_has_out_of_flow;
+}
+
+bool litehtml::html_tag::has_positioned()
+{
+	update_out_of_flow();
+	return m_has_positioned;
+}
+
+void litehtml::html_tag::update_out_of_flow()
+{
+	if (m_out_of_flow_valid)
+	{
+		return;
+	}
+	// every child is asked, so the descendants of an element with valid results have them too
+	m_has_out_of_flow = element::has_out_of_flow();
+	m_has_positioned = element::has_positioned();
+	for (auto& el : m_children)
+	{
+		if (el->has_out_of_flow())
+		{
+			m_has_out_of_flow = true;
+		}
+		if (el->has_positioned())
+		{
+			m_has_positioned = true;
+		}
+	}
+	m_out_of_flow_valid = true;
+}
+
+void litehtml::html_tag::children_changed()
+{
+	m_children_generation++;
+	invalidate_out_of_flow();
+}
+
+void litehtml::html_tag::invalidate_out_of_flow()
+{
+	// invalid results have no valid ones above them
+	for (element::ptr el = shared_from_this(); el; el = el->parent())
+	{
+		html_tag* tag = dynamic_cast<html_tag*>(el.get());
+		if (!tag || !tag->m_out_of_flow_valid)
+		{
+			break;
+		}
+		tag->m_out_of_flow_valid = false;
+	}
+}
+
+bool litehtml::html_tag::render_deferred(const element::ptr& el, int top, int z, int max_width)
+{
+	el->m_deferred = false;
+
+	// only the blocks of <body> are laid out lazily
+	element::ptr el_parent = parent();
+	if (!el_parent || el_parent->have_parent())
+	{
+		return false;
+	}
+
+	document::ptr doc = get_document();
+
+	// the previous block is already laid out, its height is used to estimate the deferred blocks
+	if (m_boxes.size() > 1 && m_boxes[m_boxes.size() - 2]->get_type() == box_block)
+	{
+		elements_vector els;
+		m_boxes[m_boxes.size() - 2]->get_elements(els);
+		if (!els.empty() && !els.front()->m_deferred)
+		{
+			doc->add_layout_sample(els.front()->m_pos.height);
+		}
+	}
+
+	// the height of the previous layout is the best estimate
+	int height = el->m_pos.height;
+	if (!height)
+	{
+		height = doc->get_estimated_height(el->line_height());
+	}
+
+	int el_top = get_placement().y + top;
+	if (!doc->is_layout_deferred(el_top, el_top + height) || el->has_out_of_flow() || el->has_positioned())
+	{
+		return false;
+	}
+
+	el->calc_outlines(max_width);
+	el->m_pos.clear();
+	el->m_pos.move_to(0, top, z);
+	el->m_pos.x += el->content_margins_left();
+	el->m_pos.y += el->content_margins_top();
+	el->m_pos.z += el->content_margins_front();
+	el->m_pos.width = max_width - el->content_margins_left() - el->content_margins_right();
+	el->m_pos.height = height;
+	el->m_deferred = true;
+	return true;
+}
+
+int litehtml::html_tag::realize_deferred(int top, int bottom)
+{
+	int shift = 0;
+	elements_vector els;
+	for (auto& box : m_boxes)
+	{
+		if (shift)
+		{
+			box->y_shift(shift);
+		}
+		if (box->get_type() != box_block)
+		{
+			continue;
+		}
+		els.clear();
+		box->get_elements(els);
+		for (auto& el : els)
+		{
+			if (el->m_deferred && el->top() < bottom && el->bottom() > top)
+			{
+				int old_height = el->height();
+				el->m_deferred = false;
+				el->render(0, box->top(), el->m_pos.z - el->content_margins_front(), m_pos.width);
+				el->apply_relative_shift(m_pos.width);
+				get_document()->add_layout_sample(el->m_pos.height);
+				shift += el->height() - old_height;
+			}
+		}
+	}
+	if (shift)
+	{
+		m_pos.height += shift;
+	}
+	return shift;
+}
+
+int litehtml::html_tag::relayout_dirty(int& top)
+{
+	// only the dirty blocks are laid out again, the boxes below them are moved by the height difference
+	int shift = 0;
+	elements_vector els;
+	for (auto& box : m_boxes)
+	{
+		if (shift)
+		{
+			box->y_shift(shift);
+		}
+		if (box->get_type() != box_block)
+		{
+			continue;
+		}
+		els.clear();
+		box->get_elements(els);
+		for (auto& el : els)
+		{
+			if (!el->m_layout_dirty)
+			{
+				continue;
+			}
+			el->clear_layout_dirty();
+			// a deferred block gets the new layout when it is realized
+			if (!el->m_deferred)
+			{
+				int old_height = el->height();
+				el->render(0, box->top(), el->m_pos.z - el->content_margins_front(), m_pos.width);
+				el->apply_relative_shift(m_pos.width);
+				top = std::min(top, box->top());
+				shift += el->height() - old_height;
+			}
+		}
+	}
+	if (shift)
+	{
+		m_pos.height += shift;
+	}
+	return shift;
+}
+
+void litehtml::html_tag::add_memory_usage(document_memory_usage& usage) const
+{
+	element::add_memory_usage(usage);
+	usage.elements += sizeof(html_tag) - sizeof(element) + string_memory(m_tag) + vector_memory(m_positioned);
+	usage.elements += string_vector_memory(m_class_values) + string_vector_memory(m_pseudo_classes);
+	usage.attributes += string_map_memory(m_attrs);
+	usage.styles += m_style.memory_size();
+	usage.selectors += vector_memory(m_used_styles) + m_used_styles.size() * sizeof(used_selector);
+
+	usage.boxes += vector_memory(m_boxes) + vector_memory(m_inline_items) + vector_memory(m_floats_left) + vector_memory(m_floats_right);
+	for (const auto& bx : m_boxes)
+	{
+		usage.boxes += bx->memory_size();
+	}
+	if (m_grid)
+	{
+		usage.boxes += m_grid->memory_size();
+	}
+}
+
 bool litehtml::html_tag::set_pseudo_class(const tchar_t* pclass, bool add)
 {
 	bool ret = false;
@@ -3109,6 +3473,7 @@ void litehtml::html_tag::draw_list_marker(uint_ptr hdc, const position &pos)
 
 	lm.color = get_color(_t("color"), true, web_color(0, 0, 0));
 	lm.marker_type = m_list_style_type;
+	LITEHTML_STATS_COUNT(draw_calls);
 	get_document()->container()->draw_list_marker(hdc, lm);
 }
 
@@ -3156,6 +3521,7 @@ int litehtml::html_tag::get_zindex() const
 
 void litehtml::html_tag::render_positioned(render_type rt)
 {
+	LITEHTML_TRACE_SCOPE("render_positioned", "layout");
 	position wnd_position;
 	get_document()->container()->get_client_rect(wnd_position);
 
@@ -3434,7 +3800,8 @@ void litehtml::html_tag::render_positioned(render_type rt)
 
 void litehtml::html_tag::draw_stacking_context(uint_ptr hdc, int x, int y, int z, const position* clip, bool with_positioned)
 {
-	if (!is_visible()) return;
+	LITEHTML_TRACE_SCOPE("draw_stacking_context", "paint");
+	if (!is_visible() || m_deferred) return;
 
 	std::map<int, bool> zindexes;
 	if (with_positioned)
@@ -3588,7 +3955,7 @@ void litehtml::html_tag::calc_document_size(litehtml::size& sz, int x /*= 0*/, i
 	{
 		element::calc_document_size(sz, x, y, z);
 
-		if (m_overflow == overflow_visible)
+		if (m_overflow == overflow_visible && !m_deferred)
 		{
 			for (auto& el : m_children)
 			{
@@ -3770,6 +4137,7 @@ void litehtml::html_tag::remove_before_after()
 		if (!t_strcmp(m_children.front()->get_tagName(), _t("::before")))
 		{
 			m_children.erase(m_children.begin());
+			children_changed();
 		}
 	}
 	if (!m_children.empty())
@@ -3777,6 +4145,7 @@ void litehtml::html_tag::remove_before_after()
 		if (!t_strcmp(m_children.back()->get_tagName(), _t("::after")))
 		{
 			m_children.erase(m_children.end() - 1);
+			children_changed();
 		}
 	}
 }
@@ -3793,6 +4162,7 @@ litehtml::element::ptr litehtml::html_tag::get_element_before()
 	element::ptr el = std::make_shared<el_before>(get_document());
 	el->parent(shared_from_this());
 	m_children.insert(m_children.begin(), el);
+	children_changed();
 	return el;
 }
 
@@ -3844,10 +4214,11 @@ void litehtml::html_tag::refresh_styles()
 
 	m_style.clear();
 
+	document::ptr doc = get_document();
 	for (auto& usel : m_used_styles)
 	{
 		usel->m_used = false;
-		if (usel->m_selector->is_media_valid())
+		if (usel->m_selector->is_media_valid(doc.get()))
 		{
 			int apply = select(*usel->m_selector, false);
 			if (apply != select_no_match)
@@ -3924,7 +4295,7 @@ litehtml::element::ptr litehtml::html_tag::get_child_by_point(int x, int y, int
 	for (elements_vector::reverse_iterator i = m_children.rbegin(); i != m_children.rend() && !ret; i++)
 	{
 		element::ptr el = (*i);
-		if (el->is_visible() && el->get_display() != display_inline_text)
+		if (el->is_visible() && !el->m_deferred && el->get_display() != display_inline_text)
 		{
 			switch (flag)
 			{
@@ -4018,7 +4389,13 @@ litehtml::element::ptr litehtml::html_tag::get_child_by_point(int x, int y, int
 
 litehtml::element::ptr litehtml::html_tag::get_element_by_point(int x, int y, int z, int client_x, int client_y, int client_z)
 {
-	if (!is_visible()) return 0;
+	if (!is_visible() || m_deferred) return 0;
+
+	// hit testing starts at the root, the deferred blocks under the point are laid out first
+	if (!have_parent())
+	{
+		get_document()->realize_layout(position(x, y, z, 1, 1, 1));
+	}
 
 	element::ptr ret;
 	std::map<int, bool> zindexes;
@@ -4126,6 +4503,7 @@ const litehtml::background* litehtml::html_tag::get_background(bool own_only)
 
 int litehtml::html_tag::render_box(int x, int y, int z, int max_width, bool second_pass /*= false*/)
 {
+	LITEHTML_TRACE_SCOPE("render_box", "layout");
 	int parent_width = max_width;
 	calc_outlines(parent_width);
 
@@ -4199,10 +4577,16 @@ int litehtml::html_tag::render_box(int x, int y, int z, int max_width, bool seco
 		skip_spaces = true;
 	}
 
+	// the children of a plain text paragraph are placed using the cached measurements
+	bool inline_run = update_inline_items();
+	size_t item_idx = 0;
+
 	bool was_space = false;
 	element_position el_position;
-	for (auto el : m_children)
+	for (const auto& el : m_children)
 	{
+		const line_box_item* item = inline_run ? &m_inline_items[item_idx++] : nullptr;
+
 		// we don't need process absolute and fixed positioned element on the second pass
 		if (second_pass)
 		{
@@ -4213,7 +4597,7 @@ int litehtml::html_tag::render_box(int x, int y, int z, int max_width, bool seco
 		// skip spaces to make rendering a bit faster
 		if (skip_spaces)
 		{
-			if (el->is_white_space())
+			if (item ? item->is_white_space : el->is_white_space())
 			{
 				if (was_space)
 				{
@@ -4232,7 +4616,7 @@ int litehtml::html_tag::render_box(int x, int y, int z, int max_width, bool seco
 		}
 
 		// place element into rendering flow
-		int rw = place_element(el, max_width);
+		int rw = item ? place_inline_item(el, *item, max_width) : place_element(el, max_width);
 		if (rw > ret_width)
 		{
 			ret_width = rw;
@@ -4423,6 +4807,7 @@ int litehtml::html_tag::render_box(int x, int y, int z, int max_width, bool seco
 
 int litehtml::html_tag::render_table(int x, int y, int z, int max_width, bool second_pass /*= false*/)
 {
+	LITEHTML_TRACE_SCOPE("render_table", "layout");
 	if (!m_grid) return 0;
 
 	int parent_width = max_width;
@@ -4469,118 +4854,135 @@ int litehtml::html_tag::render_table(int x, int y, int z, int max_width, bool se
 		}
 	}
 
-	// Calculate the minimum content width (MCW) of each cell: the formatted content may span any number of lines but may not overflow the cell box. 
-	// If the specified 'width' (W) of the cell is greater than MCW, W is the minimum cell width. A value of 'auto' means that MCW is the minimum 
-	// cell width.
-	// 
-	// Also, calculate the "maximum" cell width of each cell: formatting the content without breaking lines other than where explicit line breaks occur.
+	int table_width = 0;
+	int min_table_width = 0;
+	int max_table_width = 0;
+
+	// A table with 'width: auto' uses the automatic layout even with 'table-layout: fixed' (CSS 2.1 17.5.2.1)
+	bool fixed_layout = m_table_layout == table_layout_fixed && !m_css_width.is_predefined();
 
-	if (m_grid->cols_count() == 1 && !block_width.is_default())
+	if (fixed_layout)
 	{
-		for (int row = 0; row < m_grid->rows_count(); row++)
-		{
-			table_cell* cell = m_grid->cell(0, row);
-			if (cell && cell->el)
-			{
-				cell->min_width = cell->max_width = cell->el->render(0, 0, 0, max_width - table_width_spacing);
-				cell->el->m_pos.width = cell->min_width - cell->el->content_margins_left() - cell->el->content_margins_right();
-			}
-		}
+		// The fixed table layout does not depend on the cell contents: the column widths are taken from the <col> elements
+		// and the first row, so each cell is rendered only once with its final width.
+		table_width = m_grid->calc_fixed_table_width(block_width - table_width_spacing);
+		min_table_width = max_table_width = table_width;
 	}
 	else
 	{
-		for (int row = 0; row < m_grid->rows_count(); row++)
+		// Calculate the minimum content width (MCW) of each cell: the formatted content may span any number of lines but may not overflow the cell box. 
+		// If the specified 'width' (W) of the cell is greater than MCW, W is the minimum cell width. A value of 'auto' means that MCW is the minimum 
+		// cell width.
+		// 
+		// Also, calculate the "maximum" cell width of each cell: formatting the content without breaking lines other than where explicit line breaks occur.
+
+		if (m_grid->cols_count() == 1 && !block_width.is_default())
 		{
-			for (int col = 0; col < m_grid->cols_count(); col++)
+			for (int row = 0; row < m_grid->rows_count(); row++)
 			{
-				table_cell* cell = m_grid->cell(col, row);
+				table_cell* cell = m_grid->cell(0, row);
 				if (cell && cell->el)
 				{
-					if (!m_grid->column(col).css_width.is_predefined() && m_grid->column(col).css_width.units() != css_units_percentage)
-					{
-						int css_w = m_grid->column(col).css_width.calc_percent(block_width);
-						int el_w = cell->el->render(0, 0, 0, css_w);
-						cell->min_width = cell->max_width = std::max(css_w, el_w);
-						cell->el->m_pos.width = cell->min_width - cell->el->content_margins_left() - cell->el->content_margins_right();
-					}
-					else
+					LITEHTML_STATS_COUNT(table_min_max_renders);
+					cell->min_width = cell->max_width = cell->el->render(0, 0, 0, max_width - table_width_spacing);
+					cell->el->m_pos.width = cell->min_width - cell->el->content_margins_left() - cell->el->content_margins_right();
+				}
+			}
+		}
+		else
+		{
+			for (int row = 0; row < m_grid->rows_count(); row++)
+			{
+				for (int col = 0; col < m_grid->cols_count(); col++)
+				{
+					table_cell* cell = m_grid->cell(col, row);
+					if (cell && cell->el)
 					{
-						// calculate minimum content width
-						cell->min_width = cell->el->render(0, 0, 0, 1);
-						// calculate maximum content width
-						cell->max_width = cell->el->render(0, 0, 0, max_width - table_width_spacing);
+						if (!m_grid->column(col).css_width.is_predefined() && m_grid->column(col).css_width.units() != css_units_percentage)
+						{
+							int css_w = m_grid->column(col).css_width.calc_percent(block_width);
+							LITEHTML_STATS_COUNT(table_min_max_renders);
+							int el_w = cell->el->render(0, 0, 0, css_w);
+							cell->min_width = cell->max_width = std::max(css_w, el_w);
+							cell->el->m_pos.width = cell->min_width - cell->el->content_margins_left() - cell->el->content_margins_right();
+						}
+						else
+						{
+							// calculate minimum content width
+							LITEHTML_STATS_COUNT(table_min_max_renders);
+							cell->min_width = cell->el->render(0, 0, 0, 1);
+							// calculate maximum content width
+							LITEHTML_STATS_COUNT(table_min_max_renders);
+							cell->max_width = cell->el->render(0, 0, 0, max_width - table_width_spacing);
+						}
 					}
 				}
 			}
 		}
-	}
 
-	// For each column, determine a maximum and minimum column width from the cells that span only that column. 
-	// The minimum is that required by the cell with the largest minimum cell width (or the column 'width', whichever is larger). 
-	// The maximum is that required by the cell with the largest maximum cell width (or the column 'width', whichever is larger).
+		// For each column, determine a maximum and minimum column width from the cells that span only that column. 
+		// The minimum is that required by the cell with the largest minimum cell width (or the column 'width', whichever is larger). 
+		// The maximum is that required by the cell with the largest maximum cell width (or the column 'width', whichever is larger).
 
-	for (int col = 0; col < m_grid->cols_count(); col++)
-	{
-		m_grid->column(col).max_width = 0;
-		m_grid->column(col).min_width = 0;
-		for (int row = 0; row < m_grid->rows_count(); row++)
+		for (int col = 0; col < m_grid->cols_count(); col++)
 		{
-			if (m_grid->cell(col, row)->colspan <= 1)
+			m_grid->column(col).max_width = 0;
+			m_grid->column(col).min_width = 0;
+			for (int row = 0; row < m_grid->rows_count(); row++)
 			{
-				m_grid->column(col).max_width = std::max(m_grid->column(col).max_width, m_grid->cell(col, row)->max_width);
-				m_grid->column(col).min_width = std::max(m_grid->column(col).min_width, m_grid->cell(col, row)->min_width);
+				if (m_grid->cell(col, row)->colspan <= 1)
+				{
+					m_grid->column(col).max_width = std::max(m_grid->column(col).max_width, m_grid->cell(col, row)->max_width);
+					m_grid->column(col).min_width = std::max(m_grid->column(col).min_width, m_grid->cell(col, row)->min_width);
+				}
 			}
 		}
-	}
 
-	// For each cell that spans more than one column, increase the minimum widths of the columns it spans so that together, 
-	// they are at least as wide as the cell. Do the same for the maximum widths. 
-	// If possible, widen all spanned columns by approximately the same amount.
+		// For each cell that spans more than one column, increase the minimum widths of the columns it spans so that together, 
+		// they are at least as wide as the cell. Do the same for the maximum widths. 
+		// If possible, widen all spanned columns by approximately the same amount.
 
-	for (int col = 0; col < m_grid->cols_count(); col++)
-	{
-		for (int row = 0; row < m_grid->rows_count(); row++)
+		for (int col = 0; col < m_grid->cols_count(); col++)
 		{
-			if (m_grid->cell(col, row)->colspan > 1)
+			for (int row = 0; row < m_grid->rows_count(); row++)
 			{
-				int max_total_width = m_grid->column(col).max_width;
-				int min_total_width = m_grid->column(col).min_width;
-				for (int col2 = col + 1; col2 < col + m_grid->cell(col, row)->colspan; col2++)
-				{
-					max_total_width += m_grid->column(col2).max_width;
-					min_total_width += m_grid->column(col2).min_width;
-				}
-				if (min_total_width < m_grid->cell(col, row)->min_width)
-				{
-					m_grid->distribute_min_width(m_grid->cell(col, row)->min_width - min_total_width, col, col + m_grid->cell(col, row)->colspan - 1);
-				}
-				if (max_total_width < m_grid->cell(col, row)->max_width)
+				if (m_grid->cell(col, row)->colspan > 1)
 				{
-					m_grid->distribute_max_width(m_grid->cell(col, row)->max_width - max_total_width, col, col + m_grid->cell(col, row)->colspan - 1);
+					int max_total_width = m_grid->column(col).max_width;
+					int min_total_width = m_grid->column(col).min_width;
+					for (int col2 = col + 1; col2 < col + m_grid->cell(col, row)->colspan; col2++)
+					{
+						max_total_width += m_grid->column(col2).max_width;
+						min_total_width += m_grid->column(col2).min_width;
+					}
+					if (min_total_width < m_grid->cell(col, row)->min_width)
+					{
+						m_grid->distribute_min_width(m_grid->cell(col, row)->min_width - min_total_width, col, col + m_grid->cell(col, row)->colspan - 1);
+					}
+					if (max_total_width < m_grid->cell(col, row)->max_width)
+					{
+						m_grid->distribute_max_width(m_grid->cell(col, row)->max_width - max_total_width, col, col + m_grid->cell(col, row)->colspan - 1);
+					}
 				}
 			}
 		}
-	}
 
-	// If the 'table' or 'inline-table' element's 'width' property has a computed value (W) other than 'auto', the used width is the 
-	// greater of W, CAPMIN, and the minimum width required by all the columns plus cell spacing or borders (MIN). 
-	// If the used width is greater than MIN, the extra width should be distributed over the columns.
-	//
-	// If the 'table' or 'inline-table' element has 'width: auto', the used width is the greater of the table's containing block width, 
-	// CAPMIN, and MIN. However, if either CAPMIN or the maximum width required by the columns plus cell spacing or borders (MAX) is 
-	// less than that of the containing block, use max(MAX, CAPMIN).
-
-	int table_width = 0;
-	int min_table_width = 0;
-	int max_table_width = 0;
+		// If the 'table' or 'inline-table' element's 'width' property has a computed value (W) other than 'auto', the used width is the 
+		// greater of W, CAPMIN, and the minimum width required by all the columns plus cell spacing or borders (MIN). 
+		// If the used width is greater than MIN, the extra width should be distributed over the columns.
+		//
+		// If the 'table' or 'inline-table' element has 'width: auto', the used width is the greater of the table's containing block width, 
+		// CAPMIN, and MIN. However, if either CAPMIN or the maximum width required by the columns plus cell spacing or borders (MAX) is 
+		// less than that of the containing block, use max(MAX, CAPMIN).
 
-	if (!block_width.is_default())
-	{
-		table_width = m_grid->calc_table_width(block_width - table_width_spacing, false, min_table_width, max_table_width);
-	}
-	else
-	{
-		table_width = m_grid->calc_table_width(max_width - table_width_spacing, true, min_table_width, max_table_width);
+		if (!block_width.is_default())
+		{
+			table_width = m_grid->calc_table_width(block_width - table_width_spacing, false, min_table_width, max_table_width);
+		}
+		else
+		{
+			table_width = m_grid->calc_table_width(max_width - table_width_spacing, true, min_table_width, max_table_width);
+		}
 	}
 
 	min_table_width += table_width_spacing;
@@ -4606,7 +5008,7 @@ int litehtml::html_tag::render_table(int x, int y, int z, int max_width, bool se
 				}
 				int cell_width = m_grid->column(span_col).right - m_grid->column(col).left;
 
-				if (cell->el->m_pos.width != cell_width - cell->el->content_margins_left() - cell->el->content_margins_right())
+				if (fixed_layout || cell->el->m_pos.width != cell_width - cell->el->content_margins_left() - cell->el->content_margins_right())
 				{
 					cell->el->render(m_grid->column(col).left, 0, 0, cell_width);
 					cell->el->m_pos.width = cell_width - cell->el->content_margins_left() - cell->el->content_margins_right();
@@ -4793,7 +5195,7 @@ void litehtml::html_tag::draw_children_box(uint_ptr hdc, int x, int y, int z, co
 	for (auto& item : m_children)
 	{
 		el = item;
-		if (el->is_visible())
+		if (el->is_visible() && !el->m_deferred)
 		{
 			switch (flag)
 			{
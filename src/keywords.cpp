@@ -0,0 +1,115 @@
+#include "html.h"
+#include "keywords.h"
+
+namespace
+{
+	// FNV-1a over the first length characters
+	unsigned int keyword_hash(const litehtml::tchar_t* str, int length)
+	{
+		unsigned int hash = 2166136261u;
+		for (int i = 0; i < length; i++)
+		{
+			hash ^= (unsigned int) str[i];
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+}
+
+litehtml::keyword_table::keyword_table(const tchar_t* strings, tchar_t delim)
+{
+	int count = 1;
+	for (const tchar_t* chr = strings; *chr; chr++)
+	{
+		if (*chr == delim)
+		{
+			count++;
+		}
+	}
+	unsigned int size = 8;
+	while (size < (unsigned int) count * 2)
+	{
+		size *= 2;
+	}
+	m_mask = size - 1;
+	entry empty = { nullptr, 0, 0 };
+	m_entries.resize(size, empty);
+
+	int idx = 0;
+	const tchar_t* start = strings;
+	while (true)
+	{
+		const tchar_t* end = start;
+		while (*end && *end != delim)
+		{
+			end++;
+		}
+		int length = (int) (end - start);
+		// empty items never match, the first of the duplicates wins as in value_index
+		if (length && find(start, length, -1) < 0)
+		{
+			unsigned int b = keyword_hash(start, length) & m_mask;
+			while (m_entries[b].name)
+			{
+				b = (b + 1) & m_mask;
+			}
+			m_entries[b].name = start;
+			m_entries[b].length = length;
+			m_entries[b].index = idx;
+		}
+		if (!*end)
+		{
+			break;
+		}
+		idx++;
+		start = end + 1;
+	}
+}
+
+int litehtml::keyword_table::find(const tchar_t* val, int length, int defValue) const
+{
+	if (!length)
+	{
+		return defValue;
+	}
+	unsigned int b = keyword_hash(val, length) & m_mask;
+	while (m_entries[b].name)
+	{
+		const entry& e = m_entries[b];
+		if (e.length == length && !t_strncmp(e.name, val, length))
+		{
+			return e.index;
+		}
+		b = (b + 1) & m_mask;
+	}
+	return defValue;
+}
+
+const litehtml::keyword_table litehtml::style_display_keywords(style_display_strings);
+const litehtml::keyword_table litehtml::font_style_keywords(font_style_strings);
+const litehtml::keyword_table litehtml::font_variant_keywords(font_variant_strings);
+const litehtml::keyword_table litehtml::font_weight_keywords(font_weight_strings);
+const litehtml::keyword_table litehtml::list_style_type_keywords(list_style_type_strings);
+const litehtml::keyword_table litehtml::list_style_position_keywords(list_style_position_strings);
+const litehtml::keyword_table litehtml::vertical_align_keywords(vertical_align_strings);
+const litehtml::keyword_table litehtml::border_width_keywords(border_width_strings);
+const litehtml::keyword_table litehtml::border_style_keywords(border_style_strings);
+const litehtml::keyword_table litehtml::element_float_keywords(element_float_strings);
+const litehtml::keyword_table litehtml::element_clear_keywords(element_clear_strings);
+const litehtml::keyword_table litehtml::css_units_keywords(css_units_strings);
+const litehtml::keyword_table litehtml::background_attachment_keywords(background_attachment_strings);
+const litehtml::keyword_table litehtml::background_repeat_keywords(background_repeat_strings);
+const litehtml::keyword_table litehtml::background_box_keywords(background_box_strings);
+const litehtml::keyword_table litehtml::element_position_keywords(element_position_strings);
+const litehtml::keyword_table litehtml::text_align_keywords(text_align_strings);
+const litehtml::keyword_table litehtml::text_transform_keywords(text_transform_strings);
+const litehtml::keyword_table litehtml::white_space_keywords(white_space_strings);
+const litehtml::keyword_table litehtml::overflow_keywords(overflow_strings);
+const litehtml::keyword_table litehtml::visibility_keywords(visibility_strings);
+const litehtml::keyword_table litehtml::border_collapse_keywords(border_collapse_strings);
+const litehtml::keyword_table litehtml::table_layout_keywords(table_layout_strings);
+const litehtml::keyword_table litehtml::pseudo_class_keywords(pseudo_class_strings);
+const litehtml::keyword_table litehtml::media_orientation_keywords(media_orientation_strings);
+const litehtml::keyword_table litehtml::media_feature_keywords(media_feature_strings);
+const litehtml::keyword_table litehtml::box_sizing_keywords(box_sizing_strings);
+const litehtml::keyword_table litehtml::media_type_keywords(media_type_strings);
@@ -0,0 +1,770 @@
+#include "html.h"
+#include "layout_snapshot.h"
+#include "document.h"
+#include "box.h"
+#include "html_tag.h"
+#include <climits>
+#include <stdio.h>
+#include <unordered_map>
+
+namespace
+{
+	// "LHLS" - the signature of the binary snapshots written by layout_snapshot::save
+	const int layout_binary_signature	= 0x534C484C;
+	const int layout_binary_version		= 1;
+
+	void collect_elements(litehtml::element* el, std::vector<litehtml::element*>& els)
+	{
+		els.push_back(el);
+		for (size_t i = 0; i < el->get_children_count(); i++)
+		{
+			collect_elements(el->get_child((int) i).get(), els);
+		}
+	}
+
+	// FNV-1a hash of the tag names and the children counts
+	unsigned int tree_fingerprint(const std::vector<litehtml::element*>& els)
+	{
+		unsigned int hash = 2166136261u;
+		for (auto el : els)
+		{
+			for (const litehtml::tchar_t* tag = el->get_tagName(); *tag; tag++)
+			{
+				hash = (hash ^ (unsigned int) *tag) * 16777619u;
+			}
+			hash = (hash ^ (unsigned int) el->get_children_count()) * 16777619u;
+		}
+		return hash;
+	}
+
+	void write_position(litehtml::binary_writer& out, const litehtml::position& pos)
+	{
+		out.write_int(pos.x);
+		out.write_int(pos.y);
+		out.write_int(pos.z);
+		out.write_int(pos.width);
+		out.write_int(pos.height);
+		out.write_int(pos.depth);
+	}
+
+	litehtml::position read_position(litehtml::binary_reader& in)
+	{
+		litehtml::position pos;
+		pos.x = in.read_int();
+		pos.y = in.read_int();
+		pos.z = in.read_int();
+		pos.width = in.read_int();
+		pos.height = in.read_int();
+		pos.depth = in.read_int();
+		return pos;
+	}
+
+	void write_margins(litehtml::binary_writer& out, const litehtml::margins& m)
+	{
+		out.write_int(m.left);
+		out.write_int(m.right);
+		out.write_int(m.top);
+		out.write_int(m.bottom);
+		out.write_int(m.front);
+		out.write_int(m.back);
+	}
+
+	litehtml::margins read_margins(litehtml::binary_reader& in)
+	{
+		litehtml::margins m;
+		m.left = in.read_int();
+		m.right = in.read_int();
+		m.top = in.read_int();
+		m.bottom = in.read_int();
+		m.front = in.read_int();
+		m.back = in.read_int();
+		return m;
+	}
+
+	void write_metrics(litehtml::binary_writer& out, const litehtml::font_metrics& fm)
+	{
+		out.write_int(fm.height);
+		out.write_int(fm.ascent);
+		out.write_int(fm.descent);
+		out.write_int(fm.x_height);
+		out.write_bool(fm.draw_spaces);
+	}
+
+	litehtml::font_metrics read_metrics(litehtml::binary_reader& in)
+	{
+		litehtml::font_metrics fm;
+		fm.height = in.read_int();
+		fm.ascent = in.read_int();
+		fm.descent = in.read_int();
+		fm.x_height = in.read_int();
+		fm.draw_spaces = in.read_bool();
+		return fm;
+	}
+
+	void write_floats(litehtml::binary_writer& out, const std::vector<litehtml::layout_snapshot::float_layout>& floats)
+	{
+		out.write_int((int) floats.size());
+		for (const auto& fb : floats)
+		{
+			write_position(out, fb.pos);
+			out.write_int(fb.float_side);
+			out.write_int(fb.clear_floats);
+			out.write_int(fb.el);
+		}
+	}
+
+	void read_floats(litehtml::binary_reader& in, std::vector<litehtml::layout_snapshot::float_layout>& floats)
+	{
+		floats.resize(in.read_count(sizeof(int) * 9));
+		for (auto& fb : floats)
+		{
+			fb.pos = read_position(in);
+			fb.float_side = (litehtml::element_float) in.read_int();
+			fb.clear_floats = (litehtml::element_clear) in.read_int();
+			fb.el = in.read_int();
+		}
+	}
+
+	void write_ints(litehtml::binary_writer& out, const std::vector<int>& vals)
+	{
+		out.write_int((int) vals.size());
+		for (int val : vals)
+		{
+			out.write_int(val);
+		}
+	}
+
+	void read_ints(litehtml::binary_reader& in, std::vector<int>& vals)
+	{
+		vals.resize(in.read_count(sizeof(int)));
+		for (auto& val : vals)
+		{
+			val = in.read_int();
+		}
+	}
+
+	void append_json_array(std::string& json, const int* vals, size_t count)
+	{
+		char buf[16];
+		json += '[';
+		for (size_t i = 0; i < count; i++)
+		{
+			snprintf(buf, sizeof(buf), i ? ",%d" : "%d", vals[i]);
+			json += buf;
+		}
+		json += ']';
+	}
+
+	void append_json_ints(std::string& json, const char* name, const int* vals, size_t count)
+	{
+		json += ",\"";
+		json += name;
+		json += "\":";
+		append_json_array(json, vals, count);
+	}
+
+	void append_json_position(std::string& json, const char* name, const litehtml::position& pos)
+	{
+		int vals[] = { pos.x, pos.y, pos.z, pos.width, pos.height, pos.depth };
+		append_json_ints(json, name, vals, 6);
+	}
+
+	void append_json_margins(std::string& json, const char* name, const litehtml::margins& m)
+	{
+		int vals[] = { m.left, m.right, m.top, m.bottom, m.front, m.back };
+		append_json_ints(json, name, vals, 6);
+	}
+
+	// [element, x, y, z, width, height, depth, float, clear] for every float
+	void append_json_floats(std::string& json, const char* name, const std::vector<litehtml::layout_snapshot::float_layout>& floats)
+	{
+		json += ",\"";
+		json += name;
+		json += "\":[";
+		for (size_t i = 0; i < floats.size(); i++)
+		{
+			const auto& fb = floats[i];
+			int vals[] = { fb.el, fb.pos.x, fb.pos.y, fb.pos.z, fb.pos.width, fb.pos.height, fb.pos.depth, fb.float_side, fb.clear_floats };
+			if (i)
+			{
+				json += ',';
+			}
+			append_json_array(json, vals, 9);
+		}
+		json += ']';
+	}
+}
+
+litehtml::layout_snapshot::layout_snapshot()
+{
+	m_fingerprint = 0;
+	m_render_width = -1;
+}
+
+void litehtml::layout_snapshot::clear()
+{
+	m_elements.clear();
+	m_fingerprint = 0;
+	m_render_width = -1;
+	m_size = size();
+	m_fixed_boxes.clear();
+}
+
+bool litehtml::layout_snapshot::capture(document& doc)
+{
+	clear();
+	if (!doc.m_root || doc.m_render_width < 0)
+	{
+		return false;
+	}
+	doc.realize_layout(position(0, 0, 0, doc.m_size.width, INT_MAX / 2, doc.m_size.depth));
+
+	std::vector<element*> els;
+	collect_elements(doc.m_root.get(), els);
+
+	std::unordered_map<const element*, int> el_index;
+	std::unordered_map<const box*, std::pair<int, int>> box_index;
+	// m_box of an element is left dangling when its line box is dropped, only the boxes holding the element count
+	std::unordered_map<const element*, const box*> box_of;
+	for (size_t i = 0; i < els.size(); i++)
+	{
+		el_index[els[i]] = (int) i;
+		html_tag* tag = dynamic_cast<html_tag*>(els[i]);
+		if (tag)
+		{
+			for (size_t b = 0; b < tag->m_boxes.size(); b++)
+			{
+				box* bx = tag->m_boxes[b].get();
+				box_index[bx] = std::make_pair((int) i, (int) b);
+				if (bx->get_type() == box_line)
+				{
+					for (const auto& item : static_cast<const line_box*>(bx)->m_items)
+					{
+						box_of[item.el] = bx;
+					}
+				}
+				else
+				{
+					box_of[static_cast<const block_box*>(bx)->m_element.get()] = bx;
+				}
+			}
+		}
+	}
+	auto index_of = [&el_index](const element* el)
+	{
+		auto iter = el_index.find(el);
+		return iter != el_index.end() ? iter->second : -1;
+	};
+	auto save_floats = [&index_of](const floated_box::vector& src, std::vector<float_layout>& dst)
+	{
+		for (const auto& fb : src)
+		{
+			float_layout fl;
+			fl.pos = fb.pos;
+			fl.float_side = fb.float_side;
+			fl.clear_floats = fb.clear_floats;
+			fl.el = index_of(fb.el.get());
+			dst.push_back(fl);
+		}
+	};
+
+	m_elements.resize(els.size());
+	for (size_t i = 0; i < els.size(); i++)
+	{
+		const element* el = els[i];
+		element_layout& layout = m_elements[i];
+		layout.pos = el->m_pos;
+		layout.margin = el->m_margins;
+		layout.padding = el->m_padding;
+		layout.borders = el->m_borders;
+		layout.skip = el->m_skip;
+		layout.box_owner = -1;
+		layout.box_index = -1;
+		auto holder = box_of.find(el);
+		auto owner = box_index.find(el->m_box);
+		if (holder != box_of.end() && holder->second == el->m_box && owner != box_index.end())
+		{
+			layout.box_owner = owner->second.first;
+			layout.box_index = owner->second.second;
+		}
+
+		const html_tag* tag = dynamic_cast<const html_tag*>(el);
+		if (!tag)
+		{
+			continue;
+		}
+		for (const auto& b : tag->m_boxes)
+		{
+			box_layout bl;
+			bl.is_line = b->get_type() == box_line;
+			bl.top = b->m_box_top;
+			bl.left = b->m_box_left;
+			bl.front = b->m_box_front;
+			bl.right = b->m_box_right;
+			bl.el = -1;
+			bl.height = bl.width = bl.depth = bl.line_height = bl.baseline = 0;
+			bl.align = text_align_left;
+			if (bl.is_line)
+			{
+				const line_box* lb = static_cast<const line_box*>(b.get());
+				bl.height = lb->m_height;
+				bl.width = lb->m_width;
+				bl.depth = lb->m_depth;
+				bl.line_height = lb->m_line_height;
+				bl.baseline = lb->m_baseline;
+				bl.align = lb->m_text_align;
+				bl.fm = lb->m_font_metrics;
+				for (const auto& item : lb->m_items)
+				{
+					item_layout il;
+					il.el = index_of(item.el);
+					il.width = item.width;
+					il.height = item.height;
+					il.shift_left = item.shift_left;
+					il.shift_right = item.shift_right;
+					il.is_white_space = item.is_white_space;
+					il.is_break = item.is_break;
+					il.is_text = item.is_text;
+					il.va = item.va;
+					il.fm = item.fm;
+					il.line_height = item.line_height;
+					bl.items.push_back(il);
+				}
+			}
+			else
+			{
+				bl.el = index_of(static_cast<const block_box*>(b.get())->m_element.get());
+			}
+			layout.boxes.push_back(bl);
+		}
+		save_floats(tag->m_floats_left, layout.floats_left);
+		save_floats(tag->m_floats_right, layout.floats_right);
+		if (tag->m_grid)
+		{
+			for (int r = 0; r < tag->m_grid->rows_count(); r++)
+			{
+				const table_row& row = tag->m_grid->row(r);
+				layout.rows.push_back(row.top);
+				layout.rows.push_back(row.bottom);
+				layout.rows.push_back(row.height);
+			}
+			for (int c = 0; c < tag->m_grid->cols_count(); c++)
+			{
+				const table_column& col = tag->m_grid->column(c);
+				layout.columns.push_back(col.left);
+				layout.columns.push_back(col.right);
+				layout.columns.push_back(col.width);
+			}
+		}
+	}
+
+	m_fingerprint = tree_fingerprint(els);
+	m_render_width = doc.m_render_width;
+	m_size = doc.m_size;
+	m_fixed_boxes = doc.m_fixed_boxes;
+	return true;
+}
+
+bool litehtml::layout_snapshot::apply(document& doc) const
+{
+	if (!doc.m_root || m_elements.empty())
+	{
+		return false;
+	}
+	std::vector<element*> els;
+	collect_elements(doc.m_root.get(), els);
+	if (els.size() != m_elements.size() || tree_fingerprint(els) != m_fingerprint)
+	{
+		return false;
+	}
+	auto element_at = [&els](int idx)
+	{
+		return idx >= 0 ? els[idx]->shared_from_this() : element::ptr();
+	};
+	auto restore_floats = [&element_at](const std::vector<float_layout>& src, floated_box::vector& dst)
+	{
+		dst.clear();
+		for (const auto& fl : src)
+		{
+			floated_box fb;
+			fb.pos = fl.pos;
+			fb.float_side = fl.float_side;
+			fb.clear_floats = fl.clear_floats;
+			fb.el = element_at(fl.el);
+			dst.push_back(std::move(fb));
+		}
+	};
+
+	// the boxes first, the elements point into them
+	for (size_t i = 0; i < els.size(); i++)
+	{
+		html_tag* tag = dynamic_cast<html_tag*>(els[i]);
+		if (!tag)
+		{
+			continue;
+		}
+		const element_layout& layout = m_elements[i];
+		tag->m_boxes.clear();
+		for (const auto& bl : layout.boxes)
+		{
+			if (bl.is_line)
+			{
+				font_metrics fm = bl.fm;
+				line_box* lb = new line_box(bl.top, bl.left, bl.front, bl.right, bl.line_height, fm, bl.align);
+				lb->m_height = bl.height;
+				lb->m_width = bl.width;
+				lb->m_depth = bl.depth;
+				lb->m_baseline = bl.baseline;
+				lb->m_items.reserve(bl.items.size());
+				for (const auto& il : bl.items)
+				{
+					line_box_item item;
+					item.el = els[il.el];
+					item.width = il.width;
+					item.height = il.height;
+					item.shift_left = il.shift_left;
+					item.shift_right = il.shift_right;
+					item.is_white_space = il.is_white_space;
+					item.is_break = il.is_break;
+					item.is_text = il.is_text;
+					item.va = il.va;
+					item.fm = il.fm;
+					item.line_height = il.line_height;
+					lb->m_items.push_back(item);
+				}
+				tag->m_boxes.push_back(box::ptr(lb));
+			}
+			else
+			{
+				block_box* bb = new block_box(bl.top, bl.left, bl.front, bl.right);
+				bb->m_element = element_at(bl.el);
+				tag->m_boxes.push_back(box::ptr(bb));
+			}
+		}
+		restore_floats(layout.floats_left, tag->m_floats_left);
+		restore_floats(layout.floats_right, tag->m_floats_right);
+		tag->m_cahe_line_left.invalidate();
+		tag->m_cahe_line_right.invalidate();
+		if (tag->m_grid && layout.rows.size() == (size_t) tag->m_grid->rows_count() * 3 && layout.columns.size() == (size_t) tag->m_grid->cols_count() * 3)
+		{
+			for (int r = 0; r < tag->m_grid->rows_count(); r++)
+			{
+				table_row& row = tag->m_grid->row(r);
+				row.top = layout.rows[r * 3];
+				row.bottom = layout.rows[r * 3 + 1];
+				row.height = layout.rows[r * 3 + 2];
+			}
+			for (int c = 0; c < tag->m_grid->cols_count(); c++)
+			{
+				table_column& col = tag->m_grid->column(c);
+				col.left = layout.columns[c * 3];
+				col.right = layout.columns[c * 3 + 1];
+				col.width = layout.columns[c * 3 + 2];
+			}
+		}
+	}
+
+	for (size_t i = 0; i < els.size(); i++)
+	{
+		element* el = els[i];
+		const element_layout& layout = m_elements[i];
+		el->m_pos = layout.pos;
+		el->m_margins = layout.margin;
+		el->m_padding = layout.padding;
+		el->m_borders = layout.borders;
+		el->m_skip = layout.skip;
+		el->m_deferred = false;
+		el->m_layout_dirty = false;
+		el->m_box = nullptr;
+		if (layout.box_owner >= 0)
+		{
+			html_tag* owner = dynamic_cast<html_tag*>(els[layout.box_owner]);
+			if (owner && layout.box_index >= 0 && layout.box_index < (int) owner->m_boxes.size())
+			{
+				el->m_box = owner->m_boxes[layout.box_index].get();
+			}
+		}
+	}
+
+	doc.m_lazy_layout = false;
+	doc.m_render_width = m_render_width;
+	doc.m_size = m_size;
+	doc.m_fixed_boxes = m_fixed_boxes;
+	doc.m_root->fetch_positioned();
+	return true;
+}
+
+bool litehtml::layout_snapshot::save(byte_vector& data) const
+{
+	if (m_elements.empty())
+	{
+		return false;
+	}
+	binary_writer out(data);
+	out.write_int(layout_binary_signature);
+	out.write_int(layout_binary_version);
+	out.write_int((int) m_fingerprint);
+	out.write_int(m_render_width);
+	out.write_int(m_size.width);
+	out.write_int(m_size.height);
+	out.write_int(m_size.depth);
+	out.write_int((int) m_fixed_boxes.size());
+	for (const auto& pos : m_fixed_boxes)
+	{
+		write_position(out, pos);
+	}
+
+	out.write_int((int) m_elements.size());
+	for (const auto& layout : m_elements)
+	{
+		write_position(out, layout.pos);
+		write_margins(out, layout.margin);
+		write_margins(out, layout.padding);
+		write_margins(out, layout.borders);
+		out.write_bool(layout.skip);
+		out.write_int(layout.box_owner);
+		out.write_int(layout.box_index);
+
+		out.write_int((int) layout.boxes.size());
+		for (const auto& bl : layout.boxes)
+		{
+			out.write_bool(bl.is_line);
+			out.write_int(bl.top);
+			out.write_int(bl.left);
+			out.write_int(bl.front);
+			out.write_int(bl.right);
+			if (!bl.is_line)
+			{
+				out.write_int(bl.el);
+				continue;
+			}
+			out.write_int(bl.height);
+			out.write_int(bl.width);
+			out.write_int(bl.depth);
+			out.write_int(bl.line_height);
+			out.write_int(bl.baseline);
+			out.write_int(bl.align);
+			write_metrics(out, bl.fm);
+			out.write_int((int) bl.items.size());
+			for (const auto& il : bl.items)
+			{
+				out.write_int(il.el);
+				out.write_int(il.width);
+				out.write_int(il.height);
+				out.write_int(il.shift_left);
+				out.write_int(il.shift_right);
+				out.write_bool(il.is_white_space);
+				out.write_bool(il.is_break);
+				out.write_bool(il.is_text);
+				out.write_int(il.va);
+				write_metrics(out, il.fm);
+				out.write_int(il.line_height);
+			}
+		}
+		write_floats(out, layout.floats_left);
+		write_floats(out, layout.floats_right);
+		write_ints(out, layout.rows);
+		write_ints(out, layout.columns);
+	}
+	return true;
+}
+
+bool litehtml::layout_snapshot::load(const unsigned char* data, size_t size)
+{
+	clear();
+
+	binary_reader in(data, size);
+	if (in.read_int() != layout_binary_signature || in.read_int() != layout_binary_version)
+	{
+		return false;
+	}
+	m_fingerprint = (unsigned int) in.read_int();
+	m_render_width = in.read_int();
+	m_size.width = in.read_int();
+	m_size.height = in.read_int();
+	m_size.depth = in.read_int();
+	m_fixed_boxes.resize(in.read_count(sizeof(int) * 6));
+	for (auto& pos : m_fixed_boxes)
+	{
+		pos = read_position(in);
+	}
+
+	m_elements.resize(in.read_count());
+	for (size_t i = 0; i < m_elements.size() && !in.failed(); i++)
+	{
+		element_layout& layout = m_elements[i];
+		layout.pos = read_position(in);
+		layout.margin = read_margins(in);
+		layout.padding = read_margins(in);
+		layout.borders = read_margins(in);
+		layout.skip = in.read_bool();
+		layout.box_owner = in.read_int();
+		layout.box_index = in.read_int();
+
+		layout.boxes.resize(in.read_count());
+		for (auto& bl : layout.boxes)
+		{
+			bl.is_line = in.read_bool();
+			bl.top = in.read_int();
+			bl.left = in.read_int();
+			bl.front = in.read_int();
+			bl.right = in.read_int();
+			bl.el = -1;
+			bl.height = bl.width = bl.depth = bl.line_height = bl.baseline = 0;
+			bl.align = text_align_left;
+			if (!bl.is_line)
+			{
+				bl.el = in.read_int();
+				continue;
+			}
+			bl.height = in.read_int();
+			bl.width = in.read_int();
+			bl.depth = in.read_int();
+			bl.line_height = in.read_int();
+			bl.baseline = in.read_int();
+			bl.align = (text_align) in.read_int();
+			bl.fm = read_metrics(in);
+			bl.items.resize(in.read_count());
+			for (auto& il : bl.items)
+			{
+				il.el = in.read_int();
+				il.width = in.read_int();
+				il.height = in.read_int();
+				il.shift_left = in.read_int();
+				il.shift_right = in.read_int();
+				il.is_white_space = in.read_bool();
+				il.is_break = in.read_bool();
+				il.is_text = in.read_bool();
+				il.va = (vertical_align) in.read_int();
+				il.fm = read_metrics(in);
+				il.line_height = in.read_int();
+			}
+		}
+		read_floats(in, layout.floats_left);
+		read_floats(in, layout.floats_right);
+		read_ints(in, layout.rows);
+		read_ints(in, layout.columns);
+	}
+
+	// the element indexes must be in the snapshot, apply() uses them as they are
+	bool valid = !in.failed() && in.at_end();
+	int count = (int) m_elements.size();
+	auto valid_index = [count](int idx, bool optional)
+	{
+		return idx < count && (idx >= 0 || (optional && idx == -1));
+	};
+	for (size_t i = 0; i < m_elements.size() && valid; i++)
+	{
+		const element_layout& layout = m_elements[i];
+		valid = valid_index(layout.box_owner, true);
+		if (valid && layout.box_owner >= 0)
+		{
+			valid = layout.box_index >= 0 && layout.box_index < (int) m_elements[layout.box_owner].boxes.size();
+		}
+		// block boxes and floats are always made for an element
+		for (const auto& bl : layout.boxes)
+		{
+			valid = valid && valid_index(bl.el, bl.is_line);
+			for (const auto& il : bl.items)
+			{
+				valid = valid && valid_index(il.el, false);
+			}
+		}
+		for (const auto& fl : layout.floats_left)
+		{
+			valid = valid && valid_index(fl.el, false);
+		}
+		for (const auto& fl : layout.floats_right)
+		{
+			valid = valid && valid_index(fl.el, false);
+		}
+	}
+	if (!valid)
+	{
+		clear();
+		return false;
+	}
+	return true;
+}
+
+std::string litehtml::layout_snapshot::to_json() const
+{
+	char buf[128];
+	snprintf(buf, sizeof(buf), "{\"width\":%d,\"size\":[%d,%d,%d],\"fixed\":[", m_render_width, m_size.width, m_size.height, m_size.depth);
+	std::string json = buf;
+	for (size_t i = 0; i < m_fixed_boxes.size(); i++)
+	{
+		const position& pos = m_fixed_boxes[i];
+		snprintf(buf, sizeof(buf), i ? ",[%d,%d,%d,%d,%d,%d]" : "[%d,%d,%d,%d,%d,%d]", pos.x, pos.y, pos.z, pos.width, pos.height, pos.depth);
+		json += buf;
+	}
+	json += "],\"elements\":[";
+	for (size_t i = 0; i < m_elements.size(); i++)
+	{
+		const element_layout& layout = m_elements[i];
+		snprintf(buf, sizeof(buf), "%s\n{\"i\":%d", i ? "," : "", (int) i);
+		json += buf;
+		append_json_position(json, "pos", layout.pos);
+		append_json_margins(json, "margins", layout.margin);
+		append_json_margins(json, "padding", layout.padding);
+		append_json_margins(json, "borders", layout.borders);
+		if (layout.skip)
+		{
+			json += ",\"skip\":true";
+		}
+		if (layout.box_owner >= 0)
+		{
+			int vals[] = { layout.box_owner, layout.box_index };
+			append_json_ints(json, "box", vals, 2);
+		}
+		if (!layout.boxes.empty())
+		{
+			json += ",\"boxes\":[";
+			for (size_t b = 0; b < layout.boxes.size(); b++)
+			{
+				const box_layout& bl = layout.boxes[b];
+				json += b ? ",{" : "{";
+				json += bl.is_line ? "\"line\":true" : "\"line\":false";
+				if (bl.is_line)
+				{
+					int vals[] = { bl.top, bl.left, bl.front, bl.right, bl.height, bl.width, bl.depth, bl.line_height, bl.baseline, bl.align };
+					append_json_ints(json, "box", vals, 10);
+					json += ",\"items\":[";
+					for (size_t n = 0; n < bl.items.size(); n++)
+					{
+						const item_layout& il = bl.items[n];
+						snprintf(buf, sizeof(buf), "%s[%d,%d,%d,%d,%d,%d]", n ? "," : "", il.el, il.width, il.height, il.shift_left, il.shift_right, il.va);
+						json += buf;
+					}
+					json += ']';
+				}
+				else
+				{
+					int vals[] = { bl.top, bl.left, bl.front, bl.right, bl.el };
+					append_json_ints(json, "box", vals, 5);
+				}
+				json += '}';
+			}
+			json += ']';
+		}
+		if (!layout.floats_left.empty())
+		{
+			append_json_floats(json, "floats_left", layout.floats_left);
+		}
+		if (!layout.floats_right.empty())
+		{
+			append_json_floats(json, "floats_right", layout.floats_right);
+		}
+		if (!layout.rows.empty())
+		{
+			append_json_ints(json, "rows", layout.rows.data(), layout.rows.size());
+		}
+		if (!layout.columns.empty())
+		{
+			append_json_ints(json, "columns", layout.columns.data(), layout.columns.size());
+		}
+		json += '}';
+	}
+	json += "]}\n";
+	return json;
+}
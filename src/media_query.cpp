@@ -40,7 +40,7 @@ litehtml::media_query::ptr litehtml::media_query::create_from_string(const tstri
 			if (!expr_tokens.empty())
 			{
 				trim(expr_tokens[0]);
-				expr.feature = (media_feature)value_index(expr_tokens[0], media_feature_strings, media_feature_none);
+				expr.feature = (media_feature)media_feature_keywords.find(expr_tokens[0], media_feature_none);
 				if (expr.feature != media_feature_none)
 				{
 					if (expr_tokens.size() == 1)
@@ -53,7 +53,7 @@ litehtml::media_query::ptr litehtml::media_query::create_from_string(const tstri
 						expr.check_as_bool = false;
 						if (expr.feature == media_feature_orientation)
 						{
-							expr.val = value_index(expr_tokens[1], media_orientation_strings, media_orientation_landscape);
+							expr.val = media_orientation_keywords.find(expr_tokens[1], media_orientation_landscape);
 						}
 						else
 						{
@@ -96,7 +96,7 @@ litehtml::media_query::ptr litehtml::media_query::create_from_string(const tstri
 		}
 		else
 		{
-			query->m_media_type = (media_type)value_index((*tok), media_type_strings, media_type_all);
+			query->m_media_type = (media_type)media_type_keywords.find(*tok, media_type_all);
 		}
 	}
 	return query;
@@ -139,6 +139,11 @@ litehtml::media_query_list::ptr litehtml::media_query_list::create_from_string(c
 		if (query)
 		{
 			list->m_queries.push_back(query);
+			if (!list->m_text.empty())
+			{
+				list->m_text += _t(", ");
+			}
+			list->m_text += *tok;
 		}
 	}
 	if (list->m_queries.empty())
@@ -148,20 +153,16 @@ litehtml::media_query_list::ptr litehtml::media_query_list::create_from_string(c
 	return list;
 }
 
-bool litehtml::media_query_list::apply_media_features(const media_features& features)
+bool litehtml::media_query_list::check(const media_features& features) const
 {
-	bool apply = false;
-	for (media_query::vector::iterator iter = m_queries.begin(); iter != m_queries.end() && !apply; iter++)
+	for (media_query::vector::const_iterator iter = m_queries.begin(); iter != m_queries.end(); iter++)
 	{
 		if ((*iter)->check(features))
 		{
-			apply = true;
+			return true;
 		}
 	}
-
-	bool ret = (apply != m_is_used);
-	m_is_used = apply;
-	return ret;
+	return false;
 }
 
 bool litehtml::media_query_expression::check(const media_features& features) const
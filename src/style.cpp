@@ -68,7 +68,221 @@ void litehtml::style::combine(const litehtml::style& src)
 {
 	for (props_map::const_iterator i = src.m_properties.begin(); i != src.m_properties.end(); i++)
 	{
-		add_parsed_property(i->first.c_str(), i->second.m_value.c_str(), i->second.m_important);
+		set_property(i->first, i->second);
+	}
+}
+
+size_t litehtml::style::memory_size() const
+{
+	size_t size = m_properties.size() * (sizeof(props_map::value_type) + map_node_overhead);
+	for (const auto& prop : m_properties)
+	{
+		size += string_memory(prop.first) + string_memory(prop.second.m_value);
+	}
+	return size;
+}
+
+namespace
+{
+	enum shorthand_type
+	{
+		shorthand_baseurl,
+		shorthand_pair,
+		shorthand_border,
+		shorthand_border_side,
+		shorthand_corner_radius,
+		shorthand_radius,
+		shorthand_box,
+		shorthand_list_style,
+		shorthand_background,
+		shorthand_font,
+	};
+
+	struct shorthand
+	{
+		const litehtml::tchar_t*		name;
+		shorthand_type					type;
+		const litehtml::tchar_t* const*	longhands;
+	};
+
+	// style, width and color of every side, in the order used by the border shorthand
+	const litehtml::tchar_t* const border_longhands[] =
+	{
+		_t("border-left-style"),	_t("border-left-width"),	_t("border-left-color"),
+		_t("border-right-style"),	_t("border-right-width"),	_t("border-right-color"),
+		_t("border-top-style"),		_t("border-top-width"),		_t("border-top-color"),
+		_t("border-bottom-style"),	_t("border-bottom-width"),	_t("border-bottom-color"),
+		_t("border-front-style"),	_t("border-front-width"),	_t("border-front-color"),
+		_t("border-back-style"),	_t("border-back-width"),	_t("border-back-color"),
+	};
+
+	const litehtml::tchar_t* const background_image_longhands[]		= { _t("background-image-baseurl") };
+	const litehtml::tchar_t* const list_style_image_longhands[]		= { _t("list-style-image-baseurl") };
+	const litehtml::tchar_t* const border_spacing_longhands[]		= { _t("-litehtml-border-spacing-x"), _t("-litehtml-border-spacing-y") };
+	const litehtml::tchar_t* const border_radius_longhands[]		= { _t("border-radius-x"), _t("border-radius-y"), _t("border-radius-z") };
+	const litehtml::tchar_t* const border_tl_radius_longhands[]		= { _t("border-top-left-radius-x"), _t("border-top-left-radius-y"), _t("border-top-left-radius-z") };
+	const litehtml::tchar_t* const border_tr_radius_longhands[]		= { _t("border-top-right-radius-x"), _t("border-top-right-radius-y"), _t("border-top-right-radius-z") };
+	const litehtml::tchar_t* const border_br_radius_longhands[]		= { _t("border-bottom-right-radius-x"), _t("border-bottom-right-radius-y"), _t("border-bottom-right-radius-z") };
+	const litehtml::tchar_t* const border_bl_radius_longhands[]		= { _t("border-bottom-left-radius-x"), _t("border-bottom-left-radius-y"), _t("border-bottom-left-radius-z") };
+	const litehtml::tchar_t* const border_radius_x_longhands[]		= { _t("border-top-left-radius-x"), _t("border-top-right-radius-x"), _t("border-bottom-right-radius-x"), _t("border-bottom-left-radius-x") };
+	const litehtml::tchar_t* const border_radius_y_longhands[]		= { _t("border-top-left-radius-y"), _t("border-top-right-radius-y"), _t("border-bottom-right-radius-y"), _t("border-bottom-left-radius-y") };
+	const litehtml::tchar_t* const border_radius_z_longhands[]		= { _t("border-top-left-radius-z"), _t("border-top-right-radius-z"), _t("border-bottom-right-radius-z"), _t("border-bottom-left-radius-z") };
+	const litehtml::tchar_t* const border_width_longhands[]			= { _t("border-top-width"), _t("border-right-width"), _t("border-bottom-width"), _t("border-left-width") };
+	const litehtml::tchar_t* const border_style_longhands[]			= { _t("border-top-style"), _t("border-right-style"), _t("border-bottom-style"), _t("border-left-style") };
+	const litehtml::tchar_t* const border_color_longhands[]			= { _t("border-top-color"), _t("border-right-color"), _t("border-bottom-color"), _t("border-left-color") };
+	const litehtml::tchar_t* const margin_longhands[]				= { _t("margin-top"), _t("margin-right"), _t("margin-bottom"), _t("margin-left") };
+	const litehtml::tchar_t* const padding_longhands[]				= { _t("padding-top"), _t("padding-right"), _t("padding-bottom"), _t("padding-left") };
+	const litehtml::tchar_t* const list_style_longhands[]			= { _t("list-style-type"), _t("list-style-position"), _t("list-style-image"), _t("list-style-image-baseurl") };
+
+	// Must be kept sorted by name
+	const shorthand shorthands[] =
+	{
+		{ _t("background"),					shorthand_background,		nullptr },
+		{ _t("background-image"),			shorthand_baseurl,			background_image_longhands },
+		{ _t("border"),						shorthand_border,			border_longhands },
+		{ _t("border-back"),				shorthand_border_side,		border_longhands + 15 },
+		{ _t("border-bottom"),				shorthand_border_side,		border_longhands + 9 },
+		{ _t("border-bottom-left-radius"),	shorthand_corner_radius,	border_bl_radius_longhands },
+		{ _t("border-bottom-right-radius"),	shorthand_corner_radius,	border_br_radius_longhands },
+		{ _t("border-color"),				shorthand_box,				border_color_longhands },
+		{ _t("border-front"),				shorthand_border_side,		border_longhands + 12 },
+		{ _t("border-left"),				shorthand_border_side,		border_longhands },
+		{ _t("border-radius"),				shorthand_radius,			border_radius_longhands },
+		{ _t("border-radius-x"),			shorthand_box,				border_radius_x_longhands },
+		{ _t("border-radius-y"),			shorthand_box,				border_radius_y_longhands },
+		{ _t("border-radius-z"),			shorthand_box,				border_radius_z_longhands },
+		{ _t("border-right"),				shorthand_border_side,		border_longhands + 3 },
+		{ _t("border-spacing"),				shorthand_pair,				border_spacing_longhands },
+		{ _t("border-style"),				shorthand_box,				border_style_longhands },
+		{ _t("border-top"),					shorthand_border_side,		border_longhands + 6 },
+		{ _t("border-top-left-radius"),		shorthand_corner_radius,	border_tl_radius_longhands },
+		{ _t("border-top-right-radius"),	shorthand_corner_radius,	border_tr_radius_longhands },
+		{ _t("border-width"),				shorthand_box,				border_width_longhands },
+		{ _t("font"),						shorthand_font,				nullptr },
+		{ _t("list-style"),					shorthand_list_style,		list_style_longhands },
+		{ _t("list-style-image"),			shorthand_baseurl,			list_style_image_longhands },
+		{ _t("margin"),						shorthand_box,				margin_longhands },
+		{ _t("padding"),					shorthand_box,				padding_longhands },
+	};
+
+	const shorthand* find_shorthand(const litehtml::tchar_t* name)
+	{
+		const shorthand* end = shorthands + sizeof(shorthands) / sizeof(shorthands[0]);
+		const shorthand* sh = std::lower_bound(shorthands, end, name,
+			[](const shorthand& a, const litehtml::tchar_t* b)
+			{
+				return t_strcmp(a.name, b) < 0;
+			});
+		if (sh != end && !t_strcmp(sh->name, name))
+		{
+			return sh;
+		}
+		return nullptr;
+	}
+
+	struct typed_property
+	{
+		const litehtml::tchar_t*	name;
+		litehtml::property_type		type;
+		const litehtml::tchar_t*	predefs;	// keywords of the length, as html_tag::parse_styles reads them
+	};
+
+	// Properties stored with a parsed value. Must be kept sorted by name
+	const typed_property typed_properties[] =
+	{
+		{ _t("-litehtml-border-spacing-x"),		litehtml::property_type_length,	_t("") },
+		{ _t("-litehtml-border-spacing-y"),		litehtml::property_type_length,	_t("") },
+		{ _t("-litehtml-border-spacing-z"),		litehtml::property_type_length,	_t("") },
+		{ _t("back"),							litehtml::property_type_length,	_t("auto") },
+		{ _t("background-color"),				litehtml::property_type_color,	nullptr },
+		{ _t("border-back-color"),				litehtml::property_type_color,	nullptr },
+		{ _t("border-back-width"),				litehtml::property_type_length,	border_width_strings },
+		{ _t("border-bottom-color"),			litehtml::property_type_color,	nullptr },
+		{ _t("border-bottom-left-radius-x"),	litehtml::property_type_length,	_t("") },
+		{ _t("border-bottom-left-radius-y"),	litehtml::property_type_length,	_t("") },
+		{ _t("border-bottom-left-radius-z"),	litehtml::property_type_length,	_t("") },
+		{ _t("border-bottom-right-radius-x"),	litehtml::property_type_length,	_t("") },
+		{ _t("border-bottom-right-radius-y"),	litehtml::property_type_length,	_t("") },
+		{ _t("border-bottom-right-radius-z"),	litehtml::property_type_length,	_t("") },
+		{ _t("border-bottom-width"),			litehtml::property_type_length,	border_width_strings },
+		{ _t("border-front-color"),				litehtml::property_type_color,	nullptr },
+		{ _t("border-front-width"),				litehtml::property_type_length,	border_width_strings },
+		{ _t("border-left-color"),				litehtml::property_type_color,	nullptr },
+		{ _t("border-left-width"),				litehtml::property_type_length,	border_width_strings },
+		{ _t("border-right-color"),				litehtml::property_type_color,	nullptr },
+		{ _t("border-right-width"),				litehtml::property_type_length,	border_width_strings },
+		{ _t("border-top-color"),				litehtml::property_type_color,	nullptr },
+		{ _t("border-top-left-radius-x"),		litehtml::property_type_length,	_t("") },
+		{ _t("border-top-left-radius-y"),		litehtml::property_type_length,	_t("") },
+		{ _t("border-top-left-radius-z"),		litehtml::property_type_length,	_t("") },
+		{ _t("border-top-right-radius-x"),		litehtml::property_type_length,	_t("") },
+		{ _t("border-top-right-radius-y"),		litehtml::property_type_length,	_t("") },
+		{ _t("border-top-right-radius-z"),		litehtml::property_type_length,	_t("") },
+		{ _t("border-top-width"),				litehtml::property_type_length,	border_width_strings },
+		{ _t("bottom"),							litehtml::property_type_length,	_t("auto") },
+		{ _t("color"),							litehtml::property_type_color,	nullptr },
+		{ _t("depth"),							litehtml::property_type_length,	_t("auto") },
+		{ _t("front"),							litehtml::property_type_length,	_t("auto") },
+		{ _t("height"),							litehtml::property_type_length,	_t("auto") },
+		{ _t("left"),							litehtml::property_type_length,	_t("auto") },
+		{ _t("line-height"),					litehtml::property_type_length,	_t("normal") },
+		{ _t("margin-back"),					litehtml::property_type_length,	_t("auto") },
+		{ _t("margin-bottom"),					litehtml::property_type_length,	_t("auto") },
+		{ _t("margin-front"),					litehtml::property_type_length,	_t("auto") },
+		{ _t("margin-left"),					litehtml::property_type_length,	_t("auto") },
+		{ _t("margin-right"),					litehtml::property_type_length,	_t("auto") },
+		{ _t("margin-top"),						litehtml::property_type_length,	_t("auto") },
+		{ _t("max-depth"),						litehtml::property_type_length,	_t("none") },
+		{ _t("max-height"),						litehtml::property_type_length,	_t("none") },
+		{ _t("max-width"),						litehtml::property_type_length,	_t("none") },
+		{ _t("min-depth"),						litehtml::property_type_length,	_t("") },
+		{ _t("min-height"),						litehtml::property_type_length,	_t("") },
+		{ _t("min-width"),						litehtml::property_type_length,	_t("") },
+		{ _t("padding-back"),					litehtml::property_type_length,	_t("") },
+		{ _t("padding-bottom"),					litehtml::property_type_length,	_t("") },
+		{ _t("padding-front"),					litehtml::property_type_length,	_t("") },
+		{ _t("padding-left"),					litehtml::property_type_length,	_t("") },
+		{ _t("padding-right"),					litehtml::property_type_length,	_t("") },
+		{ _t("padding-top"),					litehtml::property_type_length,	_t("") },
+		{ _t("right"),							litehtml::property_type_length,	_t("auto") },
+		{ _t("text-indent"),					litehtml::property_type_length,	_t("0") },
+		{ _t("top"),							litehtml::property_type_length,	_t("auto") },
+		{ _t("width"),							litehtml::property_type_length,	_t("auto") },
+	};
+
+	const typed_property* find_typed_property(const litehtml::tchar_t* name)
+	{
+		const typed_property* end = typed_properties + sizeof(typed_properties) / sizeof(typed_properties[0]);
+		const typed_property* tp = std::lower_bound(typed_properties, end, name,
+			[](const typed_property& a, const litehtml::tchar_t* b)
+			{
+				return t_strcmp(a.name, b) < 0;
+			});
+		if (tp != end && !t_strcmp(tp->name, name))
+		{
+			return tp;
+		}
+		return nullptr;
+	}
+
+	void parse_typed_value(const litehtml::tstring& name, litehtml::property_value& val)
+	{
+		const typed_property* tp = find_typed_property(name.c_str());
+		if (!tp || !t_strcasecmp(val.m_value.c_str(), _t("inherit")))
+		{
+			return;
+		}
+		if (tp->type == litehtml::property_type_length)
+		{
+			val.m_length.fromString(val.m_value, tp->predefs);
+			val.m_predefs = tp->predefs;
+			val.m_type = litehtml::property_type_length;
+		}
+		else if (litehtml::web_color::parse(val.m_value.c_str(), val.m_color))
+		{
+			// the names resolved by the container are left as strings
+			val.m_type = litehtml::property_type_color;
+		}
 	}
 }
 
@@ -79,490 +293,159 @@ void litehtml::style::add_property(const tchar_t* name, const tchar_t* val, cons
 		return;
 	}
 
-	// Add baseurl for background image 
-	if (!t_strcmp(name, _t("background-image")))
+	const shorthand* sh = find_shorthand(name);
+	if (!sh)
 	{
+		add_parsed_property(name, val, important);
+		return;
+	}
+
+	switch (sh->type)
+	{
+	case shorthand_baseurl:
+		// Add baseurl for background and list-style images
 		add_parsed_property(name, val, important);
 		if (baseurl)
 		{
-			add_parsed_property(_t("background-image-baseurl"), baseurl, important);
+			add_parsed_property(sh->longhands[0], baseurl, important);
 		}
-	}
-	else
-
-		// Parse border spacing properties 
-		if (!t_strcmp(name, _t("border-spacing")))
+		break;
+	case shorthand_pair:
 		{
 			string_vector tokens;
 			split_string(val, tokens, _t(" "));
-			if (tokens.size() == 1)
-			{
-				add_parsed_property(_t("-litehtml-border-spacing-x"), tokens[0].c_str(), important);
-				add_parsed_property(_t("-litehtml-border-spacing-y"), tokens[0].c_str(), important);
-			}
-			else if (tokens.size() == 2)
+			if (tokens.size() == 1 || tokens.size() == 2)
 			{
-				add_parsed_property(_t("-litehtml-border-spacing-x"), tokens[0].c_str(), important);
-				add_parsed_property(_t("-litehtml-border-spacing-y"), tokens[1].c_str(), important);
+				add_parsed_property(sh->longhands[0], tokens[0], important);
+				add_parsed_property(sh->longhands[1], tokens.back(), important);
 			}
 		}
-		else
-
-			// Parse borders shorthand properties 
-
-			if (!t_strcmp(name, _t("border")))
-			{
-				string_vector tokens;
-				split_string(val, tokens, _t(" "), _t(""), _t("("));
-				int idx;
-				tstring str;
-				for (string_vector::const_iterator tok = tokens.begin(); tok != tokens.end(); tok++)
-				{
-					idx = value_index(tok->c_str(), border_style_strings, -1);
-					if (idx >= 0)
-					{
-						add_property(_t("border-left-style"), tok->c_str(), baseurl, important);
-						add_property(_t("border-right-style"), tok->c_str(), baseurl, important);
-						add_property(_t("border-top-style"), tok->c_str(), baseurl, important);
-						add_property(_t("border-bottom-style"), tok->c_str(), baseurl, important);
-						add_property(_t("border-front-style"), tok->c_str(), baseurl, important);
-						add_property(_t("border-back-style"), tok->c_str(), baseurl, important);
-					}
-					else
-					{
-						if (t_isdigit((*tok)[0]) || (*tok)[0] == _t('.') ||
-							value_in_list((*tok), _t("thin;medium;thick")))
-						{
-							add_property(_t("border-left-width"), tok->c_str(), baseurl, important);
-							add_property(_t("border-right-width"), tok->c_str(), baseurl, important);
-							add_property(_t("border-top-width"), tok->c_str(), baseurl, important);
-							add_property(_t("border-bottom-width"), tok->c_str(), baseurl, important);
-							add_property(_t("border-front-width"), tok->c_str(), baseurl, important);
-							add_property(_t("border-back-width"), tok->c_str(), baseurl, important);
-						}
-						else
-						{
-							add_property(_t("border-left-color"), tok->c_str(), baseurl, important);
-							add_property(_t("border-right-color"), tok->c_str(), baseurl, important);
-							add_property(_t("border-top-color"), tok->c_str(), baseurl, important);
-							add_property(_t("border-bottom-color"), tok->c_str(), baseurl, important);
-							add_property(_t("border-front-color"), tok->c_str(), baseurl, important);
-							add_property(_t("border-back-color"), tok->c_str(), baseurl, important);
-						}
-					}
-				}
-			}
-			else if (!t_strcmp(name, _t("border-left")) ||
-				!t_strcmp(name, _t("border-right")) ||
-				!t_strcmp(name, _t("border-top")) ||
-				!t_strcmp(name, _t("border-bottom")) ||
-				!t_strcmp(name, _t("border-front")) ||
-				!t_strcmp(name, _t("border-back")))
-			{
-				string_vector tokens;
-				split_string(val, tokens, _t(" "), _t(""), _t("("));
-				int idx;
-				tstring str;
-				for (string_vector::const_iterator tok = tokens.begin(); tok != tokens.end(); tok++)
-				{
-					idx = value_index(tok->c_str(), border_style_strings, -1);
-					if (idx >= 0)
-					{
-						str = name;
-						str += _t("-style");
-						add_property(str.c_str(), tok->c_str(), baseurl, important);
-					}
-					else
-					{
-						if (web_color::is_color(tok->c_str()))
-						{
-							str = name;
-							str += _t("-color");
-							add_property(str.c_str(), tok->c_str(), baseurl, important);
-						}
-						else
-						{
-							str = name;
-							str += _t("-width");
-							add_property(str.c_str(), tok->c_str(), baseurl, important);
-						}
-					}
-				}
-			}
-			else
-
-				// Parse border radius shorthand properties 
-				if (!t_strcmp(name, _t("border-bottom-left-radius")))
-				{
-					string_vector tokens;
-					split_string(val, tokens, _t(" "));
-					if (tokens.size() >= 2)
-					{
-						add_property(_t("border-bottom-left-radius-x"), tokens[0].c_str(), baseurl, important);
-						add_property(_t("border-bottom-left-radius-y"), tokens[1].c_str(), baseurl, important);
-						add_property(_t("border-bottom-left-radius-z"), tokens.size() == 2 ? tokens[1].c_str() : tokens[2].c_str(), baseurl, important);
-					}
-					else if (tokens.size() == 1)
-					{
-						add_property(_t("border-bottom-left-radius-x"), tokens[0].c_str(), baseurl, important);
-						add_property(_t("border-bottom-left-radius-y"), tokens[0].c_str(), baseurl, important);
-						add_property(_t("border-bottom-left-radius-z"), tokens[0].c_str(), baseurl, important);
-					}
-
-				}
-				else if (!t_strcmp(name, _t("border-bottom-right-radius")))
-				{
-					string_vector tokens;
-					split_string(val, tokens, _t(" "));
-					if (tokens.size() >= 2)
-					{
-						add_property(_t("border-bottom-right-radius-x"), tokens[0].c_str(), baseurl, important);
-						add_property(_t("border-bottom-right-radius-y"), tokens[1].c_str(), baseurl, important);
-						add_property(_t("border-bottom-right-radius-y"), tokens.size() == 2 ? tokens[1].c_str() : tokens[2].c_str(), baseurl, important);
-					}
-					else if (tokens.size() == 1)
-					{
-						add_property(_t("border-bottom-right-radius-x"), tokens[0].c_str(), baseurl, important);
-						add_property(_t("border-bottom-right-radius-y"), tokens[0].c_str(), baseurl, important);
-						add_property(_t("border-bottom-right-radius-z"), tokens[0].c_str(), baseurl, important);
-					}
-
-				}
-				else if (!t_strcmp(name, _t("border-top-right-radius")))
-				{
-					string_vector tokens;
-					split_string(val, tokens, _t(" "));
-					if (tokens.size() >= 2)
-					{
-						add_property(_t("border-top-right-radius-x"), tokens[0].c_str(), baseurl, important);
-						add_property(_t("border-top-right-radius-y"), tokens[1].c_str(), baseurl, important);
-						add_property(_t("border-top-right-radius-z"), tokens.size() == 2 ? tokens[1].c_str() : tokens[2].c_str(), baseurl, important);
-					}
-					else if (tokens.size() == 1)
-					{
-						add_property(_t("border-top-right-radius-x"), tokens[0].c_str(), baseurl, important);
-						add_property(_t("border-top-right-radius-y"), tokens[0].c_str(), baseurl, important);
-						add_property(_t("border-top-right-radius-z"), tokens[0].c_str(), baseurl, important);
-					}
+		break;
+	case shorthand_border:
+		parse_short_border(sh->longhands, 6, val, important);
+		break;
+	case shorthand_border_side:
+		parse_short_border(sh->longhands, 1, val, important);
+		break;
+	case shorthand_corner_radius:
+		parse_short_xyz(sh->longhands, val, _t(" "), important);
+		break;
+	case shorthand_radius:
+		parse_short_xyz(sh->longhands, val, _t("/"), important);
+		break;
+	case shorthand_box:
+		parse_short_box(sh->longhands, val, important);
+		break;
+	case shorthand_list_style:
+		parse_short_list_style(sh->longhands, val, baseurl, important);
+		break;
+	case shorthand_background:
+		parse_short_background(val, baseurl, important);
+		break;
+	case shorthand_font:
+		parse_short_font(val, important);
+		break;
+	}
+}
 
-				}
-				else if (!t_strcmp(name, _t("border-top-left-radius")))
-				{
-					string_vector tokens;
-					split_string(val, tokens, _t(" "));
-					if (tokens.size() >= 2)
-					{
-						add_property(_t("border-top-left-radius-x"), tokens[0].c_str(), baseurl, important);
-						add_property(_t("border-top-left-radius-y"), tokens[1].c_str(), baseurl, important);
-						add_property(_t("border-top-left-radius-z"), tokens.size() == 2 ? tokens[1].c_str() : tokens[2].c_str(), baseurl, important);
-					}
-					else if (tokens.size() == 1)
-					{
-						add_property(_t("border-top-left-radius-x"), tokens[0].c_str(), baseurl, important);
-						add_property(_t("border-top-left-radius-y"), tokens[0].c_str(), baseurl, important);
-						add_property(_t("border-top-left-radius-z"), tokens[0].c_str(), baseurl, important);
-					}
+void litehtml::style::parse_short_border(const tchar_t* const* longhands, int sides, const tstring& val, bool important)
+{
+	string_vector tokens;
+	split_string(val, tokens, _t(" "), _t(""), _t("("));
+	for (string_vector::const_iterator tok = tokens.begin(); tok != tokens.end(); tok++)
+	{
+		int idx;
+		if (border_style_keywords.contains(*tok))
+		{
+			idx = 0;
+		}
+		else if (sides == 1)
+		{
+			// the side shorthands take anything that may be a color as the color
+			idx = web_color::is_color(tok->c_str()) ? 2 : 1;
+		}
+		else if (t_isdigit((*tok)[0]) || (*tok)[0] == _t('.') || border_width_keywords.contains(*tok))
+		{
+			idx = 1;
+		}
+		else
+		{
+			idx = 2;
+		}
+		for (int i = 0; i < sides; i++)
+		{
+			add_parsed_property(longhands[i * 3 + idx], *tok, important);
+		}
+	}
+}
 
-				}
-				else
+void litehtml::style::parse_short_xyz(const tchar_t* const* longhands, const tstring& val, const tchar_t* delims, bool important)
+{
+	string_vector tokens;
+	split_string(val, tokens, delims);
+	if (tokens.size() >= 2)
+	{
+		add_parsed_property(longhands[0], tokens[0], important);
+		add_parsed_property(longhands[1], tokens[1], important);
+		add_parsed_property(longhands[2], tokens.size() == 2 ? tokens[1] : tokens[2], important);
+	}
+	else if (tokens.size() == 1)
+	{
+		add_parsed_property(longhands[0], tokens[0], important);
+		add_parsed_property(longhands[1], tokens[0], important);
+		add_parsed_property(longhands[2], tokens[0], important);
+	}
+}
 
-					// Parse border-radius shorthand properties 
-					if (!t_strcmp(name, _t("border-radius")))
-					{
-						string_vector tokens;
-						split_string(val, tokens, _t("/"));
-						if (tokens.size() == 1)
-						{
-							add_property(_t("border-radius-x"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-radius-y"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-radius-z"), tokens[0].c_str(), baseurl, important);
-						}
-						else if (tokens.size() >= 2)
-						{
-							add_property(_t("border-radius-x"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-radius-y"), tokens[1].c_str(), baseurl, important);
-							add_property(_t("border-radius-z"), tokens.size() == 2 ? tokens[1].c_str() : tokens[2].c_str(), baseurl, important);
-						}
-					}
-					else if (!t_strcmp(name, _t("border-radius-x")))
-					{
-						string_vector tokens;
-						split_string(val, tokens, _t(" "));
-						if (tokens.size() == 1)
-						{
-							add_property(_t("border-top-left-radius-x"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-top-right-radius-x"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-bottom-right-radius-x"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-bottom-left-radius-x"), tokens[0].c_str(), baseurl, important);
-						}
-						else if (tokens.size() == 2)
-						{
-							add_property(_t("border-top-left-radius-x"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-top-right-radius-x"), tokens[1].c_str(), baseurl, important);
-							add_property(_t("border-bottom-right-radius-x"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-bottom-left-radius-x"), tokens[1].c_str(), baseurl, important);
-						}
-						else if (tokens.size() == 3)
-						{
-							add_property(_t("border-top-left-radius-x"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-top-right-radius-x"), tokens[1].c_str(), baseurl, important);
-							add_property(_t("border-bottom-right-radius-x"), tokens[2].c_str(), baseurl, important);
-							add_property(_t("border-bottom-left-radius-x"), tokens[1].c_str(), baseurl, important);
-						}
-						else if (tokens.size() == 4)
-						{
-							add_property(_t("border-top-left-radius-x"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-top-right-radius-x"), tokens[1].c_str(), baseurl, important);
-							add_property(_t("border-bottom-right-radius-x"), tokens[2].c_str(), baseurl, important);
-							add_property(_t("border-bottom-left-radius-x"), tokens[3].c_str(), baseurl, important);
-						}
-					}
-					else if (!t_strcmp(name, _t("border-radius-y")))
-					{
-						string_vector tokens;
-						split_string(val, tokens, _t(" "));
-						if (tokens.size() == 1)
-						{
-							add_property(_t("border-top-left-radius-y"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-top-right-radius-y"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-bottom-right-radius-y"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-bottom-left-radius-y"), tokens[0].c_str(), baseurl, important);
-						}
-						else if (tokens.size() == 2)
-						{
-							add_property(_t("border-top-left-radius-y"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-top-right-radius-y"), tokens[1].c_str(), baseurl, important);
-							add_property(_t("border-bottom-right-radius-y"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-bottom-left-radius-y"), tokens[1].c_str(), baseurl, important);
-						}
-						else if (tokens.size() == 3)
-						{
-							add_property(_t("border-top-left-radius-y"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-top-right-radius-y"), tokens[1].c_str(), baseurl, important);
-							add_property(_t("border-bottom-right-radius-y"), tokens[2].c_str(), baseurl, important);
-							add_property(_t("border-bottom-left-radius-y"), tokens[1].c_str(), baseurl, important);
-						}
-						else if (tokens.size() == 4)
-						{
-							add_property(_t("border-top-left-radius-y"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-top-right-radius-y"), tokens[1].c_str(), baseurl, important);
-							add_property(_t("border-bottom-right-radius-y"), tokens[2].c_str(), baseurl, important);
-							add_property(_t("border-bottom-left-radius-y"), tokens[3].c_str(), baseurl, important);
-						}
-					}
-					else if (!t_strcmp(name, _t("border-radius-z")))
-					{
-						string_vector tokens;
-						split_string(val, tokens, _t(" "));
-						if (tokens.size() == 1)
-						{
-							add_property(_t("border-top-left-radius-z"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-top-right-radius-z"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-bottom-right-radius-z"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-bottom-left-radius-z"), tokens[0].c_str(), baseurl, important);
-						}
-						else if (tokens.size() == 2)
-						{
-							add_property(_t("border-top-left-radius-z"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-top-right-radius-z"), tokens[1].c_str(), baseurl, important);
-							add_property(_t("border-bottom-right-radius-z"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-bottom-left-radius-z"), tokens[1].c_str(), baseurl, important);
-						}
-						else if (tokens.size() == 3)
-						{
-							add_property(_t("border-top-left-radius-z"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-top-right-radius-z"), tokens[1].c_str(), baseurl, important);
-							add_property(_t("border-bottom-right-radius-z"), tokens[2].c_str(), baseurl, important);
-							add_property(_t("border-bottom-left-radius-z"), tokens[1].c_str(), baseurl, important);
-						}
-						else if (tokens.size() == 4)
-						{
-							add_property(_t("border-top-left-radius-z"), tokens[0].c_str(), baseurl, important);
-							add_property(_t("border-top-right-radius-z"), tokens[1].c_str(), baseurl, important);
-							add_property(_t("border-bottom-right-radius-z"), tokens[2].c_str(), baseurl, important);
-							add_property(_t("border-bottom-left-radius-z"), tokens[3].c_str(), baseurl, important);
-						}
-					}
-					else
+void litehtml::style::parse_short_box(const tchar_t* const* longhands, const tstring& val, bool important)
+{
+	// longhands are top, right, bottom, left (or the corners clockwise from the top-left one)
+	static const int sources[4][4] =
+	{
+		{ 0, 0, 0, 0 },
+		{ 0, 1, 0, 1 },
+		{ 0, 1, 2, 1 },
+		{ 0, 1, 2, 3 },
+	};
 
-						// Parse list-style shorthand properties 
-						if (!t_strcmp(name, _t("list-style")))
-						{
-							add_parsed_property(_t("list-style-type"), _t("disc"), important);
-							add_parsed_property(_t("list-style-position"), _t("outside"), important);
-							add_parsed_property(_t("list-style-image"), _t(""), important);
-							add_parsed_property(_t("list-style-image-baseurl"), _t(""), important);
-
-							string_vector tokens;
-							split_string(val, tokens, _t(" "), _t(""), _t("("));
-							for (string_vector::iterator tok = tokens.begin(); tok != tokens.end(); tok++)
-							{
-								int idx = value_index(tok->c_str(), list_style_type_strings, -1);
-								if (idx >= 0)
-								{
-									add_parsed_property(_t("list-style-type"), *tok, important);
-								}
-								else
-								{
-									idx = value_index(tok->c_str(), list_style_position_strings, -1);
-									if (idx >= 0)
-									{
-										add_parsed_property(_t("list-style-position"), *tok, important);
-									}
-									else if (!t_strncmp(val, _t("url"), 3))
-									{
-										add_parsed_property(_t("list-style-image"), *tok, important);
-										if (baseurl)
-										{
-											add_parsed_property(_t("list-style-image-baseurl"), baseurl, important);
-										}
-									}
-								}
-							}
-						}
-						else
-
-							// Add baseurl for background image 
-							if (!t_strcmp(name, _t("list-style-image")))
-							{
-								add_parsed_property(name, val, important);
-								if (baseurl)
-								{
-									add_parsed_property(_t("list-style-image-baseurl"), baseurl, important);
-								}
-							}
-							else
-
-								// Parse background shorthand properties 
-								if (!t_strcmp(name, _t("background")))
-								{
-									parse_short_background(val, baseurl, important);
-
-								}
-								else
-
-									// Parse margin and padding shorthand properties 
-									if (!t_strcmp(name, _t("margin")) || !t_strcmp(name, _t("padding")))
-									{
-										string_vector tokens;
-										split_string(val, tokens, _t(" "));
-										if (tokens.size() >= 4)
-										{
-											add_parsed_property(tstring(name) + _t("-top"), tokens[0], important);
-											add_parsed_property(tstring(name) + _t("-right"), tokens[1], important);
-											add_parsed_property(tstring(name) + _t("-bottom"), tokens[2], important);
-											add_parsed_property(tstring(name) + _t("-left"), tokens[3], important);
-										}
-										else if (tokens.size() == 3)
-										{
-											add_parsed_property(tstring(name) + _t("-top"), tokens[0], important);
-											add_parsed_property(tstring(name) + _t("-right"), tokens[1], important);
-											add_parsed_property(tstring(name) + _t("-left"), tokens[1], important);
-											add_parsed_property(tstring(name) + _t("-bottom"), tokens[2], important);
-										}
-										else if (tokens.size() == 2)
-										{
-											add_parsed_property(tstring(name) + _t("-top"), tokens[0], important);
-											add_parsed_property(tstring(name) + _t("-bottom"), tokens[0], important);
-											add_parsed_property(tstring(name) + _t("-right"), tokens[1], important);
-											add_parsed_property(tstring(name) + _t("-left"), tokens[1], important);
-										}
-										else if (tokens.size() == 1)
-										{
-											add_parsed_property(tstring(name) + _t("-top"), tokens[0], important);
-											add_parsed_property(tstring(name) + _t("-bottom"), tokens[0], important);
-											add_parsed_property(tstring(name) + _t("-right"), tokens[0], important);
-											add_parsed_property(tstring(name) + _t("-left"), tokens[0], important);
-										}
-									}
-									else
-
-
-										// Parse border-* shorthand properties 
-										if (!t_strcmp(name, _t("border-left")) ||
-											!t_strcmp(name, _t("border-right")) ||
-											!t_strcmp(name, _t("border-top")) ||
-											!t_strcmp(name, _t("border-bottom")) ||
-											!t_strcmp(name, _t("border-front")) ||
-											!t_strcmp(name, _t("border-back")))
-										{
-											parse_short_border(name, val, important);
-										}
-										else
-
-											// Parse border-width/style/color shorthand properties 
-											if (!t_strcmp(name, _t("border-width")) ||
-												!t_strcmp(name, _t("border-style")) ||
-												!t_strcmp(name, _t("border-color")))
-											{
-												string_vector nametokens;
-												split_string(name, nametokens, _t("-"));
-
-												string_vector tokens;
-												split_string(val, tokens, _t(" "));
-												if (tokens.size() >= 4)
-												{
-													add_parsed_property(nametokens[0] + _t("-top-") + nametokens[1], tokens[0], important);
-													add_parsed_property(nametokens[0] + _t("-right-") + nametokens[1], tokens[1], important);
-													add_parsed_property(nametokens[0] + _t("-bottom-") + nametokens[1], tokens[2], important);
-													add_parsed_property(nametokens[0] + _t("-left-") + nametokens[1], tokens[3], important);
-												}
-												else if (tokens.size() == 3)
-												{
-													add_parsed_property(nametokens[0] + _t("-top-") + nametokens[1], tokens[0], important);
-													add_parsed_property(nametokens[0] + _t("-right-") + nametokens[1], tokens[1], important);
-													add_parsed_property(nametokens[0] + _t("-left-") + nametokens[1], tokens[1], important);
-													add_parsed_property(nametokens[0] + _t("-bottom-") + nametokens[1], tokens[2], important);
-												}
-												else if (tokens.size() == 2)
-												{
-													add_parsed_property(nametokens[0] + _t("-top-") + nametokens[1], tokens[0], important);
-													add_parsed_property(nametokens[0] + _t("-bottom-") + nametokens[1], tokens[0], important);
-													add_parsed_property(nametokens[0] + _t("-right-") + nametokens[1], tokens[1], important);
-													add_parsed_property(nametokens[0] + _t("-left-") + nametokens[1], tokens[1], important);
-												}
-												else if (tokens.size() == 1)
-												{
-													add_parsed_property(nametokens[0] + _t("-top-") + nametokens[1], tokens[0], important);
-													add_parsed_property(nametokens[0] + _t("-bottom-") + nametokens[1], tokens[0], important);
-													add_parsed_property(nametokens[0] + _t("-right-") + nametokens[1], tokens[0], important);
-													add_parsed_property(nametokens[0] + _t("-left-") + nametokens[1], tokens[0], important);
-												}
-											}
-											else
-
-												// Parse font shorthand properties 
-												if (!t_strcmp(name, _t("font")))
-												{
-													parse_short_font(val, important);
-												}
-												else
-												{
-													add_parsed_property(name, val, important);
-												}
+	string_vector tokens;
+	split_string(val, tokens, _t(" "));
+	if (!tokens.empty())
+	{
+		const int* src = sources[std::min((int)tokens.size(), 4) - 1];
+		for (int i = 0; i < 4; i++)
+		{
+			add_parsed_property(longhands[i], tokens[src[i]], important);
+		}
+	}
 }
 
-void litehtml::style::parse_short_border(const tstring& prefix, const tstring& val, bool important)
+void litehtml::style::parse_short_list_style(const tchar_t* const* longhands, const tstring& val, const tchar_t* baseurl, bool important)
 {
+	add_parsed_property(longhands[0], _t("disc"), important);
+	add_parsed_property(longhands[1], _t("outside"), important);
+	add_parsed_property(longhands[2], _t(""), important);
+	add_parsed_property(longhands[3], _t(""), important);
+
 	string_vector tokens;
 	split_string(val, tokens, _t(" "), _t(""), _t("("));
-	if (tokens.size() >= 3)
-	{
-		add_parsed_property(prefix + _t("-width"), tokens[0], important);
-		add_parsed_property(prefix + _t("-style"), tokens[1], important);
-		add_parsed_property(prefix + _t("-color"), tokens[2], important);
-	}
-	else if (tokens.size() == 2)
+	for (string_vector::iterator tok = tokens.begin(); tok != tokens.end(); tok++)
 	{
-		if (iswdigit(tokens[0][0]) || value_index(val.c_str(), border_width_strings) >= 0)
+		if (list_style_type_keywords.contains(*tok))
 		{
-			add_parsed_property(prefix + _t("-width"), tokens[0], important);
-			add_parsed_property(prefix + _t("-style"), tokens[1], important);
+			add_parsed_property(longhands[0], *tok, important);
 		}
-		else
+		else if (list_style_position_keywords.contains(*tok))
 		{
-			add_parsed_property(prefix + _t("-style"), tokens[0], important);
-			add_parsed_property(prefix + _t("-color"), tokens[1], important);
+			add_parsed_property(longhands[1], *tok, important);
+		}
+		else if (!t_strncmp(tok->c_str(), _t("url"), 3))
+		{
+			add_parsed_property(longhands[2], *tok, important);
+			if (baseurl)
+			{
+				add_parsed_property(longhands[3], baseurl, important);
+			}
 		}
 	}
 }
@@ -596,15 +479,15 @@ void litehtml::style::parse_short_background(const tstring& val, const tchar_t*
 			}
 
 		}
-		else if (value_in_list(tok->c_str(), background_repeat_strings))
+		else if (background_repeat_keywords.contains(*tok))
 		{
 			add_parsed_property(_t("background-repeat"), *tok, important);
 		}
-		else if (value_in_list(tok->c_str(), background_attachment_strings))
+		else if (background_attachment_keywords.contains(*tok))
 		{
 			add_parsed_property(_t("background-attachment"), *tok, important);
 		}
-		else if (value_in_list(tok->c_str(), background_box_strings))
+		else if (background_box_keywords.contains(*tok))
 		{
 			if (!origin_found)
 			{
@@ -652,7 +535,7 @@ void litehtml::style::parse_short_font(const tstring& val, bool important)
 	tstring font_family;
 	for (string_vector::iterator tok = tokens.begin(); tok != tokens.end(); tok++)
 	{
-		idx = value_index(tok->c_str(), font_style_strings);
+		idx = font_style_keywords.find(*tok);
 		if (!is_family)
 		{
 			if (idx >= 0)
@@ -670,13 +553,13 @@ void litehtml::style::parse_short_font(const tstring& val, bool important)
 			}
 			else
 			{
-				if (value_in_list(tok->c_str(), font_weight_strings))
+				if (font_weight_keywords.contains(*tok))
 				{
 					add_parsed_property(_t("font-weight"), *tok, important);
 				}
 				else
 				{
-					if (value_in_list(tok->c_str(), font_variant_strings))
+					if (font_variant_keywords.contains(*tok))
 					{
 						add_parsed_property(_t("font-variant"), *tok, important);
 					}
@@ -725,20 +608,26 @@ void litehtml::style::add_parsed_property(const tstring& name, const tstring& va
 
 	if (is_valid)
 	{
-		props_map::iterator prop = m_properties.find(name);
-		if (prop != m_properties.end())
-		{
-			if (!prop->second.m_important || (important && prop->second.m_important))
-			{
-				prop->second.m_value = val;
-				prop->second.m_important = important;
-			}
-		}
-		else
+		property_value prop(val.c_str(), important);
+		parse_typed_value(name, prop);
+		set_property(name, prop);
+	}
+}
+
+void litehtml::style::set_property(const tstring& name, const property_value& val)
+{
+	props_map::iterator prop = m_properties.find(name);
+	if (prop != m_properties.end())
+	{
+		if (!prop->second.m_important || val.m_important)
 		{
-			m_properties[name] = property_value(val.c_str(), important);
+			prop->second = val;
 		}
 	}
+	else
+	{
+		m_properties[name] = val;
+	}
 }
 
 void litehtml::style::remove_property(const tstring& name, bool important)
@@ -3,76 +3,443 @@
 #include <algorithm>
 #include "document.h"
 
-void litehtml::css::parse_stylesheet(const tchar_t* str, const tchar_t* baseurl, const std::shared_ptr<document>& doc, const media_query_list::ptr& media)
+namespace
 {
-	tstring text = str;
+	// Skips the comment started at pos ("/*"), returns the position after the comment
+	const litehtml::tchar_t* skip_comment(const litehtml::tchar_t* pos, const litehtml::tchar_t* end)
+	{
+		for (pos += 2; pos < end; pos++)
+		{
+			if (pos[0] == _t('*') && pos + 1 < end && pos[1] == _t('/'))
+			{
+				return pos + 2;
+			}
+		}
+		return end;
+	}
 
-	// remove comments
-	tstring::size_type c_start = text.find(_t("/*"));
-	while (c_start != tstring::npos)
+	// Skips the string started at pos (quote char), returns the position after the closing quote
+	const litehtml::tchar_t* skip_string(const litehtml::tchar_t* pos, const litehtml::tchar_t* end)
 	{
-		tstring::size_type c_end = text.find(_t("*/"), c_start + 2);
-		text.erase(c_start, c_end - c_start + 2);
-		c_start = text.find(_t("/*"));
+		litehtml::tchar_t quote = *pos;
+		for (pos++; pos < end; pos++)
+		{
+			if (*pos == _t('\\') && pos + 1 < end)
+			{
+				pos++;
+			}
+			else if (*pos == quote)
+			{
+				return pos + 1;
+			}
+		}
+		return end;
 	}
 
-	tstring::size_type pos = text.find_first_not_of(_t(" \n\r\t"));
-	while (pos != tstring::npos)
+	inline bool is_comment_start(const litehtml::tchar_t* pos, const litehtml::tchar_t* end)
 	{
-		while (pos != tstring::npos && text[pos] == _t('@'))
+		return pos[0] == _t('/') && pos + 1 < end && pos[1] == _t('*');
+	}
+
+	// Skips white spaces and comments
+	const litehtml::tchar_t* skip_spaces(const litehtml::tchar_t* pos, const litehtml::tchar_t* end)
+	{
+		while (pos < end)
 		{
-			tstring::size_type sPos = pos;
-			pos = text.find_first_of(_t("{;"), pos);
-			if (pos != tstring::npos && text[pos] == _t('{'))
+			if (is_comment_start(pos, end))
 			{
-				pos = find_close_bracket(text, pos, _t('{'), _t('}'));
+				pos = skip_comment(pos, end);
 			}
-			if (pos != tstring::npos)
+			else if (*pos == _t(' ') || *pos == _t('\n') || *pos == _t('\r') || *pos == _t('\t'))
 			{
-				parse_atrule(text.substr(sPos, pos - sPos + 1), baseurl, doc, media);
+				pos++;
 			}
 			else
 			{
-				parse_atrule(text.substr(sPos), baseurl, doc, media);
+				break;
 			}
+		}
+		return pos;
+	}
 
-			if (pos != tstring::npos)
+	// Finds the first of the stop chars outside of comments, strings and brackets.
+	// Returns end if nothing was found.
+	const litehtml::tchar_t* find_stop(const litehtml::tchar_t* pos, const litehtml::tchar_t* end, const litehtml::tchar_t* stop)
+	{
+		int depth = 0;
+		while (pos < end)
+		{
+			if (is_comment_start(pos, end))
+			{
+				pos = skip_comment(pos, end);
+				continue;
+			}
+			if (*pos == _t('"') || *pos == _t('\''))
 			{
-				pos = text.find_first_not_of(_t(" \n\r\t"), pos + 1);
+				pos = skip_string(pos, end);
+				continue;
 			}
+			if (!depth)
+			{
+				for (const litehtml::tchar_t* ch = stop; *ch; ch++)
+				{
+					if (*ch == *pos)
+					{
+						return pos;
+					}
+				}
+			}
+			if (*pos == _t('('))
+			{
+				depth++;
+			}
+			else if (*pos == _t(')') && depth)
+			{
+				depth--;
+			}
+			pos++;
 		}
+		return end;
+	}
 
-		if (pos == tstring::npos)
+	// Finds the '}' closing the block opened at pos. Returns end for unclosed blocks.
+	const litehtml::tchar_t* find_block_end(const litehtml::tchar_t* pos, const litehtml::tchar_t* end)
+	{
+		int depth = 0;
+		while (pos < end)
 		{
-			break;
+			if (is_comment_start(pos, end))
+			{
+				pos = skip_comment(pos, end);
+				continue;
+			}
+			if (*pos == _t('"') || *pos == _t('\''))
+			{
+				pos = skip_string(pos, end);
+				continue;
+			}
+			if (*pos == _t('{'))
+			{
+				depth++;
+			}
+			else if (*pos == _t('}'))
+			{
+				if (!--depth)
+				{
+					return pos;
+				}
+			}
+			pos++;
 		}
+		return end;
+	}
 
-		tstring::size_type style_start = text.find(_t("{"), pos);
-		tstring::size_type style_end = text.find(_t("}"), pos);
-		if (style_start != tstring::npos && style_end != tstring::npos)
+	// "LHCS" - the signature of the binary stylesheets written by css::save
+	const int css_binary_signature	= 0x5343484C;
+	const int css_binary_version	= 1;
+	// the longest selector chain css::load accepts
+	const int css_max_selector_length	= 256;
+
+	void save_selector(litehtml::binary_writer& out, const litehtml::css_selector& sel)
+	{
+		out.write_int(sel.m_specificity.a);
+		out.write_int(sel.m_specificity.b);
+		out.write_int(sel.m_specificity.c);
+		out.write_int(sel.m_specificity.d);
+		out.write_int(sel.m_order);
+		out.write_int(sel.m_combinator);
+		out.write_string(sel.m_right.m_tag);
+		out.write_int((int) sel.m_right.m_attrs.size());
+		for (const auto& attr : sel.m_right.m_attrs)
+		{
+			out.write_string(attr.attribute);
+			out.write_string(attr.val);
+			out.write_int((int) attr.class_val.size());
+			for (const auto& cls : attr.class_val)
+			{
+				out.write_string(cls);
+			}
+			out.write_int(attr.condition);
+		}
+		out.write_bool(sel.m_left != nullptr);
+		if (sel.m_left)
+		{
+			save_selector(out, *sel.m_left);
+		}
+	}
+
+	// Reads a selector and its left parts in the order save_selector writes them
+	litehtml::css_selector::ptr load_selector(litehtml::binary_reader& in)
+	{
+		litehtml::css_selector::ptr first;
+		litehtml::css_selector::ptr last;
+		for (int length = 0; ; length++)
+		{
+			if (length == css_max_selector_length)
+			{
+				in.fail();
+				break;
+			}
+			litehtml::css_selector::ptr sel = std::make_shared<litehtml::css_selector>(litehtml::media_query_list::ptr());
+			sel->m_specificity.a = in.read_int();
+			sel->m_specificity.b = in.read_int();
+			sel->m_specificity.c = in.read_int();
+			sel->m_specificity.d = in.read_int();
+			sel->m_order = in.read_int();
+			int combinator = in.read_int();
+			if (combinator < litehtml::combinator_descendant || combinator > litehtml::combinator_general_sibling)
+			{
+				in.fail();
+			}
+			sel->m_combinator = (litehtml::css_combinator) combinator;
+			sel->m_right.m_tag = in.read_string();
+			int attrs_count = in.read_count();
+			sel->m_right.m_attrs.resize(attrs_count);
+			for (auto& attr : sel->m_right.m_attrs)
+			{
+				attr.attribute = in.read_string();
+				attr.val = in.read_string();
+				int classes_count = in.read_count();
+				for (int i = 0; i < classes_count; i++)
+				{
+					attr.class_val.push_back(in.read_string());
+				}
+				int condition = in.read_int();
+				if (condition < litehtml::select_exists || condition > litehtml::select_pseudo_element)
+				{
+					in.fail();
+				}
+				attr.condition = (litehtml::attr_select_condition) condition;
+			}
+			if (last)
+			{
+				last->m_left = sel;
+			}
+			else
+			{
+				first = sel;
+			}
+			last = sel;
+			if (!in.read_bool() || in.failed())
+			{
+				break;
+			}
+		}
+		return first;
+	}
+
+	// Appends the text between begin and end to out, dropping the comments
+	void append_text(litehtml::tstring& out, const litehtml::tchar_t* begin, const litehtml::tchar_t* end)
+	{
+		const litehtml::tchar_t* pos = begin;
+		while (pos < end)
+		{
+			if (is_comment_start(pos, end))
+			{
+				out.append(begin, pos);
+				pos = begin = skip_comment(pos, end);
+				continue;
+			}
+			if (*pos == _t('"') || *pos == _t('\''))
+			{
+				pos = skip_string(pos, end);
+				continue;
+			}
+			pos++;
+		}
+		out.append(begin, end);
+	}
+}
+
+void litehtml::css::parse_stylesheet(const tchar_t* str, const tchar_t* baseurl, const std::shared_ptr<document>& doc, const media_query_list::ptr& media)
+{
+	if (str)
+	{
+		parse_stylesheet(str, str + t_strlen(str), baseurl, doc, media);
+	}
+}
+
+void litehtml::css::parse_stylesheet(const tchar_t* begin, const tchar_t* end, const tchar_t* baseurl, const std::shared_ptr<document>& doc, const media_query_list::ptr& media)
+{
+	tstring text;
+	const tchar_t* pos = skip_spaces(begin, end);
+	while (pos < end)
+	{
+		if (*pos == _t('@'))
+		{
+			pos = parse_atrule(pos, end, baseurl, doc, media);
+		}
+		else
 		{
+			const tchar_t* style_start = find_stop(pos, end, _t("{"));
+			if (style_start == end)
+			{
+				break;
+			}
+			const tchar_t* style_end = find_block_end(style_start, end);
+
 			style::ptr st = std::make_shared<style>();
-			st->add(text.substr(style_start + 1, style_end - style_start - 1).c_str(), baseurl);
+			parse_declarations(style_start + 1, style_end, st, baseurl);
 
-			parse_selectors(text.substr(pos, style_start - pos), st, media);
+			text.clear();
+			append_text(text, pos, style_start);
+			parse_selectors(text, st, media);
 
 			if (media && doc)
 			{
 				doc->add_media_list(media);
 			}
 
-			pos = style_end + 1;
+			pos = style_end < end ? style_end + 1 : end;
 		}
-		else
+		pos = skip_spaces(pos, end);
+	}
+}
+
+void litehtml::css::parse_declarations(const tchar_t* begin, const tchar_t* end, const style::ptr& st, const tchar_t* baseurl)
+{
+	tstring text;
+	const tchar_t* pos = begin;
+	while (pos < end)
+	{
+		const tchar_t* decl_end = find_stop(pos, end, _t(";"));
+		text.clear();
+		append_text(text, pos, decl_end);
+		st->parse_property(text, baseurl);
+		// the last declaration may have no ';', don't step past the end
+		pos = decl_end < end ? decl_end + 1 : end;
+	}
+}
+
+void litehtml::css::add_selectors(const css& src)
+{
+	// src is left untouched: the selectors are copied to get their own order,
+	// the selector chains and the declarations are shared
+	m_selectors.reserve(m_selectors.size() + src.m_selectors.size());
+	for (const auto& sel : src.m_selectors)
+	{
+		css_selector::ptr copy = std::make_shared<css_selector>(sel->m_media_query);
+		copy->m_right = sel->m_right;
+		copy->m_left = sel->m_left;
+		copy->m_combinator = sel->m_combinator;
+		copy->m_specificity = sel->m_specificity;
+		copy->m_style = sel->m_style;
+		add_selector(copy);
+	}
+}
+
+bool litehtml::css::has_media_queries() const
+{
+	for (const auto& sel : m_selectors)
+	{
+		if (sel->m_media_query)
 		{
-			pos = tstring::npos;
+			return true;
 		}
+	}
+	return false;
+}
 
-		if (pos != tstring::npos)
+bool litehtml::css::save(byte_vector& data) const
+{
+	// the declarations are shared by all selectors of a rule, so they are stored once
+	std::map<const style*, int> style_ids;
+	std::vector<const style*> styles;
+	for (const auto& sel : m_selectors)
+	{
+		// media queries are bound to a document and can't be stored
+		if (sel->m_media_query)
 		{
-			pos = text.find_first_not_of(_t(" \n\r\t"), pos);
+			return false;
+		}
+		// neither can the selectors css::load would reject
+		int length = 0;
+		for (const css_selector* part = sel.get(); part; part = part->m_left.get())
+		{
+			length++;
+		}
+		if (length > css_max_selector_length || !sel->m_style)
+		{
+			return false;
+		}
+		if (style_ids.find(sel->m_style.get()) == style_ids.end())
+		{
+			style_ids[sel->m_style.get()] = (int) styles.size();
+			styles.push_back(sel->m_style.get());
+		}
+	}
+
+	binary_writer out(data);
+	out.write_int(css_binary_signature);
+	out.write_int(css_binary_version);
+	out.write_int((int) sizeof(tchar_t));
+
+	out.write_int((int) styles.size());
+	for (const auto st : styles)
+	{
+		out.write_int((int) st->properties().size());
+		for (const auto& prop : st->properties())
+		{
+			out.write_string(prop.first);
+			out.write_string(prop.second.m_value);
+			out.write_bool(prop.second.m_important);
 		}
 	}
+
+	out.write_int((int) m_selectors.size());
+	for (const auto& sel : m_selectors)
+	{
+		out.write_int(style_ids[sel->m_style.get()]);
+		save_selector(out, *sel);
+	}
+	return true;
+}
+
+bool litehtml::css::load(const unsigned char* data, size_t size)
+{
+	m_selectors.clear();
+
+	binary_reader in(data, size);
+	if (in.read_int() != css_binary_signature || in.read_int() != css_binary_version || in.read_int() != (int) sizeof(tchar_t))
+	{
+		return false;
+	}
+
+	style::vector styles(in.read_count());
+	for (auto& st : styles)
+	{
+		st = std::make_shared<style>();
+		int props_count = in.read_count();
+		for (int i = 0; i < props_count && !in.failed(); i++)
+		{
+			tstring name = in.read_string();
+			tstring val = in.read_string();
+			st->add_parsed_property(name, val, in.read_bool());
+		}
+	}
+
+	int selectors_count = in.read_count();
+	m_selectors.reserve(selectors_count);
+	for (int i = 0; i < selectors_count && !in.failed(); i++)
+	{
+		// the elements use the declarations of the matched selectors without checking them
+		int style_id = in.read_int();
+		css_selector::ptr sel = load_selector(in);
+		if (style_id < 0 || style_id >= (int) styles.size())
+		{
+			in.fail();
+			break;
+		}
+		sel->m_style = styles[style_id];
+		m_selectors.push_back(sel);
+	}
+
+	if (in.failed() || !in.at_end())
+	{
+		m_selectors.clear();
+		return false;
+	}
+	return true;
 }
 
 void litehtml::css::parse_css_url(const tstring& str, tstring& url)
@@ -135,88 +502,83 @@ void litehtml::css::sort_selectors()
 	);
 }
 
-void litehtml::css::parse_atrule(const tstring& text, const tchar_t* baseurl, const std::shared_ptr<document>& doc, const media_query_list::ptr& media)
+const litehtml::tchar_t* litehtml::css::parse_atrule(const tchar_t* begin, const tchar_t* end, const tchar_t* baseurl, const std::shared_ptr<document>& doc, const media_query_list::ptr& media)
 {
-	if (text.substr(0, 7) == _t("@import"))
+	const tchar_t* pos = find_stop(begin, end, _t("{;"));
+	if (pos < end && *pos == _t('{'))
 	{
-		int sPos = 7;
-		tstring iStr;
-		iStr = text.substr(sPos);
-		if (iStr[iStr.length() - 1] == _t(';'))
+		const tchar_t* block_end = find_block_end(pos, end);
+		if (end - begin >= 6 && !t_strncmp(begin, _t("@media"), 6))
 		{
-			iStr.erase(iStr.length() - 1);
+			tstring media_type;
+			append_text(media_type, begin + 6, pos);
+			trim(media_type);
+			media_query_list::ptr new_media = media_query_list::create_from_string(media_type, doc);
+
+			parse_stylesheet(pos + 1, block_end, baseurl, doc, new_media);
 		}
-		trim(iStr);
-		string_vector tokens;
-		split_string(iStr, tokens, _t(" "), _t(""), _t("(\""));
-		if (!tokens.empty())
+		return block_end < end ? block_end + 1 : end;
+	}
+
+	if (end - begin >= 7 && !t_strncmp(begin, _t("@import"), 7))
+	{
+		tstring text;
+		append_text(text, begin + 7, pos);
+		parse_import(text, baseurl, doc, media);
+	}
+	return pos < end ? pos + 1 : end;
+}
+
+void litehtml::css::parse_import(const tstring& text, const tchar_t* baseurl, const std::shared_ptr<document>& doc, const media_query_list::ptr& media)
+{
+	tstring iStr = text;
+	trim(iStr);
+	string_vector tokens;
+	split_string(iStr, tokens, _t(" "), _t(""), _t("(\""));
+	if (!tokens.empty())
+	{
+		tstring url;
+		parse_css_url(tokens.front(), url);
+		if (url.empty())
 		{
-			tstring url;
-			parse_css_url(tokens.front(), url);
-			if (url.empty())
-			{
-				url = tokens.front();
-			}
-			tokens.erase(tokens.begin());
-			if (doc)
+			url = tokens.front();
+		}
+		tokens.erase(tokens.begin());
+		if (doc)
+		{
+			document_container* doc_cont = doc->container();
+			if (doc_cont)
 			{
-				document_container* doc_cont = doc->container();
-				if (doc_cont)
+				tstring css_text;
+				tstring css_baseurl;
+				if (baseurl)
 				{
-					tstring css_text;
-					tstring css_baseurl;
-					if (baseurl)
-					{
-						css_baseurl = baseurl;
-					}
-					doc_cont->import_css(css_text, url, css_baseurl);
-					if (!css_text.empty())
+					css_baseurl = baseurl;
+				}
+				doc_cont->import_css(css_text, url, css_baseurl);
+				if (!css_text.empty())
+				{
+					media_query_list::ptr new_media = media;
+					if (!tokens.empty())
 					{
-						media_query_list::ptr new_media = media;
-						if (!tokens.empty())
+						tstring media_str;
+						for (string_vector::iterator iter = tokens.begin(); iter != tokens.end(); iter++)
 						{
-							tstring media_str;
-							for (string_vector::iterator iter = tokens.begin(); iter != tokens.end(); iter++)
-							{
-								if (iter != tokens.begin())
-								{
-									media_str += _t(" ");
-								}
-								media_str += (*iter);
-							}
-							new_media = media_query_list::create_from_string(media_str, doc);
-							if (!new_media)
+							if (iter != tokens.begin())
 							{
-								new_media = media;
+								media_str += _t(" ");
 							}
+							media_str += (*iter);
+						}
+						new_media = media_query_list::create_from_string(media_str, doc);
+						if (!new_media)
+						{
+							new_media = media;
 						}
-						parse_stylesheet(css_text.c_str(), css_baseurl.c_str(), doc, new_media);
 					}
+					parse_stylesheet(css_text.c_str(), css_baseurl.c_str(), doc, new_media);
 				}
 			}
 		}
 	}
-	else if (text.substr(0, 6) == _t("@media"))
-	{
-		tstring::size_type b1 = text.find_first_of(_t('{'));
-		tstring::size_type b2 = text.find_last_of(_t('}'));
-		if (b1 != tstring::npos)
-		{
-			tstring media_type = text.substr(6, b1 - 6);
-			trim(media_type);
-			media_query_list::ptr new_media = media_query_list::create_from_string(media_type, doc);
-
-			tstring media_style;
-			if (b2 != tstring::npos)
-			{
-				media_style = text.substr(b1 + 1, b2 - b1 - 1);
-			}
-			else
-			{
-				media_style = text.substr(b1 + 1);
-			}
-
-			parse_stylesheet(media_style.c_str(), baseurl, doc, new_media);
-		}
-	}
 }
@@ -23,6 +23,25 @@ void litehtml::table_grid::add_cell(element::ptr& el)
 	}
 }
 
+void litehtml::table_grid::add_column(element::ptr& el)
+{
+	css_length width = el->get_css_width();
+	if (width.is_predefined())
+	{
+		const tchar_t* str = el->get_attr(_t("width"));
+		if (str)
+		{
+			width.fromString(str, _t("auto"), 0);
+		}
+	}
+
+	int span = t_atoi(el->get_attr(_t("span"), _t("1")));
+	for (int i = 0; i < std::max(span, 1); i++)
+	{
+		m_css_col_widths.push_back(width);
+	}
+}
+
 void litehtml::table_grid::begin_row(element::ptr& row)
 {
 	std::vector<table_cell> r;
@@ -126,6 +145,34 @@ void litehtml::table_grid::finish()
 		}
 	}
 
+	// the fixed table layout takes the column widths from the <col> elements or from the cells of the first row
+	for (int col = 0; col < m_cols_count; col++)
+	{
+		if (col < (int)m_css_col_widths.size() && !m_css_col_widths[col].is_predefined())
+		{
+			m_columns[col].css_fixed_width = m_css_col_widths[col];
+			if (m_columns[col].css_width.is_predefined())
+			{
+				m_columns[col].css_width = m_css_col_widths[col];
+			}
+		}
+	}
+	for (int col = 0; col < m_cols_count && m_rows_count; col++)
+	{
+		table_cell* first = cell(col, 0);
+		if (first->el && !first->el->get_css_width().is_predefined())
+		{
+			for (int span_col = col; span_col < col + first->colspan && span_col < m_cols_count; span_col++)
+			{
+				if (m_columns[span_col].css_fixed_width.is_predefined())
+				{
+					m_columns[span_col].css_fixed_width = first->el->get_css_width();
+					m_columns[span_col].fixed_from_cell = true;
+				}
+			}
+		}
+	}
+
 	for (int col = 0; col < m_cols_count; col++)
 	{
 		for (int row = 0; row < m_rows_count; row++)
@@ -386,6 +433,84 @@ int litehtml::table_grid::calc_table_width(int block_width, bool is_auto, int& m
 	return cur_width;
 }
 
+int litehtml::table_grid::calc_fixed_table_width(int block_width)
+{
+	int cur_width = 0;
+	int auto_count = 0;
+
+	for (int col = 0; col < m_cols_count; col++)
+	{
+		m_columns[col].width = 0;
+		if (m_columns[col].css_fixed_width.is_predefined())
+		{
+			auto_count++;
+		}
+		else if (!m_columns[col].fixed_from_cell)
+		{
+			m_columns[col].width = m_columns[col].css_fixed_width.calc_percent(block_width);
+		}
+	}
+
+	// the cells of the first row define the widths of the columns they span, including the cell padding and borders
+	for (int col = 0; col < m_cols_count && m_rows_count; col++)
+	{
+		table_cell* first = cell(col, 0);
+		if (first->el && m_columns[col].fixed_from_cell)
+		{
+			first->el->calc_outlines(block_width);
+			int w = m_columns[col].css_fixed_width.calc_percent(block_width);
+			if (m_columns[col].css_fixed_width.units() != css_units_percentage)
+			{
+				w += first->el->content_margins_left() + first->el->content_margins_right();
+			}
+			int span = std::min(first->colspan, m_cols_count - col);
+			for (int i = 0; i < span; i++)
+			{
+				if (m_columns[col + i].fixed_from_cell)
+				{
+					m_columns[col + i].width = w / span + (i < w % span ? 1 : 0);
+				}
+			}
+		}
+	}
+
+	for (int col = 0; col < m_cols_count; col++)
+	{
+		cur_width += m_columns[col].width;
+	}
+
+	if (auto_count)
+	{
+		// the rest of the width is divided equally between the auto columns
+		int rest = std::max(block_width - cur_width, 0);
+		int i = 0;
+		for (int col = 0; col < m_cols_count; col++)
+		{
+			if (m_columns[col].css_fixed_width.is_predefined())
+			{
+				m_columns[col].width = rest / auto_count + (i < rest % auto_count ? 1 : 0);
+				i++;
+			}
+		}
+		cur_width += rest;
+	}
+	else if (cur_width < block_width && m_cols_count)
+	{
+		// no auto columns: the extra width is distributed over the columns proportionally
+		int extra = block_width - cur_width;
+		int added_width = 0;
+		for (int col = 0; col < m_cols_count; col++)
+		{
+			int add = cur_width ? extra * m_columns[col].width / cur_width : extra / m_cols_count;
+			m_columns[col].width += add;
+			added_width += add;
+		}
+		m_columns[0].width += extra - added_width;
+		cur_width = block_width;
+	}
+	return cur_width;
+}
+
 void litehtml::table_grid::clear()
 {
 	m_rows_count = 0;
@@ -393,6 +518,17 @@ void litehtml::table_grid::clear()
 	m_cells.clear();
 	m_columns.clear();
 	m_rows.clear();
+	m_css_col_widths.clear();
+}
+
+size_t litehtml::table_grid::memory_size() const
+{
+	size_t size = sizeof(table_grid) + vector_memory(m_cells) + vector_memory(m_columns) + vector_memory(m_rows) + vector_memory(m_css_col_widths);
+	for (const auto& row : m_cells)
+	{
+		size += vector_memory(row);
+	}
+	return size;
 }
 
 void litehtml::table_grid::calc_horizontal_positions(margins& table_borders, border_collapse bc, int bdr_space_x)
@@ -1,6 +1,7 @@
 #include "html.h"
 #include "web_color.h"
 #include <string.h>
+#include <math.h>
 
 litehtml::def_color litehtml::g_def_colors[] =
 {
@@ -154,88 +155,297 @@ litehtml::def_color litehtml::g_def_colors[] =
 };
 
 
-litehtml::web_color litehtml::web_color::from_string(const tchar_t* str, litehtml::document_container* callback)
+namespace
 {
-	if (!str || !str[0])
+	inline litehtml::tchar_t lower_char(litehtml::tchar_t c)
 	{
-		return web_color(0, 0, 0);
+		return (c >= _t('A') && c <= _t('Z')) ? c - _t('A') + _t('a') : c;
+	}
+
+	inline bool is_space(litehtml::tchar_t c)
+	{
+		return c == _t(' ') || c == _t('\t') || c == _t('\n') || c == _t('\r');
+	}
+
+	inline int hex_digit(litehtml::tchar_t c)
+	{
+		if (c >= _t('0') && c <= _t('9')) return c - _t('0');
+		if (c >= _t('a') && c <= _t('f')) return c - _t('a') + 10;
+		if (c >= _t('A') && c <= _t('F')) return c - _t('A') + 10;
+		return -1;
+	}
+
+	inline litehtml::byte clamp_byte(double val)
+	{
+		if (val <= 0) return 0;
+		if (val >= 255) return 255;
+		return (litehtml::byte) (val + 0.5);
 	}
-	if (str[0] == _t('#'))
+
+	// #rgb, #rgba, #rrggbb and #rrggbbaa
+	bool parse_hex_color(const litehtml::tchar_t* str, litehtml::web_color& clr)
 	{
-		tstring red = _t("");
-		tstring green = _t("");
-		tstring blue = _t("");
-		if (t_strlen(str + 1) == 3)
+		int digits[8];
+		int len = 0;
+		for (str++; *str && len < 8; str++, len++)
 		{
-			red += str[1];
-			red += str[1];
-			green += str[2];
-			green += str[2];
-			blue += str[3];
-			blue += str[3];
+			digits[len] = hex_digit(*str);
+			if (digits[len] < 0)
+			{
+				return false;
+			}
 		}
-		else if (t_strlen(str + 1) == 6)
+		if (*str)
 		{
-			red += str[1];
-			red += str[2];
-			green += str[3];
-			green += str[4];
-			blue += str[5];
-			blue += str[6];
+			return false;
 		}
-		tchar_t* sss = 0;
-		web_color clr;
-		clr.red = (byte)t_strtol(red.c_str(), &sss, 16);
-		clr.green = (byte)t_strtol(green.c_str(), &sss, 16);
-		clr.blue = (byte)t_strtol(blue.c_str(), &sss, 16);
-		return clr;
+		switch (len)
+		{
+		case 3:
+		case 4:
+			clr.red		= (litehtml::byte) (digits[0] * 17);
+			clr.green	= (litehtml::byte) (digits[1] * 17);
+			clr.blue	= (litehtml::byte) (digits[2] * 17);
+			clr.alpha	= len == 4 ? (litehtml::byte) (digits[3] * 17) : 255;
+			return true;
+		case 6:
+		case 8:
+			clr.red		= (litehtml::byte) (digits[0] * 16 + digits[1]);
+			clr.green	= (litehtml::byte) (digits[2] * 16 + digits[3]);
+			clr.blue	= (litehtml::byte) (digits[4] * 16 + digits[5]);
+			clr.alpha	= len == 8 ? (litehtml::byte) (digits[6] * 16 + digits[7]) : 255;
+			return true;
+		}
+		return false;
+	}
+
+	// Parses the numeric arguments of rgb() or hsl(), returns the number of the parsed values
+	int parse_color_args(const litehtml::tchar_t* pos, double* vals, bool* percents, int max_count)
+	{
+		int count = 0;
+		while (*pos && *pos != _t(')') && count < max_count)
+		{
+			if (is_space(*pos) || *pos == _t(',') || *pos == _t('/'))
+			{
+				pos++;
+				continue;
+			}
+			litehtml::tchar_t* end = nullptr;
+			double val = t_strtod(pos, &end);
+			if (end == pos)
+			{
+				break;
+			}
+			pos = end;
+			percents[count] = (*pos == _t('%'));
+			// skip units like "deg" and the percent sign
+			while (*pos && !is_space(*pos) && *pos != _t(',') && *pos != _t('/') && *pos != _t(')'))
+			{
+				pos++;
+			}
+			vals[count++] = val;
+		}
+		return count;
+	}
+
+	double parse_alpha(double val, bool percent)
+	{
+		return (percent ? val / 100.0 : val) * 255.0;
+	}
+
+	double hue_to_rgb(double p, double q, double t)
+	{
+		if (t < 0) t += 1;
+		if (t > 1) t -= 1;
+		if (t < 1.0 / 6) return p + (q - p) * 6 * t;
+		if (t < 1.0 / 2) return q;
+		if (t < 2.0 / 3) return p + (q - p) * (2.0 / 3 - t) * 6;
+		return p;
+	}
+
+	// rgb(), rgba(), hsl() and hsla()
+	bool parse_color_function(const litehtml::tchar_t* str, litehtml::web_color& clr)
+	{
+		bool is_rgb = !t_strncasecmp(str, _t("rgb"), 3);
+		bool is_hsl = !is_rgb && !t_strncasecmp(str, _t("hsl"), 3);
+		if (!is_rgb && !is_hsl)
+		{
+			return false;
+		}
+		const litehtml::tchar_t* pos = str + 3;
+		while (*pos && *pos != _t('('))
+		{
+			pos++;
+		}
+		if (*pos)
+		{
+			pos++;
+		}
+
+		double vals[4];
+		bool percents[4];
+		int count = parse_color_args(pos, vals, percents, 4);
+
+		clr = litehtml::web_color();
+		if (is_rgb)
+		{
+			litehtml::byte* channels[3] = { &clr.red, &clr.green, &clr.blue };
+			for (int i = 0; i < count && i < 3; i++)
+			{
+				*channels[i] = clamp_byte(percents[i] ? vals[i] * 255.0 / 100.0 : vals[i]);
+			}
+		}
+		else if (count >= 3)
+		{
+			double h = fmod(vals[0], 360.0) / 360.0;
+			if (h < 0) h += 1;
+			double s = vals[1] / 100.0;
+			double l = vals[2] / 100.0;
+			s = s < 0 ? 0 : (s > 1 ? 1 : s);
+			l = l < 0 ? 0 : (l > 1 ? 1 : l);
+			double q = l < 0.5 ? l * (1 + s) : l + s - l * s;
+			double p = 2 * l - q;
+			clr.red		= clamp_byte(hue_to_rgb(p, q, h + 1.0 / 3) * 255.0);
+			clr.green	= clamp_byte(hue_to_rgb(p, q, h) * 255.0);
+			clr.blue	= clamp_byte(hue_to_rgb(p, q, h - 1.0 / 3) * 255.0);
+		}
+		if (count >= 4)
+		{
+			clr.alpha = clamp_byte(parse_alpha(vals[3], percents[3]));
+		}
+		return true;
 	}
-	else if (!t_strncmp(str, _t("rgb"), 3))
+
+	bool parse_color_value(const litehtml::tchar_t* str, litehtml::web_color& clr)
 	{
-		tstring s = str;
+		if (str[0] == _t('#'))
+		{
+			if (!parse_hex_color(str, clr))
+			{
+				clr = litehtml::web_color(0, 0, 0);
+			}
+			return true;
+		}
+		return parse_color_function(str, clr);
+	}
 
-		tstring::size_type pos = s.find_first_of(_t("("));
-		if (pos != tstring::npos)
+	// Case insensitive FNV-1a
+	unsigned int color_name_hash(const litehtml::tchar_t* name)
+	{
+		unsigned int hash = 2166136261u;
+		for (; *name; name++)
+		{
+			hash ^= (unsigned int) lower_char(*name);
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	// Open addressing hash table over g_def_colors with the parsed values,
+	// built once on the first use
+	class named_colors
+	{
+		static const unsigned int table_size = 1024;	// must be a power of two and well over the number of the colors
+		short								m_buckets[table_size];	// g_def_colors index + 1, 0 for an empty bucket
+		std::vector<litehtml::web_color>	m_colors;
+	public:
+		named_colors()
 		{
-			s.erase(s.begin(), s.begin() + pos + 1);
+			memset(m_buckets, 0, sizeof(m_buckets));
+			for (int i = 0; litehtml::g_def_colors[i].name; i++)
+			{
+				unsigned int b = color_name_hash(litehtml::g_def_colors[i].name) & (table_size - 1);
+				while (m_buckets[b])
+				{
+					b = (b + 1) & (table_size - 1);
+				}
+				m_buckets[b] = (short) (i + 1);
+
+				litehtml::web_color clr(0, 0, 0);
+				parse_color_value(litehtml::g_def_colors[i].rgb, clr);
+				m_colors.push_back(clr);
+			}
 		}
-		pos = s.find_last_of(_t(")"));
-		if (pos != tstring::npos)
+
+		int find(const litehtml::tchar_t* name) const
 		{
-			s.erase(s.begin() + pos, s.end());
+			unsigned int b = color_name_hash(name) & (table_size - 1);
+			while (m_buckets[b])
+			{
+				int idx = m_buckets[b] - 1;
+				if (!t_strcasecmp(name, litehtml::g_def_colors[idx].name))
+				{
+					return idx;
+				}
+				b = (b + 1) & (table_size - 1);
+			}
+			return -1;
 		}
 
-		std::vector<tstring> tokens;
-		split_string(s, tokens, _t(", \t"));
+		const litehtml::web_color& color(int idx) const
+		{
+			return m_colors[idx];
+		}
 
-		web_color clr;
+		static const named_colors& get()
+		{
+			static const named_colors colors;
+			return colors;
+		}
+	};
+}
 
-		if (tokens.size() >= 1)	clr.red = (byte)t_atoi(tokens[0].c_str());
-		if (tokens.size() >= 2)	clr.green = (byte)t_atoi(tokens[1].c_str());
-		if (tokens.size() >= 3)	clr.blue = (byte)t_atoi(tokens[2].c_str());
-		if (tokens.size() >= 4)	clr.alpha = (byte)(t_strtod(tokens[3].c_str(), 0) * 255.0);
+litehtml::web_color litehtml::web_color::from_string(const tchar_t* str, litehtml::document_container* callback)
+{
+	if (!str || !str[0])
+	{
+		return web_color(0, 0, 0);
+	}
 
+	web_color clr;
+	if (parse(str, clr))
+	{
 		return clr;
 	}
-	else
+
+	if (callback)
 	{
-		tstring rgb = resolve_name(str, callback);
-		if (!rgb.empty())
+		tstring rgb = callback->resolve_color(str);
+		if (!rgb.empty() && parse_color_value(rgb.c_str(), clr))
 		{
-			return from_string(rgb.c_str(), callback);
+			return clr;
 		}
 	}
 	return web_color(0, 0, 0);
 }
 
+bool litehtml::web_color::parse(const tchar_t* str, web_color& clr)
+{
+	if (!str || !str[0])
+	{
+		return false;
+	}
+
+	if (parse_color_value(str, clr))
+	{
+		return true;
+	}
+
+	int idx = named_colors::get().find(str);
+	if (idx >= 0)
+	{
+		clr = named_colors::get().color(idx);
+		return true;
+	}
+	return false;
+}
+
 litehtml::tstring litehtml::web_color::resolve_name(const tchar_t* name, litehtml::document_container* callback)
 {
-	for (int i = 0; g_def_colors[i].name; i++)
+	int idx = named_colors::get().find(name);
+	if (idx >= 0)
 	{
-		if (!t_strcasecmp(name, g_def_colors[i].name))
-		{
-			return std::move(litehtml::tstring(g_def_colors[i].rgb));
-		}
+		return litehtml::tstring(g_def_colors[idx].rgb);
 	}
 	if (callback)
 	{
@@ -1,8 +1,14 @@
 #include <assert.h>
+#include <thread>
+#include <vector>
 #include "litehtml.h"
+#include "litehtml/binary_stream.h"
+#include "test/container_test.h"
 using namespace litehtml;
 
 extern const tchar_t master_css[];
+extern const unsigned char master_css_bin[];
+extern const size_t master_css_bin_size;
 
 static void Test()
 {
@@ -10,7 +16,162 @@ static void Test()
 	ctx.load_master_stylesheet(master_css);
 }
 
+static void BinaryMasterStylesheetTest()
+{
+	context text_ctx;
+	text_ctx.load_master_stylesheet(master_css);
+
+	byte_vector data;
+	assert(text_ctx.master_css().save(data));
+
+	context ctx;
+	assert(ctx.load_master_stylesheet(master_css_bin, master_css_bin_size));
+	assert(ctx.master_css().selectors().size() == text_ctx.master_css().selectors().size());
+	for (size_t i = 0; i < ctx.master_css().selectors().size(); i++)
+	{
+		const css_selector::ptr& sel = ctx.master_css().selectors()[i];
+		const css_selector::ptr& text_sel = text_ctx.master_css().selectors()[i];
+		assert(sel->m_specificity == text_sel->m_specificity);
+		assert(sel->m_order == text_sel->m_order);
+		assert(sel->m_right.m_tag == text_sel->m_right.m_tag);
+		assert(sel->m_right.m_attrs.size() == text_sel->m_right.m_attrs.size());
+		assert(sel->m_style->properties().size() == text_sel->m_style->properties().size());
+	}
+
+	// truncated or foreign data is rejected
+	assert(!ctx.load_master_stylesheet(data.data(), data.size() - 1));
+	assert(ctx.master_css().selectors().empty());
+	assert(!ctx.load_master_stylesheet((const unsigned char*) master_css, 16));
+}
+
+// A binary stylesheet with one empty declaration block and one selector chain of the given length
+static byte_vector crafted_stylesheet(int style_id, int combinator, int condition, int length)
+{
+	context empty_ctx;
+	byte_vector empty;
+	assert(empty_ctx.master_css().save(empty));
+	byte_vector data(empty.begin(), empty.begin() + 3 * sizeof(int));
+	binary_writer out(data);
+	out.write_int(1);
+	out.write_int(0);
+	out.write_int(1);
+	out.write_int(style_id);
+	for (int i = 0; i < length; i++)
+	{
+		out.write_int(0);
+		out.write_int(0);
+		out.write_int(1);
+		out.write_int(1);
+		out.write_int(0);
+		out.write_int(combinator);
+		out.write_string(_t("div"));
+		out.write_int(1);
+		out.write_string(_t("class"));
+		out.write_string(_t("x"));
+		out.write_int(0);
+		out.write_int(condition);
+		out.write_bool(i != length - 1);
+	}
+	return data;
+}
+
+static void CorruptStylesheetTest()
+{
+	context ctx;
+	byte_vector data = crafted_stylesheet(0, combinator_child, select_equal, 2);
+	assert(ctx.load_master_stylesheet(data.data(), data.size()));
+	assert(ctx.master_css().selectors().size() == 1 && ctx.master_css().selectors()[0]->m_style);
+
+	// a selector without declarations or with unknown enum values is rejected
+	data = crafted_stylesheet(1, combinator_child, select_equal, 2);
+	assert(!ctx.load_master_stylesheet(data.data(), data.size()) && ctx.master_css().selectors().empty());
+	data = crafted_stylesheet(-1, combinator_child, select_equal, 2);
+	assert(!ctx.load_master_stylesheet(data.data(), data.size()));
+	data = crafted_stylesheet(0, 17, select_equal, 2);
+	assert(!ctx.load_master_stylesheet(data.data(), data.size()));
+	data = crafted_stylesheet(0, combinator_child, -3, 2);
+	assert(!ctx.load_master_stylesheet(data.data(), data.size()));
+	data = crafted_stylesheet(0, combinator_child, select_pseudo_element + 1, 1);
+	assert(!ctx.load_master_stylesheet(data.data(), data.size()));
+}
+
+static void SelectorLengthTest()
+{
+	tstring long_selector;
+	for (int i = 0; i < 300; i++)
+	{
+		long_selector += _t("div ");
+	}
+
+	// a chain longer than css::load accepts is not saved
+	context text_ctx;
+	text_ctx.load_master_stylesheet((long_selector + _t("{ color: red }")).c_str());
+	byte_vector data;
+	assert(!text_ctx.master_css().save(data));
+
+	// and the same chain in crafted data fails the load
+	byte_vector crafted = crafted_stylesheet(0, combinator_descendant, select_equal, 300);
+	context ctx;
+	assert(!ctx.load_master_stylesheet(crafted.data(), crafted.size()));
+	assert(ctx.master_css().selectors().empty());
+
+	// a shorter one loads
+	context short_ctx;
+	short_ctx.load_master_stylesheet(_t("div div div { color: red }"));
+	data.clear();
+	assert(short_ctx.master_css().save(data));
+	assert(ctx.load_master_stylesheet(data.data(), data.size()));
+	assert(ctx.master_css().selectors().size() == 1);
+}
+
+class sized_container : public container_test
+{
+public:
+	int client_width;
+	sized_container(int width) : client_width(width) {}
+	virtual void get_client_rect(position& client) const override { client = position(0, 0, 0, client_width, 0, 0); }
+};
+
+static void SharedContextTest()
+{
+	// the media query of the shared master stylesheet gives a different result for each container
+	context ctx;
+	ctx.load_master_stylesheet(_t("html, body, p { display: block } p { width: 10px } @media (max-width: 300px) { p { width: 20px } }"));
+
+	std::vector<std::thread> threads;
+	std::vector<int> results(8, 0);
+	for (int i = 0; i < (int)results.size(); i++)
+	{
+		threads.push_back(std::thread([&ctx, &results, i]()
+		{
+			bool ok = true;
+			for (int j = 0; j < 20; j++)
+			{
+				int width = (i % 2) ? 200 : 500;
+				sized_container container(width);
+				document::ptr doc = document::createFromString(_t("<html><head><style>p { height: 5px }</style></head><body><p id=\"p\"></p></body></html>"), &container, &ctx);
+				doc->render(width, render_all);
+				element::ptr p = doc->root()->select_one(_t("#p"));
+				ok = ok && p->height() == 5 && p->width() == ((i % 2) ? 20 : 10);
+			}
+			results[i] = ok ? 1 : 0;
+		}));
+	}
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		assert(results[i]);
+	}
+}
+
 void contextTest()
 {
 	Test();
+	BinaryMasterStylesheetTest();
+	SelectorLengthTest();
+	CorruptStylesheetTest();
+	SharedContextTest();
 }
\ No newline at end of file
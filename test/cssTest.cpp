@@ -20,6 +20,24 @@ static void CssParseTest() {
 	c.parse_stylesheet(_t("@media only screen and (max-width: 600px) { body { background-color: lightblue; } }"), nullptr, doc, nullptr);
 }
 
+static void CssTokenizeTest() {
+	container_test container;
+	litehtml::document::ptr doc = std::make_shared<litehtml::document>(&container, nullptr);
+	css c;
+	c.parse_stylesheet(_t("/* a { b } */ p /* c */ { color: /* ; */ red; content: \"};/*\" } @media print { /* { */ div { width: 1px } @media screen { span { height: 2px } } } em { font-style: normal"), nullptr, doc, nullptr);
+	assert(c.selectors().size() == 4);
+	assert(!t_strcmp(c.selectors()[0]->m_right.m_tag.c_str(), _t("p")));
+	assert(!t_strcmp(c.selectors()[0]->m_style->get_property(_t("color")), _t("red")));
+	assert(!t_strcmp(c.selectors()[0]->m_style->get_property(_t("content")), _t("\"};/*\"")));
+	assert(!t_strcmp(c.selectors()[1]->m_right.m_tag.c_str(), _t("div")));
+	assert(c.selectors()[1]->m_media_query != nullptr);
+	assert(!t_strcmp(c.selectors()[1]->m_style->get_property(_t("width")), _t("1px")));
+	assert(!t_strcmp(c.selectors()[2]->m_right.m_tag.c_str(), _t("span")));
+	assert(!t_strcmp(c.selectors()[2]->m_style->get_property(_t("height")), _t("2px")));
+	assert(!t_strcmp(c.selectors()[3]->m_right.m_tag.c_str(), _t("em")));
+	assert(!t_strcmp(c.selectors()[3]->m_style->get_property(_t("font-style")), _t("normal")));
+}
+
 static void CssParseUrlTest() {
 	tstring url;
 	css::parse_css_url(_t(""), url), assert(url.empty());
@@ -219,12 +237,106 @@ static void StyleAddPropertyTest() {
 	style.add_property(_t("unknown"), _t("value"), nullptr, false);
 }
 
+static void StyleShorthandTest() {
+	style style;
+	style.add(_t("margin: 1px 2px 3px; border-radius-x: 4px 5px; border-top: 1px solid red; border-spacing: 6px; border-top-right-radius: 7px 8px; list-style: square url(a.png)"), _t("base"));
+	assert(!t_strcmp(style.get_property(_t("margin-top")), _t("1px")));
+	assert(!t_strcmp(style.get_property(_t("margin-right")), _t("2px")));
+	assert(!t_strcmp(style.get_property(_t("margin-bottom")), _t("3px")));
+	assert(!t_strcmp(style.get_property(_t("margin-left")), _t("2px")));
+	assert(!t_strcmp(style.get_property(_t("border-top-left-radius-x")), _t("4px")));
+	assert(!t_strcmp(style.get_property(_t("border-bottom-left-radius-x")), _t("5px")));
+	assert(!t_strcmp(style.get_property(_t("border-top-width")), _t("1px")));
+	assert(!t_strcmp(style.get_property(_t("border-top-style")), _t("solid")));
+	assert(!t_strcmp(style.get_property(_t("border-top-color")), _t("red")));
+	assert(!style.get_property(_t("border-left-color")));
+	assert(!t_strcmp(style.get_property(_t("-litehtml-border-spacing-y")), _t("6px")));
+	assert(!t_strcmp(style.get_property(_t("border-top-right-radius-z")), _t("8px")));
+	assert(!t_strcmp(style.get_property(_t("list-style-type")), _t("square")));
+	assert(!t_strcmp(style.get_property(_t("list-style-image")), _t("url(a.png)")));
+	assert(!t_strcmp(style.get_property(_t("list-style-image-baseurl")), _t("base")));
+	assert(!style.get_property(_t("margin")));
+
+	style.add(_t("border-top: inherit; border-left: 2px #00ff00"), _t("base"));
+	assert(!t_strcmp(style.get_property(_t("border-top-color")), _t("inherit")));
+	assert(!t_strcmp(style.get_property(_t("border-top-width")), _t("1px")));
+	assert(!t_strcmp(style.get_property(_t("border-left-width")), _t("2px")));
+	assert(!t_strcmp(style.get_property(_t("border-left-color")), _t("#00ff00")));
+}
+
+static void InlineStyleCacheTest() {
+	container_test container;
+	litehtml::document::ptr doc = std::make_shared<litehtml::document>(&container, nullptr);
+	style::ptr st = doc->get_inline_style(_t("color: red; margin: 0"));
+	assert(st == doc->get_inline_style(_t("color: red; margin: 0")));
+	assert(st != doc->get_inline_style(_t("color: blue")));
+	assert(!t_strcmp(st->get_property(_t("margin-left")), _t("0")));
+
+	// the cache is limited, the styles past the limit are not shared
+	for (int i = 0; i < 1100; i++) {
+		tstringstream str;
+		str << _t("width: ") << i << _t("px");
+		doc->get_inline_style(str.str().c_str());
+	}
+	assert(doc->get_inline_style(_t("height: 1px")) != doc->get_inline_style(_t("height: 1px")));
+	assert(st == doc->get_inline_style(_t("color: red; margin: 0")));
+}
+
+static void StyleTypedValueTest() {
+	style style;
+	style.add(_t("width: 10px; margin-left: auto; color: #ff0000; border-top-color: unknowncolor; line-height: inherit; border-left-width: thick; display: block"), nullptr);
+	const property_value* val = style.get_property_value(_t("width"));
+	assert(val->m_type == property_type_length && !val->m_length.is_predefined() && val->m_length.val() == 10 && val->m_length.units() == css_units_px);
+	val = style.get_property_value(_t("margin-left"));
+	assert(val->m_type == property_type_length && val->m_length.is_predefined() && val->m_length.predef() == 0);
+	val = style.get_property_value(_t("border-left-width"));
+	assert(val->m_type == property_type_length && val->m_length.predef() == 2);
+	val = style.get_property_value(_t("color"));
+	assert(val->m_type == property_type_color && val->m_color.red == 255 && val->m_color.green == 0);
+	assert(style.get_property_value(_t("border-top-color"))->m_type == property_type_string);
+	assert(style.get_property_value(_t("line-height"))->m_type == property_type_string);
+	assert(style.get_property_value(_t("display"))->m_type == property_type_string);
+
+	// typed values are copied along with the declarations
+	litehtml::style combined;
+	combined.combine(style);
+	val = combined.get_property_value(_t("width"));
+	assert(val->m_type == property_type_length && val->m_length.val() == 10);
+}
+
+static void KeywordTableTest() {
+	assert(style_display_keywords.find(_t("none")) == display_none);
+	assert(style_display_keywords.find(_t("table-cell")) == display_table_cell);
+	assert(style_display_keywords.find(_t("Block"), display_inline) == display_inline);
+	assert(style_display_keywords.find(_t(""), display_inline) == display_inline);
+	assert(style_display_keywords.find(tstring(_t("inline-block"))) == display_inline_block);
+	assert(border_width_keywords.contains(_t("thick")) && !border_width_keywords.contains(_t("thic")));
+
+	string_vector items;
+	split_string(css_units_strings, items, _t(";"));
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		assert(css_units_keywords.find(items[i]) == value_index(items[i], css_units_strings));
+	}
+
+	keyword_table table(_t("a;;b;a;c"));
+	assert(table.find(_t("a")) == 0);
+	assert(table.find(_t("b")) == 2);
+	assert(table.find(_t("c")) == 4);
+	assert(table.find(_t("d")) == -1);
+}
+
 void cssTest() {
 	CssParseTest();
+	CssTokenizeTest();
 	CssParseUrlTest();
 	CssLengthParseTest();
 	CssElementSelectorParseTest();
 	CssSelectorParseTest();
 	StyleAddTest();
 	StyleAddPropertyTest();
+	StyleShorthandTest();
+	InlineStyleCacheTest();
+	StyleTypedValueTest();
+	KeywordTableTest();
 }
\ No newline at end of file
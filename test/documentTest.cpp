@@ -1,8 +1,11 @@
 #include <assert.h>
+#include <string.h>
 #include "litehtml.h"
 #include "test/container_test.h"
 using namespace litehtml;
 
+extern const tchar_t master_css[];
+
 static void LayoutTest() {
 	context ctx;
 	container_test container;
@@ -21,6 +24,57 @@ static void AddFontTest() {
 	doc->get_font(_t("Arial"), 0, _t("bold"), _t("normal"), _t("overline"), &fm);
 }
 
+class font_counting_container : public container_test {
+public:
+	int created = 0;
+	int deleted = 0;
+	unsigned int last_decoration = 0;
+	int last_weight = 0;
+	virtual uint_ptr create_font(const tchar_t* faceName, int size, int weight, font_style italic, unsigned int decoration, font_metrics* fm) override {
+		created++;
+		last_decoration = decoration;
+		last_weight = weight;
+		return container_test::create_font(faceName, size, weight, italic, decoration, fm);
+	}
+	virtual void delete_font(uint_ptr) override { deleted++; }
+};
+
+static void FontCacheTest() {
+	font_counting_container container;
+	{
+		litehtml::document::ptr doc = std::make_shared<litehtml::document>(&container, nullptr);
+		doc->get_font(_t("Arial"), 10, _t("bold"), _t("normal"), _t(" underline  overline"), nullptr);
+		assert(container.last_decoration == (font_decoration_underline | font_decoration_overline) && container.last_weight == 700);
+		doc->get_font(_t("Arial"), 10, _t("700"), _t("normal"), _t("overline underline"), nullptr);
+		assert(container.created == 1);
+		doc->get_font(_t("Arial"), 12, _t("bold"), _t("normal"), _t(""), nullptr);
+		assert(container.created == 2);
+	}
+	assert(container.deleted == 2);
+
+	// shared fonts outlive the documents, until the registration of the container is released
+	context ctx;
+	ctx.fonts().enable(true);
+	container.created = container.deleted = 0;
+	{
+		font_cache::registration fonts = ctx.fonts().share_fonts(&container);
+		for (int i = 0; i < 2; i++) {
+			litehtml::document::ptr doc = std::make_shared<litehtml::document>(&container, &ctx);
+			doc->get_font(_t("Arial"), 10, _t("bold"), _t("normal"), _t(""), nullptr);
+		}
+		assert(container.created == 1 && container.deleted == 0 && ctx.fonts().count() == 1);
+	}
+	assert(container.deleted == 1 && ctx.fonts().count() == 0 && !ctx.fonts().is_shared(&container));
+
+	// the documents of a container that is not registered keep their own fonts
+	container.created = container.deleted = 0;
+	{
+		litehtml::document::ptr doc = std::make_shared<litehtml::document>(&container, &ctx);
+		doc->get_font(_t("Arial"), 10, _t("bold"), _t("normal"), _t(""), nullptr);
+	}
+	assert(container.created == 1 && container.deleted == 1 && ctx.fonts().count() == 0);
+}
+
 static void RenderTest() {
 	context ctx;
 	container_test container;
@@ -30,12 +84,34 @@ static void RenderTest() {
 	doc->render(100, render_all);
 }
 
+class borders_counter : public container_test {
+public:
+	int borders = 0;
+	virtual void draw_borders(uint_ptr, const litehtml::borders&, const position&, bool root) override {
+		if (!root) this->borders++;
+	}
+};
+
 static void DrawTest() {
 	context ctx;
 	container_test container;
 	litehtml::document::ptr doc = document::createFromString(_t("<html>Body</html>"), &container, &ctx);
 	position pos(0, 0, 0, 100, 100, 0);
 	doc->draw((uint_ptr)0, 0, 0, 0, &pos);
+
+	// a bordered element has a depth, it still intersects a flat clip and is drawn
+	ctx.load_master_stylesheet(master_css);
+	borders_counter counter;
+	doc = document::createFromString(_t("<html><body><div style=\"border: 2px solid black; width: 10px; height: 10px\"></div></body></html>"), &counter, &ctx);
+	doc->render(100);
+	element::ptr div = doc->root()->select_one(_t("div"));
+	position border_box = div->get_placement();
+	border_box += div->get_paddings();
+	border_box += div->get_borders();
+	assert(border_box.depth != 0);
+	assert(border_box.does_intersect(&pos));
+	doc->draw((uint_ptr)0, 0, 0, 0, &pos);
+	assert(counter.borders == 1);
 }
 
 static void CvtUnitsTest() {
@@ -90,6 +166,20 @@ static void CreateElementTest() {
 	doc->create_element(_t("tag"), map);
 }
 
+static void AttributesTest() {
+	context ctx;
+	container_test container;
+	litehtml::document::ptr doc = document::createFromString(_t("<div id=\"x\" class=\"a b\" data-foo=\"bar\"></div>"), &container, &ctx);
+	element::ptr el = doc->root()->select_one(_t(".b"));
+	assert(el);
+	assert(!t_strcmp(el->get_attr(_t("id")), _t("x")));
+	assert(!t_strcmp(el->get_attr(_t("data-foo")), _t("bar")));
+	string_map map;
+	map[_t("Class")] = _t("c");
+	el = doc->create_element(_t("span"), map);
+	assert(!t_strcmp(el->get_attr(_t("class")), _t("c")));
+}
+
 static void DeviceChangeTest() {
 	container_test container;
 	litehtml::document::ptr doc = std::make_shared<litehtml::document>(&container, nullptr);
@@ -103,14 +193,647 @@ static void ParseTest() {
 	document::createFromString(_t(""), &container, &ctx);
 }
 
+static void TableLayoutFixedTest() {
+	context ctx;
+	ctx.load_master_stylesheet(master_css);
+	container_test container;
+	litehtml::document::ptr doc = document::createFromString(_t("<table style=\"table-layout: fixed; width: 300px; border-spacing: 0\"><colgroup><col width=\"100\"><col></colgroup>"
+		"<tr><td id=\"a\">A</td><td id=\"b\" style=\"width: 50px\">B</td><td id=\"c\">C</td></tr>"
+		"<tr><td id=\"d\" style=\"width: 250px\">D</td><td>E</td><td>F</td></tr></table>"), &container, &ctx);
+	doc->render(500, render_all);
+	element::ptr root = doc->root();
+	assert(root->select_one(_t("#a"))->width() == 100);
+	assert(root->select_one(_t("#b"))->width() == 54);
+	assert(root->select_one(_t("#c"))->width() == 146);
+	assert(root->select_one(_t("#d"))->width() == 100);
+}
+
+static void LineBoxTest() {
+	context ctx;
+	ctx.load_master_stylesheet(master_css);
+	container_test container;
+	litehtml::document::ptr doc = document::createFromString(_t("<div style=\"width: 100px\"><span id=\"a\" style=\"display: inline-block; width: 60px\">A</span> "
+		"<span id=\"b\" style=\"display: inline-block; width: 30px\">B</span> <span id=\"c\" style=\"display: inline-block; width: 30px\">C</span></div>"), &container, &ctx);
+	doc->render(500, render_all);
+	element::ptr root = doc->root();
+	element::ptr a = root->select_one(_t("#a"));
+	element::ptr b = root->select_one(_t("#b"));
+	element::ptr c = root->select_one(_t("#c"));
+	assert(a->get_position().y == b->get_position().y);
+	assert(b->get_position().x == a->get_position().x + 60);
+	assert(c->get_position().y > b->get_position().y);
+	assert(c->get_position().x == a->get_position().x);
+}
+
+class text_container : public container_test {
+public:
+	int client_width = 0;
+	virtual int text_width(const tchar_t* text, uint_ptr) override { return 10 * (int)t_strlen(text); }
+	virtual void get_client_rect(position& client) const override { client = position(0, 0, 0, client_width, 0, 0); }
+};
+
+static int render_at(document::ptr doc, text_container& container, int width) {
+	container.client_width = width;
+	return doc->render(width, render_all);
+}
+
+static void TableLayoutFixedAutoWidthTest() {
+	// without a table width the automatic layout is used
+	context ctx;
+	ctx.load_master_stylesheet(master_css);
+	text_container container;
+	const tchar_t* rows = _t("<tr><td id=\"a\">A</td><td id=\"b\">BBBBBBBB BBBBBBBB</td></tr></table>");
+	litehtml::document::ptr fixed_doc = document::createFromString((tstring(_t("<table style=\"table-layout: fixed\">")) + rows).c_str(), &container, &ctx);
+	litehtml::document::ptr auto_doc = document::createFromString((tstring(_t("<table>")) + rows).c_str(), &container, &ctx);
+	fixed_doc->render(500, render_all);
+	auto_doc->render(500, render_all);
+	assert(fixed_doc->root()->select_one(_t("#a"))->width() == auto_doc->root()->select_one(_t("#a"))->width());
+	assert(fixed_doc->root()->select_one(_t("#b"))->width() == auto_doc->root()->select_one(_t("#b"))->width());
+	assert(fixed_doc->root()->select_one(_t("#a"))->width() < fixed_doc->root()->select_one(_t("#b"))->width());
+}
+
+static void InlineRunTest() {
+	context ctx;
+	ctx.load_master_stylesheet(master_css);
+	text_container container;
+	litehtml::document::ptr doc = document::createFromString(_t("<p id=\"p\">aaaa bbbb cccc dddd</p>"), &container, &ctx);
+	element::ptr p = doc->root()->select_one(_t("#p"));
+	render_at(doc, container, 500);
+	int line_height = p->get_position().height;
+	render_at(doc, container, 116);
+	assert(p->get_position().height == line_height * 2);
+	render_at(doc, container, 76);
+	assert(p->get_position().height == line_height * 4);
+	render_at(doc, container, 500);
+	assert(p->get_position().height == line_height);
+}
+
+static void InlineRunChildrenTest() {
+	context ctx;
+	ctx.load_master_stylesheet(master_css);
+	text_container container;
+	litehtml::document::ptr doc = document::createFromString(_t("<p id=\"p\">aaaa bbbb cccc dddd</p><p id=\"q\">eeee <div id=\"d\">ffff</div></p>"), &container, &ctx);
+	element::ptr p = doc->root()->select_one(_t("#p"));
+	element::ptr d = doc->root()->select_one(_t("#d"));
+	render_at(doc, container, 116);
+	int two_lines = p->get_position().height;
+	// the block child makes the run mixed, and taking it out makes it inline text again
+	d->parent()->removeChild(d);
+	p->appendChild(d);
+	render_at(doc, container, 116);
+	assert(p->get_position().height > two_lines);
+	render_at(doc, container, 116);
+	assert(p->get_position().height > two_lines);
+	p->removeChild(d);
+	render_at(doc, container, 116);
+	assert(p->get_position().height == two_lines);
+	// a removed text node and a new one at the same place
+	element::ptr last = p->get_child((int) p->get_children_count() - 1);
+	p->removeChild(last);
+	render_at(doc, container, 116);
+	p->appendChild(last);
+	render_at(doc, container, 116);
+	assert(p->get_position().height == two_lines);
+}
+
+static void LazyLayoutTest() {
+	context ctx;
+	ctx.load_master_stylesheet(master_css);
+	container_test container;
+	tstring html = _t("<html><body>");
+	for (int i = 0; i < 10; i++) html += _t("<div style=\"height: 10px\"></div>");
+	for (int i = 0; i < 10; i++) html += _t("<div style=\"height: 50px\"></div>");
+	html += _t("</body></html>");
+	litehtml::document::ptr doc = document::createFromString(html.c_str(), &container, &ctx);
+	doc->render(500, render_all);
+	int full_height = doc->height();
+	doc = document::createFromString(html.c_str(), &container, &ctx);
+	doc->render(500, position(0, 0, 0, 500, 50, 0), render_all);
+	assert(doc->height() < full_height);
+	assert(doc->realize_layout(position(0, 150, 0, 500, 10, 0)));
+	doc->draw((uint_ptr)0, 0, 0, 0, nullptr);
+	assert(doc->height() == full_height);
+
+	// the blocks with positioned or floating content are not deferred
+	html = _t("<html><body>");
+	for (int i = 0; i < 10; i++) html += _t("<div style=\"height: 50px\"></div>");
+	html += _t("<div style=\"height: 50px\"><span style=\"position: absolute; top: 5px; left: 7px; width: 10px; height: 10px\" id=\"abs\"></span></div>");
+	html += _t("<div><div style=\"float: left; width: 20px; height: 30px\" id=\"flt\"></div></div>");
+	html += _t("<div style=\"height: 50px\" id=\"last\"></div></body></html>");
+	doc = document::createFromString(html.c_str(), &container, &ctx);
+	doc->render(500, render_all);
+	position abs_pos = doc->root()->select_one(_t("#abs"))->get_placement();
+	position flt_pos = doc->root()->select_one(_t("#flt"))->get_placement();
+	full_height = doc->height();
+	doc = document::createFromString(html.c_str(), &container, &ctx);
+	doc->render(500, position(0, 0, 0, 500, 50, 0), render_all);
+	assert(doc->root()->select_one(_t("#last"))->is_deferred());
+	position pos = doc->root()->select_one(_t("#abs"))->get_placement();
+	assert(pos.x == abs_pos.x && pos.y == abs_pos.y && pos.height == abs_pos.height);
+	pos = doc->root()->select_one(_t("#flt"))->get_placement();
+	assert(pos.y == flt_pos.y && pos.height == flt_pos.height);
+
+	// hit testing lays out the block under the point
+	position last_pos = doc->root()->select_one(_t("#last"))->get_placement();
+	doc->root()->get_element_by_point(10, last_pos.y + 1, 0, 10, last_pos.y + 1, 0);
+	assert(!doc->root()->select_one(_t("#last"))->is_deferred());
+	assert(doc->height() == full_height);
+
+	// the floats and positioned elements below a block laid out later move with it
+	html = _t("<html><body>");
+	for (int i = 0; i < 5; i++) html += _t("<div style=\"height: 10px\"></div>");
+	for (int i = 0; i < 10; i++) html += _t("<div style=\"height: 50px\"></div>");
+	html += _t("<div style=\"position: absolute; left: 7px; width: 10px; height: 10px\" id=\"abs\"></div>");
+	html += _t("<div style=\"float: left; width: 20px; height: 30px\" id=\"flt\"></div>");
+	html += _t("<div style=\"height: 50px\" id=\"last\"></div></body></html>");
+	doc = document::createFromString(html.c_str(), &container, &ctx);
+	doc->render(500, render_all);
+	abs_pos = doc->root()->select_one(_t("#abs"))->get_placement();
+	flt_pos = doc->root()->select_one(_t("#flt"))->get_placement();
+	full_height = doc->height();
+	doc = document::createFromString(html.c_str(), &container, &ctx);
+	doc->render(500, position(0, 0, 0, 500, 50, 0), render_all);
+	assert(doc->height() != full_height);
+	assert(doc->realize_layout(position(0, 0, 0, 500, full_height, 0)));
+	assert(doc->height() == full_height);
+	pos = doc->root()->select_one(_t("#abs"))->get_placement();
+	assert(pos.y == abs_pos.y);
+	pos = doc->root()->select_one(_t("#flt"))->get_placement();
+	assert(pos.y == flt_pos.y);
+}
+
+static void StylesheetCacheTest() {
+	context ctx;
+	ctx.load_master_stylesheet(master_css);
+	container_test container;
+	const tchar_t* html = _t("<html><head><style>p { width: 120px } @media print { p { width: 10px } }</style><style>div { width: 30px }</style></head>"
+		"<body><p id=\"p\"></p><div id=\"d\"></div></body></html>");
+	for (int i = 0; i < 2; i++) {
+		litehtml::document::ptr doc = document::createFromString(html, &container, &ctx);
+		doc->render(500, render_all);
+		assert(doc->root()->select_one(_t("#d"))->width() == 30);
+	}
+	// the sheet with the media query is parsed every time
+	stylesheet_cache_stats stats = ctx.stylesheets().stats();
+	assert(stats.entries == 1 && stats.hits == 1 && stats.misses == 3);
+	ctx.stylesheets().set_max_size(1);
+	stats = ctx.stylesheets().stats();
+	assert(stats.entries == 0 && stats.size == 0 && stats.evictions == 1);
+}
+
+static void MediaRestyleTest() {
+	context ctx;
+	ctx.load_master_stylesheet(master_css);
+	text_container container;
+	container.client_width = 500;
+	litehtml::document::ptr doc = document::createFromString(
+		_t("<html><head><style>@media (max-width: 300px) { .a { color: red } } @media (max-width: 300px) { .c { width: 5px } }</style></head>")
+		_t("<body><div class=\"a\" id=\"a\"><span id=\"s\">x</span></div><div id=\"b\"></div></body></html>"), &container, &ctx);
+	element::ptr a = doc->root()->select_one(_t("#a"));
+	element::ptr s = doc->root()->select_one(_t("#s"));
+	element::ptr b = doc->root()->select_one(_t("#b"));
+	assert(a->get_color(_t("color"), true, web_color(0, 0, 0)).red == 0);
+
+	// #b has no selectors under the media lists, so its styles are left as they are
+	style marker;
+	marker.add(_t("height: 7px"), nullptr);
+	b->add_style(marker);
+
+	container.client_width = 200;
+	assert(doc->media_changed());
+	assert(a->get_color(_t("color"), true, web_color(0, 0, 0)).red == 255);
+	assert(s->get_color(_t("color"), true, web_color(0, 0, 0)).red == 255);
+	assert(!t_strcmp(b->get_style_property(_t("height"), false, _t("")), _t("7px")));
+
+	assert(!doc->media_changed());
+	container.client_width = 500;
+	assert(doc->media_changed());
+	assert(a->get_color(_t("color"), true, web_color(0, 0, 0)).red == 0);
+}
+
+static void OutOfFlowCacheTest() {
+	context ctx;
+	ctx.load_master_stylesheet(master_css);
+	text_container container;
+	container.client_width = 500;
+	litehtml::document::ptr doc = document::createFromString(
+		_t("<html><head><style>@media (max-width: 300px) { .s { position: absolute } }</style></head>")
+		_t("<body><div id=\"a\"><p><span class=\"s\">x</span></p></div></body></html>"), &container, &ctx);
+	element::ptr a = doc->root()->select_one(_t("#a"));
+	// <html> is relative in the master stylesheet, which does not take it out of the flow
+	assert(!a->has_out_of_flow() && !a->has_positioned());
+	assert(!doc->root()->has_out_of_flow() && doc->root()->has_positioned());
+
+	// the cached results of the ancestors are dropped when a descendant is restyled
+	container.client_width = 200;
+	assert(doc->media_changed());
+	assert(a->has_out_of_flow() && a->has_positioned() && doc->root()->has_out_of_flow());
+	container.client_width = 500;
+	assert(doc->media_changed());
+	assert(!a->has_out_of_flow() && !a->has_positioned());
+}
+
+static void StatsTest() {
+	context ctx;
+	ctx.load_master_stylesheet(master_css);
+	text_container container;
+	container.client_width = 500;
+	const tchar_t* html = _t("<html><body><p>aaa bbb</p><table><tr><td>x</td><td>y</td></tr></table></body></html>");
+
+	litehtml::document::ptr doc = document::createFromString(html, &container, &ctx);
+	doc->render(500);
+	assert(doc->stats().elements_created == 0 && doc->stats().phase_count[stats_phase_render] == 0);
+
+	int callbacks[stats_phase_count] = {};
+	ctx.enable_stats(true, [&callbacks](stats_phase phase, double) { callbacks[phase]++; });
+	doc = document::createFromString(html, &container, &ctx);
+	doc->render(500);
+	doc->draw((uint_ptr)0, 0, 0, 0, nullptr);
+	const document_stats& stats = doc->stats();
+#ifndef LITEHTML_NO_STATS
+	assert(stats.phase_count[stats_phase_parse] == 1 && stats.phase_count[stats_phase_init] == 1);
+	assert(stats.phase_count[stats_phase_render] == 1 && stats.phase_count[stats_phase_draw] == 1);
+	assert(callbacks[stats_phase_parse] == 1 && callbacks[stats_phase_draw] == 1);
+	assert(stats.elements_created > 0);
+	assert(stats.selectors_tested >= stats.selectors_matched && stats.selectors_matched > 0);
+	assert(stats.style_property_calls > 0);
+	assert(stats.text_width_calls > 0);
+	assert(stats.render_calls > 0);
+	assert(stats.table_min_max_renders > 0);
+	assert(stats.draw_calls > 0);
+#endif
+	doc->reset_stats();
+	assert(stats.render_calls == 0);
+}
+
+static void TraceTest() {
+	context ctx;
+	ctx.load_master_stylesheet(master_css);
+	ctx.enable_trace(true);
+	text_container container;
+	container.client_width = 500;
+
+	litehtml::document::ptr doc = document::createFromString(_t("<html><body><div id=\"box\">aaa</div><div style=\"position: absolute\">b</div><table><tr><td>x</td></tr></table></body></html>"), &container, &ctx);
+	doc->render(500);
+	doc->draw((uint_ptr)0, 0, 0, 0, nullptr);
+	assert(!doc->stats_enabled() && doc->stats().render_calls == 0);
+#ifndef LITEHTML_NO_STATS
+	std::map<std::string, int> counts;
+	bool box_rendered = false;
+	for (const auto& ev : doc->trace().events())
+	{
+		counts[ev.name]++;
+		assert(ev.dur >= 0);
+		if (!strcmp(ev.name, "render_box") && ev.id == _t("box"))
+		{
+			assert(ev.tag == _t("div"));
+			box_rendered = true;
+		}
+	}
+	assert(box_rendered);
+	assert(counts["parse"] == 1 && counts["render"] == 1 && counts["draw"] == 1);
+	assert(counts["apply_stylesheet"] > 0 && counts["parse_styles"] > 0);
+	assert(counts["render_table"] > 0 && counts["render_positioned"] > 0 && counts["draw_stacking_context"] > 0);
+
+	std::string json = doc->trace().to_json();
+	assert(json.find("\"traceEvents\":[") != std::string::npos);
+	assert(json.find("{\"name\":\"render_box\",\"cat\":\"layout\",\"ph\":\"X\"") != std::string::npos);
+	assert(json.find("\"args\":{\"tag\":\"div\",\"id\":\"box\"}") != std::string::npos);
+#endif
+	doc->reset_trace();
+	assert(doc->trace().events().empty());
+}
+
+static void MemoryUsageTest() {
+	context ctx;
+	ctx.load_master_stylesheet(master_css);
+	text_container container;
+	container.client_width = 500;
+
+	litehtml::document::ptr doc = document::createFromString(_t("<html><head><style>p { color: red }</style></head><body><p title=\"a long enough title attribute\" style=\"margin: 1px\">some text long enough for the heap</p><table><tr><td>x</td></tr></table></body></html>"), &container, &ctx);
+	document_memory_usage before = doc->memory_usage();
+	assert(before.elements > 0);
+	assert(before.attributes > 0);
+	assert(before.styles > 0);
+	assert(before.selectors > 0);
+	assert(before.text > 0);
+	assert(before.total() == before.elements + before.attributes + before.styles + before.selectors + before.boxes + before.text + before.fonts);
+
+	doc->render(500);
+	document_memory_usage after = doc->memory_usage();
+	assert(after.boxes > before.boxes);
+	assert(after.fonts > 0);
+	assert(after.text == before.text);
+
+	tstring html = _t("<html><body>");
+	for (int i = 0; i < 50; i++) html += _t("<p>some text long enough for the heap</p>");
+	html += _t("</body></html>");
+	litehtml::document::ptr big_doc = document::createFromString(html.c_str(), &container, &ctx);
+	big_doc->render(500);
+	assert(big_doc->memory_usage().total() > after.total());
+	assert(big_doc->memory_usage().text > after.text);
+
+	// the declarations of the document style sheets
+	litehtml::document::ptr small_sheet = document::createFromString(_t("<html><head><style>p { color: red }</style></head><body><p>x</p></body></html>"), &container, &ctx);
+	litehtml::document::ptr big_sheet = document::createFromString(_t("<html><head><style>p { color: red; margin: 1px; padding: 2px; border: 1px solid black } div { color: blue }</style></head><body><p>x</p></body></html>"), &container, &ctx);
+	assert(big_sheet->memory_usage().styles > small_sheet->memory_usage().styles + 10 * sizeof(tstring));
+
+	litehtml::document::ptr span = document::createFromString(_t("<html><body><span></span></body></html>"), &container, &ctx);
+	litehtml::document::ptr img = document::createFromString(_t("<html><body><img></body></html>"), &container, &ctx);
+	assert(img->memory_usage().elements > span->memory_usage().elements);
+}
+
+static void ImageReadyTest() {
+	context ctx;
+	ctx.load_master_stylesheet(master_css);
+	container_test container;
+	litehtml::document::ptr doc = document::createFromString(_t("<html><body style=\"margin: 0\">"
+		"<div style=\"height: 10px\"></div>"
+		"<div><img src=\"a.png\"></div>"
+		"<div id=\"last\" style=\"height: 10px\"></div>"
+		"<div><img src=\"b.png\" width=\"20\" height=\"20\"></div>"
+		"</body></html>"), &container, &ctx);
+	doc->render(500);
+	int height = doc->height();
+	element::ptr last = doc->root()->select_one(_t("#last"));
+	int last_top = last->get_placement().y;
+
+	// the block of the image and the blocks below it are laid out again
+	position::vector redraw_boxes;
+	assert(doc->image_ready(_t("a.png"), size(100, 40, 0), redraw_boxes));
+	assert(redraw_boxes.size() == 1 && redraw_boxes[0].y == 10);
+	assert(doc->height() > height);
+	assert(last->get_placement().y > last_top);
+	int relayout_height = doc->height();
+	int root_height = doc->root()->height();
+	last_top = last->get_placement().y;
+	doc->render(500);
+	assert(doc->height() == relayout_height);
+	assert(doc->root()->height() == root_height);
+	assert(last->get_placement().y == last_top);
+
+	// the root shrinks with the content
+	redraw_boxes.clear();
+	assert(doc->image_ready(_t("a.png"), size(100, 10, 0), redraw_boxes));
+	relayout_height = doc->height();
+	root_height = doc->root()->height();
+	doc->render(500);
+	assert(doc->height() == relayout_height && doc->root()->height() == root_height);
+
+	// width and height are given, only the image is drawn again
+	redraw_boxes.clear();
+	assert(doc->image_ready(_t("b.png"), size(100, 100, 0), redraw_boxes));
+	assert(redraw_boxes.size() == 1 && redraw_boxes[0].width == 20 && redraw_boxes[0].height == 20);
+	assert(doc->height() == relayout_height);
+
+	redraw_boxes.clear();
+	assert(!doc->image_ready(_t("unknown.png"), size(100, 100, 0), redraw_boxes));
+	assert(redraw_boxes.empty());
+
+	// inline content of body falls back to the full layout
+	doc = document::createFromString(_t("<html><body style=\"margin: 0\"><img src=\"c.png\"></body></html>"), &container, &ctx);
+	doc->render(500);
+	assert(doc->image_ready(_t("c.png"), size(100, 40, 0), redraw_boxes));
+	assert(doc->height() >= 40);
+
+	// a float below the resized image is moved too
+	const tchar_t* html = _t("<html><body style=\"margin: 0\"><div><img src=\"d.png\"></div>"
+		"<div style=\"float: left; width: 10px; height: 10px\" id=\"flt\"></div><div>text</div></body></html>");
+	doc = document::createFromString(html, &container, &ctx);
+	doc->render(500);
+	redraw_boxes.clear();
+	assert(doc->image_ready(_t("d.png"), size(100, 40, 0), redraw_boxes));
+	int flt_top = doc->root()->select_one(_t("#flt"))->get_placement().y;
+	root_height = doc->root()->height();
+	doc->render(500);
+	assert(doc->root()->select_one(_t("#flt"))->get_placement().y == flt_top);
+	assert(doc->root()->height() == root_height);
+}
+
+static void LayoutSnapshotTest() {
+	context ctx;
+	ctx.load_master_stylesheet(master_css);
+	container_test container;
+	const tchar_t* html = _t("<html><body style=\"margin: 0\">"
+		"<div style=\"float: left; width: 50px; height: 30px\"></div>"
+		"<p>Some <b>bold</b> and <i>italic</i> text around the float</p>"
+		"<table><tr><td>a</td><td>b</td></tr></table>"
+		"<div id=\"abs\" style=\"position: absolute; left: 10px; top: 200px; width: 20px; height: 20px\"></div>"
+		"</body></html>");
+	litehtml::document::ptr doc = document::createFromString(html, &container, &ctx);
+	layout_snapshot snapshot;
+	assert(!snapshot.capture(*doc));
+	doc->render(300);
+	assert(snapshot.capture(*doc) && snapshot.render_width() == 300);
+
+	byte_vector data;
+	assert(snapshot.save(data));
+	layout_snapshot loaded;
+	assert(loaded.load(data.data(), data.size()));
+	assert(loaded.to_json() == snapshot.to_json());
+	assert(!loaded.load(data.data(), data.size() - 1) && loaded.empty());
+
+	// indexes that would leave a box without its element are rejected; the root comes first,
+	// after the header, the fixed boxes count and the elements count
+	auto read_at = [](const byte_vector& bytes, size_t offset) { int val; memcpy(&val, bytes.data() + offset, sizeof(val)); return val; };
+	auto write_at = [](byte_vector& bytes, size_t offset, int val) { memcpy(bytes.data() + offset, &val, sizeof(val)); };
+	const size_t root_offset = 9 * sizeof(int);
+	const size_t owner_offset = root_offset + 24 * sizeof(int) + 1;
+	const size_t block_el_offset = owner_offset + 3 * sizeof(int) + 1 + 4 * sizeof(int);
+	assert(read_at(data, root_offset - 2 * sizeof(int)) == 0);
+	assert(read_at(data, owner_offset) == -1 && read_at(data, owner_offset + sizeof(int)) == -1);
+	assert(read_at(data, owner_offset + 2 * sizeof(int)) >= 1 && data[owner_offset + 3 * sizeof(int)] == 0);
+	byte_vector corrupt = data;
+	write_at(corrupt, owner_offset, 0);
+	assert(!loaded.load(corrupt.data(), corrupt.size()));
+	write_at(corrupt, owner_offset + sizeof(int), 100);
+	assert(!loaded.load(corrupt.data(), corrupt.size()));
+	write_at(corrupt, owner_offset + sizeof(int), 0);
+	assert(loaded.load(corrupt.data(), corrupt.size()));
+	corrupt = data;
+	write_at(corrupt, block_el_offset, -1);
+	assert(!loaded.load(corrupt.data(), corrupt.size()) && loaded.empty());
+
+	// a document of the same sources takes the layout without rendering
+	litehtml::document::ptr warm = document::createFromString(html, &container, &ctx);
+	assert(snapshot.apply(*warm));
+	assert(warm->width() == doc->width() && warm->height() == doc->height());
+	layout_snapshot warm_snapshot;
+	assert(warm_snapshot.capture(*warm) && warm_snapshot.to_json() == snapshot.to_json());
+	element::ptr abs = warm->root()->select_one(_t("#abs"));
+	assert(warm->root()->get_element_by_point(15, 205, 0, 15, 205, 0) == abs);
+	warm->draw((uint_ptr)0, 0, 0, 0, nullptr);
+
+	// and renders the same later
+	warm->render(200);
+	doc->render(200);
+	assert(warm_snapshot.capture(*warm) && snapshot.capture(*doc) && warm_snapshot.to_json() == snapshot.to_json());
+
+	litehtml::document::ptr other = document::createFromString(_t("<html><body><p>other</p></body></html>"), &container, &ctx);
+	assert(!snapshot.apply(*other));
+}
+
+static std::string layout_json(document::ptr doc, int width) {
+	doc->render(width);
+	layout_snapshot snapshot;
+	snapshot.capture(*doc);
+	return snapshot.to_json();
+}
+
+static void DocumentSnapshotTest() {
+	context ctx;
+	ctx.load_master_stylesheet(master_css);
+	text_container container;
+	container.client_width = 500;
+	const tchar_t* html = _t("<html><head><title>t</title><style>p { margin: 3px } .x::before { content: \"> \" } a:hover { padding: 4px }</style></head><body>"
+		"<p class=\"x\" style=\"color: red\">Some <a href=\"#\">link</a> text</p>"
+		"<table width=\"200\"><tr><td>a</td><td>b</td></tr></table>"
+		"<div style=\"display: table-cell\">cell</div><!-- comment -->"
+		"</body></html>");
+	litehtml::document::ptr doc = document::createFromString(html, &container, &ctx);
+	byte_vector data;
+	assert(doc->save_snapshot(data));
+
+	ctx.enable_stats(true);
+	litehtml::document::ptr copy = document::createFromSnapshot(data.data(), data.size(), &container, &ctx);
+	ctx.enable_stats(false);
+	assert(copy);
+#ifndef LITEHTML_NO_STATS
+	assert(copy->stats().phase_count[stats_phase_parse] == 0 && copy->stats().selectors_tested == 0);
+#endif
+	assert(layout_json(copy, 300) == layout_json(doc, 300));
+	byte_vector copy_data;
+	assert(copy->save_snapshot(copy_data) && copy_data == data);
+
+	// the used selectors are restored, :hover applies
+	position::vector redraw_boxes;
+	element::ptr link = copy->root()->select_one(_t("a"));
+	link->set_pseudo_class(_t("hover"), true);
+	assert(copy->root()->find_styles_changes(redraw_boxes, 0, 0, 0));
+	assert(link->get_paddings().left == 4);
+
+	assert(!document::createFromSnapshot(data.data(), data.size() - 1, &container, &ctx));
+	context other;
+	other.load_master_stylesheet(_t("div { display: block }"));
+	assert(!document::createFromSnapshot(data.data(), data.size(), &container, &other));
+
+	// and so is one with other master or user style sheets with the same number of selectors
+	context changed;
+	changed.load_master_stylesheet(master_css);
+	changed.load_master_stylesheet(_t("p { margin: 1px }"));
+	context other_master;
+	other_master.load_master_stylesheet(master_css);
+	other_master.load_master_stylesheet(_t("p { margin: 2px }"));
+	doc = document::createFromString(html, &container, &changed);
+	data.clear();
+	assert(doc->save_snapshot(data));
+	assert(document::createFromSnapshot(data.data(), data.size(), &container, &changed));
+	assert(!document::createFromSnapshot(data.data(), data.size(), &container, &other_master));
+	litehtml::css user_styles;
+	user_styles.parse_stylesheet(_t("a { color: red }"), nullptr, nullptr, nullptr);
+	litehtml::css other_user_styles;
+	other_user_styles.parse_stylesheet(_t("a { color: blue }"), nullptr, nullptr, nullptr);
+	doc = document::createFromString(html, &container, &ctx, &user_styles);
+	data.clear();
+	assert(doc->save_snapshot(data, &user_styles));
+	assert(document::createFromSnapshot(data.data(), data.size(), &container, &ctx, &user_styles));
+	assert(!document::createFromSnapshot(data.data(), data.size(), &container, &ctx, &other_user_styles));
+
+	// style sheets with media queries are parsed again, the styles follow the container media
+	html = _t("<html><head><style>@media (max-width: 300px) { div { height: 20px } }</style></head><body><div>a</div></body></html>");
+	doc = document::createFromString(html, &container, &ctx);
+	data.clear();
+	assert(doc->save_snapshot(data));
+	copy = document::createFromSnapshot(data.data(), data.size(), &container, &ctx);
+	assert(copy && layout_json(copy, 500) == layout_json(doc, 500));
+	container.client_width = 200;
+	copy = document::createFromSnapshot(data.data(), data.size(), &container, &ctx);
+	assert(copy && copy->root()->select_one(_t("div"))->get_css_height().val() == 20);
+}
+
+static void CorruptSnapshotTest() {
+	context ctx;
+	ctx.load_master_stylesheet(master_css);
+	text_container container;
+	container.client_width = 500;
+	litehtml::document::ptr doc = document::createFromString(_t("<html><head><style>p { color: red }</style></head><body><p>x</p></body></html>"), &container, &ctx);
+	byte_vector data;
+	assert(doc->save_snapshot(data));
+
+	// the document style sheet follows the header and the media; in it the declaration index of the
+	// only selector follows the stored declarations, and the combinator its specificity and order
+	auto write_at = [](byte_vector& bytes, size_t offset, int val) { memcpy(bytes.data() + offset, &val, sizeof(val)); };
+	const size_t styles_offset = 18 * sizeof(int) + 1 + sizeof(int);
+	const size_t style_id_offset = styles_offset + 8 * sizeof(int) + (5 + 3) * sizeof(tchar_t) + 1;
+	const size_t combinator_offset = style_id_offset + 6 * sizeof(int);
+	int val;
+	memcpy(&val, data.data() + style_id_offset - sizeof(int), sizeof(val));
+	assert(data[72] == 1 && val == 1);
+	memcpy(&val, data.data() + style_id_offset, sizeof(val));
+	assert(val == 0);
+
+	byte_vector corrupt = data;
+	write_at(corrupt, style_id_offset, 1);
+	assert(!document::createFromSnapshot(corrupt.data(), corrupt.size(), &container, &ctx));
+	corrupt = data;
+	write_at(corrupt, combinator_offset, 9);
+	assert(!document::createFromSnapshot(corrupt.data(), corrupt.size(), &container, &ctx));
+
+	litehtml::document::ptr copy = document::createFromSnapshot(data.data(), data.size(), &container, &ctx);
+	assert(copy);
+	copy->media_changed();
+	assert(copy->root()->select_one(_t("p"))->get_color(_t("color"), true, web_color(0, 0, 0)).red == 255);
+}
+
+static void UTF8LengthTest() {
+	context ctx;
+	ctx.load_master_stylesheet(master_css);
+	text_container container;
+	container.client_width = 500;
+	const char* html = "<html><body><p title=\"t\">Some text\xE4\xB8\xAD\xE6\x96\x87 end</p></body></html>";
+	litehtml::document::ptr doc = document::createFromUTF8(html, &container, &ctx);
+	// the view stops inside the trailing garbage, nothing past the length is read
+	std::string buffer = std::string(html) + "<p>not parsed</p>";
+	litehtml::document::ptr view = document::createFromUTF8(buffer.data(), strlen(html), &container, &ctx);
+	assert(layout_json(view, 300) == layout_json(doc, 300));
+	assert(view->root()->select_all(_t("p")).size() == 1);
+
+	// words, spaces and each CJK character are separate elements
+	element::ptr p = view->root()->select_one(_t("p"));
+	assert(p->get_children_count() == 7);
+	assert(t_strcmp(p->get_attr(_t("title")), _t("t")) == 0);
+	tstring text;
+	p->get_text(text);
+	assert(text == _t("Some text\xE4\xB8\xAD\xE6\x96\x87 end"));
+}
+
 void documentTest() {
 	LayoutTest();
 	AddFontTest();
+	FontCacheTest();
 	RenderTest();
 	DrawTest();
 	CvtUnitsTest();
 	MouseEventsTest();
 	CreateElementTest();
+	AttributesTest();
 	DeviceChangeTest();
 	ParseTest();
+	TableLayoutFixedTest();
+	TableLayoutFixedAutoWidthTest();
+	LineBoxTest();
+	InlineRunTest();
+	InlineRunChildrenTest();
+	LazyLayoutTest();
+	StylesheetCacheTest();
+	MediaRestyleTest();
+	OutOfFlowCacheTest();
+	StatsTest();
+	TraceTest();
+	MemoryUsageTest();
+	ImageReadyTest();
+	LayoutSnapshotTest();
+	DocumentSnapshotTest();
+	CorruptSnapshotTest();
+	UTF8LengthTest();
 }
\ No newline at end of file
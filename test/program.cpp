@@ -6,12 +6,19 @@ extern const litehtml::tchar_t master_css[] =
 ,0
 };
 
+extern const unsigned char master_css_bin[] =
+{
+#include "master.css.bin.inc"
+};
+extern const size_t master_css_bin_size = sizeof(master_css_bin);
+
 void contextTest();
 void cssTest();
 void documentTest();
 void media_queryTest();
 void web_colorTest();
 void nodeTest();
+void rasterTest();
 void api_ConsoleTest();
 void api_DocumentFragmentTest();
 void api_DocumentImplementationTest();
@@ -48,6 +55,7 @@ int main(int argc, char **argv) {
 	case 4: media_queryTest(); break;
 	case 5: web_colorTest(); break;
 	case 6: nodeTest(); break;
+	case 7: rasterTest(); break;
 
 	case 11: api_ConsoleTest(); break;
 	case 12: api_DocumentFragmentTest(); break;
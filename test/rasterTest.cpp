@@ -0,0 +1,160 @@
+#include <assert.h>
+#include "litehtml.h"
+#include "raster/raster_container.h"
+using namespace litehtml;
+
+extern const tchar_t master_css[];
+
+static bool same_color(const web_color& a, const web_color& b) {
+	return a.red == b.red && a.green == b.green && a.blue == b.blue && a.alpha == b.alpha;
+}
+
+static void CanvasTest() {
+	raster_canvas canvas(20, 10);
+	canvas.clear(web_color(255, 255, 255));
+	canvas.fill_rect(2, 2, 4, 4, web_color(255, 0, 0));
+	assert(same_color(canvas.get_pixel(3, 3), web_color(255, 0, 0)));
+	assert(same_color(canvas.get_pixel(6, 3), web_color(255, 255, 255)));
+
+	// half transparent black over white
+	canvas.fill_rect(10, 0, 2, 2, web_color(0, 0, 0, 128));
+	web_color c = canvas.get_pixel(10, 0);
+	assert(c.red == 127 && c.green == 127 && c.blue == 127 && c.alpha == 255);
+
+	canvas.set_clip(position(0, 5, 20, 5));
+	canvas.fill_rect(0, 0, 20, 10, web_color(0, 0, 255));
+	assert(same_color(canvas.get_pixel(0, 4), web_color(255, 255, 255)));
+	assert(same_color(canvas.get_pixel(0, 5), web_color(0, 0, 255)));
+	canvas.reset_clip();
+
+	std::vector<unsigned char> png;
+	assert(canvas.save_png(png));
+	assert(png.size() > 20 * 10 * 4 && png[1] == 'P' && png[2] == 'N' && png[3] == 'G');
+	// IHDR width and height
+	assert(png[19] == 20 && png[23] == 10);
+}
+
+static void TextMetricsTest() {
+	bitmap_font_engine fonts;
+	raster_font* font = fonts.create_font(_t("monospace"), 30, 400, fontStyleNormal, font_decoration_none);
+	assert(font->ascent == 24 && font->descent == 8);
+	assert(fonts.text_width(font, _t("Hello")) == 5 * bitmap_font_engine::char_width(30));
+
+	raster_canvas canvas(100, 40);
+	fonts.draw_text(canvas, font, _t("H"), 0, 30, web_color(0, 0, 0));
+	// the stems of H and nothing between the bars
+	int inked = 0;
+	for (int y = 0; y < 40; y++)
+		for (int x = 0; x < 100; x++)
+			if (canvas.get_pixel(x, y).alpha) inked++;
+	assert(inked > 0);
+	assert(canvas.get_pixel(50, 20).alpha == 0);
+	fonts.delete_font(font);
+}
+
+static void DocumentPaintTest() {
+	context ctx;
+	ctx.load_master_stylesheet(master_css);
+	raster_container container(200, 100);
+	litehtml::document::ptr doc = document::createFromString(
+		_t("<html><body style=\"margin: 0\">"
+		"<div style=\"width: 50px; height: 20px; background-color: #ff0000\"></div>"
+		"<div style=\"width: 40px; height: 10px; border: 2px solid #00ff00\"></div>"
+		"<p style=\"margin: 0; color: #0000ff\">Hello</p>"
+		"</body></html>"), &container, &ctx);
+	doc->render(200);
+	container.draw(doc);
+	raster_canvas& canvas = container.canvas();
+
+	assert(same_color(canvas.get_pixel(10, 10), web_color(255, 0, 0)));
+	assert(same_color(canvas.get_pixel(60, 10), web_color(255, 255, 255)));
+
+	// border box from y = 20 to 34
+	assert(same_color(canvas.get_pixel(0, 20), web_color(0, 255, 0)));
+	assert(same_color(canvas.get_pixel(43, 33), web_color(0, 255, 0)));
+	assert(same_color(canvas.get_pixel(10, 27), web_color(255, 255, 255)));
+
+	// text from y = 34, only blue ink inside the text width
+	int text_width = 5 * bitmap_font_engine::char_width(16);
+	int ink = 0;
+	for (int y = 34; y < 60; y++) {
+		for (int x = 0; x < 200; x++) {
+			web_color c = canvas.get_pixel(x, y);
+			if (c.red != 255) {
+				assert(x < text_width && c.blue == 255 && c.red == c.green);
+				ink++;
+			}
+		}
+	}
+	assert(ink > 20);
+
+	// scrolled by 10px, the top border is at y = 10 and 11
+	container.draw(doc, 0, 10);
+	assert(same_color(canvas.get_pixel(10, 5), web_color(255, 0, 0)));
+	assert(same_color(canvas.get_pixel(10, 11), web_color(0, 255, 0)));
+}
+
+static void ImageTest() {
+	context ctx;
+	ctx.load_master_stylesheet(master_css);
+	raster_container container(100, 50);
+	std::shared_ptr<raster_canvas> img = std::make_shared<raster_canvas>(4, 4);
+	img->clear(web_color(0, 0, 255));
+	container.set_image(_t("blue.png"), img);
+
+	litehtml::document::ptr doc = document::createFromString(_t("<html><body style=\"margin: 0\"><img src=\"blue.png\" width=\"8\" height=\"8\"></body></html>"), &container, &ctx);
+	doc->render(100);
+	container.draw(doc);
+	assert(same_color(container.canvas().get_pixel(7, 7), web_color(0, 0, 255)));
+	assert(same_color(container.canvas().get_pixel(9, 7), web_color(255, 255, 255)));
+
+	// the image and its variant scaled to 8x8, made once
+	assert(container.images().count() == 2);
+	container.draw(doc);
+	assert(container.images().count() == 2);
+	assert(container.images().used() == (4 * 4 + 8 * 8) * 4);
+}
+
+static void ImageCacheTest() {
+	image_cache<std::shared_ptr<int>> cache(100);
+	cache.add(_t("a"), std::make_shared<int>(1), 4, 4);
+	cache.add(_t("b"), std::make_shared<int>(2), 4, 4);
+	std::shared_ptr<int> img;
+	// a is evicted but its size is known
+	assert(!cache.find(_t("a"), img));
+	assert(cache.find(_t("b"), img) && *img == 2);
+	size sz;
+	assert(cache.get_size(_t("a"), sz) && sz.width == 4 && sz.height == 4);
+	assert(cache.used() == 64);
+
+	// the least recently used goes first, the pinned ones stay
+	cache.set_budget(230);
+	cache.add(_t("c"), std::make_shared<int>(3), 2, 2, true);
+	cache.add_scaled(_t("b"), std::make_shared<int>(4), 2, 2);
+	assert(cache.find(_t("b"), img));
+	cache.add_scaled(_t("c"), std::make_shared<int>(5), 6, 6);
+	assert(!cache.find_scaled(_t("b"), 2, 2, img));
+	assert(cache.find(_t("b"), img) && cache.find(_t("c"), img));
+	assert(cache.find_scaled(_t("c"), 2, 2, img) && *img == 3);
+	assert(cache.find_scaled(_t("c"), 6, 6, img) && *img == 5);
+
+	cache.remove(_t("c"));
+	assert(!cache.find_scaled(_t("c"), 6, 6, img) && !cache.get_size(_t("c"), sz));
+	assert(cache.used() == 64);
+
+	// an image kept by the container only adds its variants, a new size drops them
+	cache.add_size(_t("d"), 8, 8);
+	assert(cache.used() == 64 && !cache.find(_t("d"), img));
+	cache.add_scaled(_t("d"), std::make_shared<int>(6), 3, 3);
+	assert(cache.find_scaled(_t("d"), 3, 3, img) && *img == 6 && cache.used() == 100);
+	cache.add_size(_t("d"), 5, 5);
+	assert(!cache.find_scaled(_t("d"), 3, 3, img) && cache.get_size(_t("d"), sz) && sz.width == 5);
+}
+
+void rasterTest() {
+	CanvasTest();
+	TextMetricsTest();
+	DocumentPaintTest();
+	ImageTest();
+	ImageCacheTest();
+}
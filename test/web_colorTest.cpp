@@ -13,6 +13,18 @@ static void WebColorParseTest() {
 	c = web_color::from_string(_t("rgb(255,0,255)"), &container), assert(c.red == 255), assert(c.green == 0), assert(c.blue == 255);
 	c = web_color::from_string(_t("red"), &container), assert(c.red == 255), assert(c.green == 0), assert(c.blue == 0);
 	c = web_color::from_string(_t("unknown"), &container), assert(c.red == 0), assert(c.green == 0), assert(c.blue == 0);
+	c = web_color::from_string(_t("#12345678"), &container), assert(c.red == 0x12), assert(c.green == 0x34), assert(c.blue == 0x56), assert(c.alpha == 0x78);
+	c = web_color::from_string(_t("#f0f8"), &container), assert(c.red == 255), assert(c.blue == 255), assert(c.alpha == 0x88);
+	c = web_color::from_string(_t("#ggg"), &container), assert(c.red == 0), assert(c.green == 0), assert(c.blue == 0);
+	c = web_color::from_string(_t("rgba(10, 20, 30, 0.5)"), &container), assert(c.red == 10), assert(c.green == 20), assert(c.blue == 30), assert(c.alpha == 128);
+	c = web_color::from_string(_t("rgb(100% 0% 50% / 50%)"), &container), assert(c.red == 255), assert(c.green == 0), assert(c.blue == 128), assert(c.alpha == 128);
+	c = web_color::from_string(_t("RGB(300,-5,0)"), &container), assert(c.red == 255), assert(c.green == 0), assert(c.blue == 0);
+	c = web_color::from_string(_t("hsl(120, 100%, 50%)"), &container), assert(c.red == 0), assert(c.green == 255), assert(c.blue == 0);
+	c = web_color::from_string(_t("hsla(240deg, 100%, 25%, 0)"), &container), assert(c.red == 0), assert(c.green == 0), assert(c.blue == 128), assert(c.alpha == 0);
+	c = web_color::from_string(_t("CornflowerBlue"), &container), assert(c.red == 0x64), assert(c.green == 0x95), assert(c.blue == 0xED);
+	c = web_color::from_string(_t("yellowgreen"), &container), assert(c.red == 0x9A), assert(c.green == 0xCD), assert(c.blue == 0x32);
+	c = web_color::from_string(_t("transparent"), &container), assert(c.alpha == 0);
+	assert(web_color::resolve_name(_t("white"), &container) == _t("#FFFFFF"));
 }
 
 void web_colorTest() {
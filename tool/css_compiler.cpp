@@ -0,0 +1,56 @@
+// Compiles a master stylesheet into the binary form loaded by
+// context::load_master_stylesheet(const unsigned char*, size_t).
+// The output is a list of bytes suitable for an array initializer (like xxd -i).
+//
+// Usage: litehtml_css_compiler <input.css> <output.inc>
+
+#include "litehtml.h"
+#include <litehtml/utf8_strings.h>
+#include <stdio.h>
+
+int main(int argc, char **argv)
+{
+	if (argc < 3)
+	{
+		fprintf(stderr, "Usage: %s <input.css> <output.inc>\n", argv[0]);
+		return 1;
+	}
+
+	FILE* fin = fopen(argv[1], "rb");
+	if (!fin)
+	{
+		fprintf(stderr, "Can't open %s\n", argv[1]);
+		return 1;
+	}
+	std::string text;
+	char buf[4096];
+	size_t read;
+	while ((read = fread(buf, 1, sizeof(buf), fin)) > 0)
+	{
+		text.append(buf, read);
+	}
+	fclose(fin);
+
+	litehtml::context ctx;
+	ctx.load_master_stylesheet(litehtml_from_utf8(text.c_str()));
+
+	litehtml::byte_vector data;
+	if (!ctx.master_css().save(data))
+	{
+		fprintf(stderr, "%s can't be stored in the binary form\n", argv[1]);
+		return 1;
+	}
+
+	FILE* fout = fopen(argv[2], "w");
+	if (!fout)
+	{
+		fprintf(stderr, "Can't create %s\n", argv[2]);
+		return 1;
+	}
+	for (size_t i = 0; i < data.size(); i++)
+	{
+		fprintf(fout, "%s0x%02x%s", (i % 12) ? "" : "  ", data[i], i + 1 == data.size() ? "\n" : ((i % 12) == 11 ? ",\n" : ", "));
+	}
+	fclose(fout);
+	return 0;
+}